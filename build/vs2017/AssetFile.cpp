@@ -0,0 +1,87 @@
+#include "AssetFile.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "system/debug_log.h"
+
+namespace fs = std::filesystem;
+
+AssetPack AssetFiles::pack_;
+fs::file_time_type AssetFiles::pack_time_;
+
+bool AssetFiles::Mount(const char* pack_filename)
+{
+	if(!pack_.Open(pack_filename))
+	{
+		gef::DebugOut((std::string(pack_filename) + " not mounted, reading loose files\n").c_str());
+		return false;
+	}
+	std::error_code error;
+	pack_time_ = fs::last_write_time(pack_filename, error);
+	return true;
+}
+
+void AssetFiles::Unmount()
+{
+	pack_.Close();
+}
+
+std::vector<std::string> AssetFiles::List(const std::string& folder)
+{
+	std::string prefix = AssetPack::NormalisePath(folder);
+	if(!prefix.empty() && prefix.back() != '/')
+		prefix += '/';
+
+	std::vector<std::string> names;
+	for(const PackEntry& entry : pack_)
+	{
+		const std::string_view path = pack_.GetPath(entry);
+		if(path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0 && path.find('/', prefix.size()) == std::string_view::npos)
+			names.emplace_back(path.substr(prefix.size()));
+	}
+
+	std::error_code error;
+	for(const fs::directory_entry& entry : fs::directory_iterator(folder, error))
+	{
+		if(entry.is_regular_file(error))
+			names.push_back(entry.path().filename().string());
+	}
+
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+	return names;
+}
+
+bool AssetFile::Open(const std::string& path)
+{
+	Close();
+
+	if(const PackEntry* entry = AssetFiles::GetPack().Find(AssetPack::NormalisePath(path)))
+	{
+		// Unless it's been edited since it was packed
+		std::error_code error;
+		const fs::file_time_type loose_time = fs::last_write_time(path, error);
+		if(error || loose_time <= AssetFiles::GetPackTime())
+		{
+			if(entry->size == 0)
+				return false;
+			data_ = AssetFiles::GetPack().GetData(*entry);
+			size_ = (size_t)entry->size;
+			return true;
+		}
+	}
+
+	if(!loose_.Open(path.c_str()))
+		return false;
+	data_ = loose_.GetData();
+	size_ = loose_.GetSize();
+	return true;
+}
+
+void AssetFile::Close()
+{
+	loose_.Close();
+	data_ = nullptr;
+	size_ = 0;
+}
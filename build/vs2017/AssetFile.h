@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetPack.h"
+#include "MappedFile.h"
+
+// The files the game reads, from the mounted pack when it has them and from loose files under
+// media/ when it doesn't. A loose file written since the pack was built is read instead of the
+// packed copy, so new or edited assets work in development without repacking
+class AssetFiles
+{
+public:
+	// Mounted once before anything loads, and then only read
+	static bool Mount(const char* pack_filename);
+	static void Unmount();
+	static bool IsMounted() { return pack_.IsOpen(); }
+
+	static const AssetPack& GetPack() { return pack_; }
+	// When the mounted pack was written
+	static std::filesystem::file_time_type GetPackTime() { return pack_time_; }
+
+	// Names of the files directly inside folder, from the pack and from disk without repeats, sorted
+	static std::vector<std::string> List(const std::string& folder);
+
+private:
+	static AssetPack pack_;
+	static std::filesystem::file_time_type pack_time_;
+};
+
+// Read only view of one file's bytes. Out of the pack there is nothing to copy, and a loose
+// file is mapped on its own. Stays valid while this is alive
+class AssetFile
+{
+public:
+	AssetFile() = default;
+	AssetFile(const AssetFile&) = delete;
+	AssetFile& operator=(const AssetFile&) = delete;
+
+	// Fails for files that are missing or empty
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return data_ != nullptr; }
+	bool IsPacked() const { return IsOpen() && !loose_.IsOpen(); }
+	const uint8_t* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+	const char* begin() const { return reinterpret_cast<const char*>(data_); }
+	const char* end() const { return begin() + size_; }
+
+private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	MappedFile loose_;
+};
@@ -0,0 +1,170 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	// Each file starts on a boundary so whatever is read out of the mapping is aligned
+	constexpr uint64_t kAlignment = 16;
+
+	void Pad(std::ofstream& out, uint64_t& offset)
+	{
+		static const char zeros[kAlignment] = {};
+		const uint64_t padding = (kAlignment - offset % kAlignment) % kAlignment;
+		out.write(zeros, (std::streamsize)padding);
+		offset += padding;
+	}
+}
+
+std::string AssetPack::NormalisePath(std::string_view path)
+{
+	std::string normalised(path);
+	std::replace(normalised.begin(), normalised.end(), '\\', '/');
+	while(normalised.rfind("./", 0) == 0)
+		normalised.erase(0, 2);
+	return normalised;
+}
+
+uint64_t AssetPack::HashPath(std::string_view normalised_path)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for(const char c : normalised_path)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool AssetPack::Write(const std::string& pack_path, const std::vector<std::pair<std::string, std::string>>& files, std::string& error)
+{
+	std::ofstream out(pack_path, std::ios::binary | std::ios::trunc);
+	if(!out)
+	{
+		error = "can't write " + pack_path;
+		return false;
+	}
+
+	PackHeader header;
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t offset = sizeof(header);
+
+	std::vector<PackEntry> entries;
+	std::string names;
+	entries.reserve(files.size());
+	for(const auto& [path, disk_path] : files)
+	{
+		std::ifstream in(disk_path, std::ios::binary);
+		if(!in)
+		{
+			error = "can't read " + disk_path;
+			return false;
+		}
+		const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+		Pad(out, offset);
+		const std::string normalised = NormalisePath(path);
+		PackEntry entry;
+		entry.hash = HashPath(normalised);
+		entry.offset = offset;
+		entry.size = bytes.size();
+		entry.name_offset = (uint32_t)names.size();
+		entry.name_size = (uint32_t)normalised.size();
+		entries.push_back(entry);
+		names += normalised;
+
+		out.write(bytes.data(), (std::streamsize)bytes.size());
+		offset += bytes.size();
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const PackEntry& a, const PackEntry& b) { return a.hash < b.hash; });
+
+	Pad(out, offset);
+	header.entry_count = (uint32_t)entries.size();
+	header.index_offset = offset;
+	out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(PackEntry)));
+	header.names_offset = offset + entries.size() * sizeof(PackEntry);
+	out.write(names.data(), (std::streamsize)names.size());
+
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if(!out)
+	{
+		error = "failed writing " + pack_path;
+		return false;
+	}
+	return true;
+}
+
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+	if(!file_.Open(filename))
+		return false;
+
+	PackHeader header;
+	bool valid = file_.GetSize() >= sizeof(header);
+	if(valid)
+	{
+		std::memcpy(&header, file_.GetData(), sizeof(header));
+		valid = header.magic == PackHeader::kMagic
+			&& header.version == PackHeader::kVersion
+			&& header.index_offset % alignof(PackEntry) == 0
+			&& header.index_offset <= header.names_offset
+			&& header.names_offset == header.index_offset + (uint64_t)header.entry_count * sizeof(PackEntry)
+			&& header.names_offset <= file_.GetSize();
+	}
+
+	// Every entry has to lie inside the file, and the index be sorted for Find, or a truncated
+	// or corrupt pack would have lookups reading past the mapping
+	const PackEntry* entries = valid ? reinterpret_cast<const PackEntry*>(file_.GetData() + header.index_offset) : nullptr;
+	const uint64_t names_size = valid ? file_.GetSize() - header.names_offset : 0;
+	for(uint32_t i = 0; valid && i < header.entry_count; i++)
+	{
+		const PackEntry& entry = entries[i];
+		valid = entry.offset >= sizeof(header)
+			&& entry.offset <= header.index_offset
+			&& entry.size <= header.index_offset - entry.offset
+			&& (uint64_t)entry.name_offset + entry.name_size <= names_size
+			&& (i == 0 || entries[i - 1].hash <= entry.hash);
+	}
+	if(!valid)
+	{
+		file_.Close();
+		return false;
+	}
+
+	entries_ = entries;
+	entry_count_ = header.entry_count;
+	names_ = reinterpret_cast<const char*>(file_.GetData() + header.names_offset);
+	return true;
+}
+
+void AssetPack::Close()
+{
+	file_.Close();
+	entries_ = nullptr;
+	entry_count_ = 0;
+	names_ = nullptr;
+}
+
+const PackEntry* AssetPack::Find(std::string_view normalised_path) const
+{
+	const uint64_t hash = HashPath(normalised_path);
+	const PackEntry* entry = std::lower_bound(begin(), end(), hash, [](const PackEntry& e, uint64_t h) { return e.hash < h; });
+	for(; entry != end() && entry->hash == hash; entry++)
+	{
+		if(GetPath(*entry) == normalised_path)
+			return entry;
+	}
+	return nullptr;
+}
+
+std::string_view AssetPack::GetPath(const PackEntry& entry) const
+{
+	return std::string_view(names_ + entry.name_offset, entry.name_size);
+}
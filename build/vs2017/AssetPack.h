@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Many assets in one file, built by pack_assets. A PackHeader, then each file's bytes, then an
+// index of PackEntry sorted by path hash so a lookup is a binary search, then the paths themselves
+struct PackHeader
+{
+	static constexpr uint32_t kMagic = 0x4B415047; // "GPAK"
+	static constexpr uint32_t kVersion = 1;
+
+	uint32_t magic = kMagic;
+	uint32_t version = kVersion;
+	uint32_t entry_count = 0;
+	uint32_t padding = 0;
+	uint64_t index_offset = 0;
+	uint64_t names_offset = 0;
+};
+
+struct PackEntry
+{
+	uint64_t hash;
+	uint64_t offset;
+	uint64_t size;
+	// Into the names after the index, to tell apart paths that hash the same
+	uint32_t name_offset;
+	uint32_t name_size;
+};
+
+// A pack mapped into memory. Everything it hands out points into the mapping
+class AssetPack
+{
+public:
+	// Paths are relative to media/ with forward slashes, which is what these make of any other spelling
+	static std::string NormalisePath(std::string_view path);
+	static uint64_t HashPath(std::string_view normalised_path);
+
+	// files are pairs of the path to store and the file on disk to read it from
+	static bool Write(const std::string& pack_path, const std::vector<std::pair<std::string, std::string>>& files, std::string& error);
+
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return file_.IsOpen(); }
+
+	// Null if it isn't in the pack
+	const PackEntry* Find(std::string_view normalised_path) const;
+	const uint8_t* GetData(const PackEntry& entry) const { return file_.GetData() + entry.offset; }
+	std::string_view GetPath(const PackEntry& entry) const;
+
+	const PackEntry* begin() const { return entries_; }
+	const PackEntry* end() const { return entries_ + entry_count_; }
+
+private:
+	MappedFile file_;
+	const PackEntry* entries_ = nullptr;
+	uint32_t entry_count_ = 0;
+	const char* names_ = nullptr;
+};
@@ -0,0 +1,328 @@
+#include "AudioSystem.h"
+
+#include "Profiler.h"
+#include "audio/audio_manager.h"
+#include "system/debug_log.h"
+
+AudioSystem::AudioSystem(gef::AudioManager* audio_manager, gef::Platform& platform, int max_voices)
+	: audio_manager_(audio_manager),
+	platform_(platform),
+	max_voices_(max_voices)
+{
+	worker_ = std::thread(&AudioSystem::WorkerLoop, this);
+}
+
+AudioSystem::~AudioSystem()
+{
+	{
+		// Whatever hasn't started decoding yet is never needed
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		requests_.clear();
+	}
+	wake_.notify_all();
+	worker_.join();
+}
+
+SoundHandle AudioSystem::AddSound(const std::string& name, const SoundDesc& desc)
+{
+	const int index = (int)sounds_.size();
+	sounds_.push_back({ desc, (int)voices_.size() });
+	sound_names_[name] = index;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for(int copy = 0; copy < desc.copies; copy++)
+		{
+			requests_.push_back({ desc.file, (int)voices_.size() });
+			Voice voice;
+			voice.sound = index;
+			voices_.push_back(voice);
+		}
+	}
+	wake_.notify_one();
+	return { index };
+}
+
+SoundHandle AudioSystem::GetSound(const std::string& name) const
+{
+	const auto sound = sound_names_.find(name);
+	if(sound == sound_names_.end())
+		return {};
+	return { sound->second };
+}
+
+void AudioSystem::PlayMusic(const char* file, float volume)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		music_volume_ = volume;
+		requests_.push_back({ file, -1 });
+	}
+	wake_.notify_one();
+}
+
+void AudioSystem::SetMusicVolume(float volume)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	music_volume_ = volume;
+	music_volume_dirty_ = true;
+}
+
+void AudioSystem::SetSfxVolume(float volume)
+{
+	sfx_volume_ = volume;
+	sfx_volume_dirty_ = true;
+}
+
+VoiceHandle AudioSystem::Play(SoundHandle sound, bool looping)
+{
+	if(sound.index < 0)
+		return {};
+	return Start(sound.index, looping);
+}
+
+VoiceHandle AudioSystem::PlayAt(SoundHandle sound, const gef::Vector2& position)
+{
+	if(sound.index < 0)
+		return {};
+
+	const float audible_distance = sounds_[sound.index].desc.audible_distance;
+	if(audible_distance > 0.f)
+	{
+		const float dx = position.x - listener_.x;
+		const float dy = position.y - listener_.y;
+		if(dx * dx + dy * dy > audible_distance * audible_distance)
+			return {};
+	}
+	return Start(sound.index, false);
+}
+
+void AudioSystem::Stop(VoiceHandle& voice)
+{
+	if(IsPlaying(voice))
+	{
+		std::unique_lock<std::mutex> lock(audio_mutex_, std::try_to_lock);
+		if(lock.owns_lock())
+			StopVoice(voice.voice);
+		else
+			pending_stops_.push_back(voice);
+	}
+	voice = {};
+}
+
+bool AudioSystem::IsPlaying(VoiceHandle voice) const
+{
+	if(voice.voice < 0)
+		return false;
+	const Voice& playing = voices_[voice.voice];
+	return playing.playing && playing.generation == voice.generation;
+}
+
+void AudioSystem::Update()
+{
+	PROFILE_ZONE("AudioSystem::Update");
+
+	// Everything waits for next frame while a decode has the audio manager
+	std::unique_lock<std::mutex> audio_lock(audio_mutex_, std::try_to_lock);
+	if(!audio_lock.owns_lock())
+		return;
+
+	bool apply_music_volume = false;
+	float music_volume = 0.f;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		receiving_.swap(loaded_);
+		apply_music_volume = music_volume_dirty_ && music_loaded_;
+		music_volume = music_volume_;
+		if(apply_music_volume)
+			music_volume_dirty_ = false;
+	}
+
+	for(const LoadedSample& loaded : receiving_)
+	{
+		Voice& voice = voices_[loaded.voice];
+		if(loaded.sample < 0)
+		{
+			gef::DebugOut(("Could not load sound " + std::string(sounds_[voice.sound].desc.file) + "\n").c_str());
+			continue;
+		}
+		voice.sample = loaded.sample;
+		ApplyVolume(voice);
+	}
+	receiving_.clear();
+
+	if(apply_music_volume)
+	{
+		gef::VolumeInfo volume_info;
+		audio_manager_->GetMusicVolumeInfo(volume_info);
+		volume_info.volume = music_volume;
+		audio_manager_->SetMusicVolumeInfo(volume_info);
+	}
+
+	if(sfx_volume_dirty_)
+	{
+		for(const Voice& voice : voices_)
+		{
+			ApplyVolume(voice);
+		}
+		sfx_volume_dirty_ = false;
+	}
+
+	for(const VoiceHandle& stop : pending_stops_)
+	{
+		if(IsPlaying(stop))
+			StopVoice(stop.voice);
+	}
+	pending_stops_.clear();
+
+	// Looping voices play until they're stopped
+	for(Voice& voice : voices_)
+	{
+		if(voice.playing && !voice.looping && !audio_manager_->sample_voice_playing(voice.sample))
+		{
+			voice.playing = false;
+			active_voices_--;
+		}
+	}
+}
+
+VoiceHandle AudioSystem::Start(int sound, bool looping)
+{
+	// Dropped rather than stall the frame on a decode
+	std::unique_lock<std::mutex> lock(audio_mutex_, std::try_to_lock);
+	if(!lock.owns_lock())
+		return {};
+
+	const Sound& played = sounds_[sound];
+	int free_voice = -1, oldest_voice = -1;
+	for(int i = played.first_voice; i < played.first_voice + played.desc.copies; i++)
+	{
+		if(voices_[i].sample < 0)
+			continue;
+		if(!voices_[i].playing)
+		{
+			free_voice = i;
+			break;
+		}
+		if(oldest_voice < 0 || voices_[i].started < voices_[oldest_voice].started)
+			oldest_voice = i;
+	}
+
+	int voice = free_voice;
+	if(voice < 0)
+	{
+		// Not loaded yet
+		if(oldest_voice < 0)
+			return {};
+
+		voice = oldest_voice;
+		StopVoice(voice);
+	}
+	else if(active_voices_ >= max_voices_)
+	{
+		const int taken = FindVoiceToTake(played.desc.priority);
+		if(taken < 0)
+			return {};
+		StopVoice(taken);
+	}
+
+	Voice& starting = voices_[voice];
+	audio_manager_->PlaySample(starting.sample, looping);
+	starting.playing = true;
+	starting.looping = looping;
+	starting.generation++;
+	starting.started = ++plays_;
+	active_voices_++;
+	return { voice, starting.generation };
+}
+
+int AudioSystem::FindVoiceToTake(int priority) const
+{
+	int taken = -1;
+	for(int i = 0; i < (int)voices_.size(); i++)
+	{
+		const Voice& voice = voices_[i];
+		if(!voice.playing)
+			continue;
+
+		const int voice_priority = sounds_[voice.sound].desc.priority;
+		if(voice_priority > priority)
+			continue;
+
+		if(taken < 0)
+		{
+			taken = i;
+			continue;
+		}
+		const int taken_priority = sounds_[voices_[taken].sound].desc.priority;
+		if(voice_priority < taken_priority || (voice_priority == taken_priority && voice.started < voices_[taken].started))
+			taken = i;
+	}
+	return taken;
+}
+
+void AudioSystem::StopVoice(int voice)
+{
+	Voice& stopping = voices_[voice];
+	audio_manager_->StopPlayingSampleVoice(stopping.sample);
+	stopping.playing = false;
+	stopping.generation++;
+	active_voices_--;
+}
+
+void AudioSystem::ApplyVolume(const Voice& voice)
+{
+	if(voice.sample < 0)
+		return;
+
+	gef::VolumeInfo volume_info;
+	audio_manager_->GetSampleVoiceVolumeInfo(voice.sample, volume_info);
+	volume_info.volume = sounds_[voice.sound].desc.volume * sfx_volume_ / 100.f;
+	audio_manager_->SetSampleVoiceVolumeInfo(voice.sample, volume_info);
+}
+
+void AudioSystem::WorkerLoop()
+{
+	Profiler::SetThreadName("Audio");
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(true)
+	{
+		wake_.wait(lock, [this] { return stopping_ || !requests_.empty(); });
+		if(stopping_)
+			break;
+
+		LoadRequest request = std::move(requests_.front());
+		requests_.pop_front();
+		lock.unlock();
+
+		if(request.voice >= 0)
+		{
+			int sample;
+			{
+				PROFILE_ZONE("AudioSystem decode sample");
+				std::lock_guard<std::mutex> audio_lock(audio_mutex_);
+				sample = audio_manager_->LoadSample(request.file.c_str(), platform_);
+			}
+
+			lock.lock();
+			loaded_.push_back({ request.voice, sample });
+		}
+		else
+		{
+			PROFILE_ZONE("AudioSystem decode music");
+			std::lock_guard<std::mutex> audio_lock(audio_mutex_);
+			audio_manager_->LoadMusic(request.file.c_str(), platform_);
+
+			lock.lock();
+			music_loaded_ = true;
+			gef::VolumeInfo volume_info;
+			audio_manager_->GetMusicVolumeInfo(volume_info);
+			volume_info.volume = music_volume_;
+			music_volume_dirty_ = false;
+			audio_manager_->SetMusicVolumeInfo(volume_info);
+			audio_manager_->PlayMusic();
+		}
+	}
+}
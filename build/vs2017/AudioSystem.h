@@ -0,0 +1,142 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "maths/vector2.h"
+
+namespace gef
+{
+	class AudioManager;
+	class Platform;
+}
+
+// A sound registered with AudioSystem::AddSound. Look it up by name once and keep it
+struct SoundHandle
+{
+	int index = -1;
+};
+
+// One play of a sound. Stops counting as playing once the sound ends or its voice goes to another
+struct VoiceHandle
+{
+	int voice = -1;
+	uint32_t generation = 0;
+};
+
+struct SoundDesc
+{
+	const char* file = nullptr;
+	// How many of it can play at once, each one is its own copy of the sample
+	int copies = 1;
+	// Only sounds of the same or higher priority can take its voice
+	int priority = 0;
+	float volume = 100.f;
+	// PlayAt further than this from the listener is culled, 0 is heard anywhere
+	float audible_distance = 0.f;
+};
+
+// Plays named sounds over gef::AudioManager, where every copy of a sample is one voice.
+// No more than max_voices play at once. A sound out of copies restarts its oldest one, and once the
+// mixer is full a new sound takes the voice of the oldest one of the lowest priority, if that isn't above it.
+// Samples and music are decoded on a thread of their own so nothing waits on them. Anything played
+// before its sample is in, or while a decode has the audio manager, is dropped
+class AudioSystem
+{
+public:
+	AudioSystem(gef::AudioManager* audio_manager, gef::Platform& platform, int max_voices = 8);
+	~AudioSystem();
+	AudioSystem(const AudioSystem&) = delete;
+	AudioSystem& operator=(const AudioSystem&) = delete;
+
+	// Queues the sample for loading. Add every sound before anything looks them up
+	SoundHandle AddSound(const std::string& name, const SoundDesc& desc);
+	SoundHandle GetSound(const std::string& name) const;
+
+	// Starts the music once it has loaded
+	void PlayMusic(const char* file, float volume);
+	void SetMusicVolume(float volume);
+	// 0 to 100, over each sound's own volume
+	void SetSfxVolume(float volume);
+
+	VoiceHandle Play(SoundHandle sound, bool looping = false);
+	VoiceHandle PlayAt(SoundHandle sound, const gef::Vector2& position);
+	void Stop(VoiceHandle& voice);
+	bool IsPlaying(VoiceHandle voice) const;
+
+	void SetListener(const gef::Vector2& position) { listener_ = position; }
+
+	// Takes in finished loads, applies volume changes and frees the voices of sounds that have ended
+	void Update();
+
+private:
+	struct Sound
+	{
+		SoundDesc desc;
+		int first_voice;
+	};
+
+	struct Voice
+	{
+		int sound;
+		int sample = -1;
+		bool playing = false;
+		bool looping = false;
+		uint32_t generation = 0;
+		uint64_t started = 0;
+	};
+
+	struct LoadRequest
+	{
+		std::string file;
+		// Voice the sample is for, or -1 for the music
+		int voice;
+	};
+
+	struct LoadedSample
+	{
+		int voice;
+		int sample;
+	};
+
+	VoiceHandle Start(int sound, bool looping);
+	int FindVoiceToTake(int priority) const;
+	void StopVoice(int voice);
+	void ApplyVolume(const Voice& voice);
+	void WorkerLoop();
+
+	gef::AudioManager* audio_manager_;
+	gef::Platform& platform_;
+	const int max_voices_;
+
+	std::vector<Sound> sounds_;
+	std::unordered_map<std::string, int> sound_names_;
+	std::vector<Voice> voices_;
+	int active_voices_ = 0;
+	uint64_t plays_ = 0;
+	std::vector<VoiceHandle> pending_stops_;
+
+	gef::Vector2 listener_ = gef::Vector2(0.f, 0.f);
+	float sfx_volume_ = 100.f;
+	bool sfx_volume_dirty_ = false;
+
+	// Held around every call into the audio manager, a decode holds it for as long as it takes
+	std::mutex audio_mutex_;
+
+	// Guards everything below, shared with the worker
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::deque<LoadRequest> requests_;
+	std::vector<LoadedSample> loaded_;
+	std::vector<LoadedSample> receiving_;
+	float music_volume_ = 100.f;
+	bool music_volume_dirty_ = false;
+	bool music_loaded_ = false;
+	bool stopping_ = false;
+
+	std::thread worker_;
+};
@@ -6,6 +6,7 @@
 Bullet::Bullet()
 {
 	tag = Tag::Bullet;
+	SubscribeContacts(ContactBegin);
 }
 
 void Bullet::Fire(gef::Vector2 target_vector, gef::Vector2 start_pos, int damage, GameObject::Tag target, float speed)
@@ -20,17 +21,12 @@ void Bullet::Fire(gef::Vector2 target_vector, gef::Vector2 start_pos, int damage
 	physics_body_->SetEnabled(true);
 	physics_body_->SetTransform(b2_start_pos, atan2(target_vector.x, target_vector.y));
 	physics_body_->SetLinearVelocity({b2_target_vector.x, b2_target_vector.y});
-	EnableCollisionResolution(bCollisionEnabled);
-}
-
-void Bullet::Update(float frame_time)
-{
-	EnableCollisionResolution(bCollisionEnabled);
-	GameObject::Update(frame_time);
+	SetCollisionLayer(target == Tag::Player ? CollisionLayer::EnemyBullet : CollisionLayer::PlayerBullet);
 }
 
 void Bullet::BeginCollision(GameObject* other)
 {
+	// Filtered out by the collision layers, unless filtering is off
 	if(other->GetTag() == Tag::Bullet || other->GetTag() == Tag::Pickup)
 	{
 		return;
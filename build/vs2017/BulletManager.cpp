@@ -1,6 +1,8 @@
 #include "BulletManager.h"
+#include "RenderSnapshot.h"
+#include "SimulationTimings.h"
 
-void BulletManager::Init(b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool player_gun) {
+void BulletManager::Init(b2World* world, PrimitiveBuilder* builder, AudioSystem* am, bool player_gun) {
 	world_ = world;
 	builder_ = builder;
 	am_ = am;
@@ -9,6 +11,7 @@ void BulletManager::Init(b2World* world, PrimitiveBuilder* builder, gef::AudioMa
  
 void BulletManager::Update(float frame_time)
 {
+	ScopedSimulationTimer timer("BulletManager::Update", &SimulationTimings::bullets);
 	for (size_t i=0; i < bullets_.size(); i++) {
 		Bullet* bullet = bullets_[i];
 		if(bullet != nullptr)
@@ -32,10 +35,19 @@ void BulletManager::Fire(gef::Vector2 target_vector, gef::Vector2 start_pos, int
 	bullets_.back()->Fire(target_vector, start_pos, damage, target, speed);
 }
 
-void BulletManager::Render(gef::Renderer3D* renderer_3d) const {
-	if(!bullets_.empty() && bullets_[0]->getTarget() == GameObject::Tag::Player) renderer_3d->set_override_material(&builder_->red_material());
+void BulletManager::Render(RenderSnapshot& snapshot) const {
+	if(!bullets_.empty() && bullets_[0]->getTarget() == GameObject::Tag::Player) snapshot.SetOverrideMaterial(&builder_->red_material());
 	for (Bullet* bullet : bullets_) {
-		renderer_3d->DrawMesh(*bullet);
+		snapshot.DrawMesh(*bullet);
 	}
-	renderer_3d->set_override_material(NULL);
+	snapshot.SetOverrideMaterial(NULL);
+}
+
+void BulletManager::Clear()
+{
+	for (Bullet* bullet : bullets_) {
+		world_->DestroyBody(bullet->GetBody());
+		delete bullet;
+	}
+	bullets_.clear();
 }
\ No newline at end of file
@@ -1,8 +1,7 @@
 ﻿#include "Button.h"
 #include <utility>
 #include "InputActionManager.h"
-#include "graphics/font.h"
-#include "graphics/sprite_renderer.h"
+#include "Overlay.h"
 #include "input/input_manager.h"
 #include "input/touch_input_manager.h"
 #include "system/platform.h"
@@ -64,10 +63,10 @@ void Button::Update(InputActionManager* iam, float frame_time)
 	}
 }
 
-void Button::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) const
+void Button::Render(Overlay& overlay) const
 {
-	sprite_renderer->DrawSprite(button);
-	font->RenderText(sprite_renderer, gef::Vector4(platform_->width() * anchor_.x, platform_->height() * anchor_.y - button.height() / 4.f, -0.9f), 1.0f, text_color_.GetABGR(), gef::TJ_CENTRE,text_.c_str()); 
+	overlay.DrawSprite(button);
+	overlay.DrawText(gef::Vector4(platform_->width() * anchor_.x, platform_->height() * anchor_.y - button.height() / 4.f, -0.9f), 1.0f, text_color_.GetABGR(), gef::TJ_CENTRE, text_.c_str());
 }
 
 void Button::SetAlpha(float alpha)
@@ -48,14 +48,8 @@ void Camera::Update(float dt, gef::Vector2 target_pos) {
 
 	camera_pos_ = camera_lookat_ + gef::Vector4(0, 0, 30);
 
-	// Camera shaking effects
+	// Camera shaking effects, timed by PlayEffect
 	if (effect_state_ != EffectState::NORMAL) { 
-		if (shake_time_ <= 0.0f) {
-			effect_state_ = EffectState::NORMAL;
-			shake_time_ = 0.2f;
-		}
-		shake_time_ -= dt;
-
 		if (effect_state_ == EffectState::WARP) {
 			offset_ = gef::Vector4(sin(40 * shake_time_), sin(40 * shake_time_), 0);
 			camera_pos_ += offset_;
@@ -73,11 +67,25 @@ void Camera::Update(float dt, gef::Vector2 target_pos) {
 	background_.set_transform(transform_matrix_);
 }
 
+void Camera::Warp() {
+	if (scheduler_ == nullptr) return;
+	scheduler_->Cancel(effect_task_);
+	effect_task_ = scheduler_->Start(PlayEffect(EffectState::WARP));
+}
+
 void Camera::Shake() {
-	if (effect_state_ == EffectState::NORMAL) {
-		effect_state_ = EffectState::SHAKE; 
+	if (effect_state_ == EffectState::NORMAL && scheduler_ != nullptr) {
 		shake_start_lookat_ = camera_lookat_;
+		effect_task_ = scheduler_->Start(PlayEffect(EffectState::SHAKE));
+	}
+}
+
+Task Camera::PlayEffect(EffectState effect) {
+	effect_state_ = effect;
+	for (shake_time_ = 0.2f; shake_time_ > 0.0f;) {
+		shake_time_ -= co_await NextFrame();
 	}
+	effect_state_ = EffectState::NORMAL;
 }
 
 void Camera::SetPosition(gef::Vector4 pos) {
@@ -4,6 +4,7 @@
 #include "maths/matrix44.h"
 #include "graphics/mesh_instance.h"
 #include <queue>
+#include "Scheduler.h"
 
 enum class EffectState { NORMAL, SHAKE, WARP };
 
@@ -12,14 +13,18 @@ class Camera
 public:
 	Camera();
 	void Update(float dt, gef::Vector2 target_pos);
-	gef::Matrix44 GetViewMatrix() { return view_matrix_; }
-	void Warp() { shake_time_ = 0.2f; effect_state_ = EffectState::WARP; }
+	gef::Matrix44 GetViewMatrix() const { return view_matrix_; }
+	void Warp();
 	void Shake();
+	void SetScheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
 	void SetPosition(gef::Vector4 pos);
 	void SetAbovePlayer(bool value) { above_player_ = value; }
 	gef::MeshInstance* GetBackground() { return &background_; }
+	const gef::MeshInstance* GetBackground() const { return &background_; }
 	EffectState GetEffectState() { return effect_state_; }
 protected:
+	Task PlayEffect(EffectState effect);
+
 	gef::Vector4 target_pos_ = gef::Vector4(0.0f, 0.0f, 0.0f);
 	gef::Vector4 camera_pos_ = gef::Vector4(0.0f, 0.0f, 0.0f);
 	gef::Vector4 camera_lookat_ = gef::Vector4(0.0f, 0.0f, 0.0f);
@@ -29,6 +34,8 @@ protected:
 	gef::Matrix44 view_matrix_;
 	EffectState effect_state_ = EffectState::NORMAL;
 	float shake_time_ = 0.2f;
+	Scheduler* scheduler_ = nullptr;
+	TaskHandle effect_task_;
 	enum class MoveState { STATIONARY, LERP, TRACK };
 	MoveState move_state_ = MoveState::STATIONARY;
 	float lerp_time_ = 0.2f;
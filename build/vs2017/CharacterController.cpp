@@ -0,0 +1,74 @@
+#include "CharacterController.h"
+
+namespace
+{
+	// Which way is right along the ground
+	b2Vec2 RightFor(GravityDirection direction)
+	{
+		switch (direction)
+		{
+		case GravityDirection::GRAVITY_LEFT:
+			return b2Vec2(0, -1);
+		case GravityDirection::GRAVITY_RIGHT:
+			return b2Vec2(0, 1);
+		default:
+			return b2Vec2(1, 0);
+		}
+	}
+
+	// Feet towards gravity
+	float AngleFor(GravityDirection direction)
+	{
+		switch (direction)
+		{
+		case GravityDirection::GRAVITY_UP:
+			return b2_pi;
+		case GravityDirection::GRAVITY_LEFT:
+			return -0.5f * b2_pi;
+		case GravityDirection::GRAVITY_RIGHT:
+			return 0.5f * b2_pi;
+		default:
+			return 0.f;
+		}
+	}
+}
+
+void CharacterController::Init(b2Body* body, float move_speed)
+{
+	body_ = body;
+	move_speed_ = move_speed;
+	Reset();
+}
+
+void CharacterController::Step()
+{
+	if (body_ == nullptr)
+		return;
+
+	// Walking sets the speed along the ground outright, or friction would wear it down.
+	// Letting go stops dead like it always has, otherwise the body is left to the physics,
+	// so falling, jumping and being knocked about carry on as they would
+	const b2Vec2 right = RightFor(gravity_direction_);
+	const b2Vec2 velocity = body_->GetLinearVelocity();
+	const float along = b2Dot(velocity, right);
+	const bool walking = move_ != 0.f;
+	if (walking || walking_)
+	{
+		const float target = walking ? move_ * move_speed_ : 0.f;
+		if (target != along)
+			body_->SetLinearVelocity(velocity + (target - along) * right);
+	}
+	walking_ = walking;
+
+	// Rotation is fixed, so the angle only changes when it's set here
+	const float angle = AngleFor(gravity_direction_);
+	if (body_->GetAngle() != angle)
+		body_->SetTransform(body_->GetPosition(), angle);
+}
+
+void CharacterController::Reset()
+{
+	move_ = 0.f;
+	walking_ = false;
+	gravity_direction_ = GravityDirection::GRAVITY_DOWN;
+}
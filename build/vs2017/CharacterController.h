@@ -0,0 +1,26 @@
+#pragma once
+#include <box2d/box2d.h>
+
+#include "GameObject.h"
+
+// Walks a dynamic body along the ground for whichever way gravity pulls it, through its velocity so
+// box2d moves it with everything else during the step rather than it being teleported between them.
+// The body's transform is only set when gravity turns it to face a new way, never more than once a step
+class CharacterController
+{
+public:
+	void Init(b2Body* body, float move_speed);
+	// -1 walks left and 1 right as seen with gravity pointing down the screen, 0 stands still
+	void Move(float direction) { move_ = direction; }
+	void SetGravityDirection(GravityDirection direction) { gravity_direction_ = direction; }
+	// Call once a frame, after Move and SetGravityDirection
+	void Step();
+	void Reset();
+
+private:
+	b2Body* body_ = nullptr;
+	float move_speed_ = 0.f;
+	float move_ = 0.f;
+	bool walking_ = false;
+	GravityDirection gravity_direction_ = GravityDirection::GRAVITY_DOWN;
+};
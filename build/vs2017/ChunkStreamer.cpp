@@ -0,0 +1,179 @@
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "ContactGraph.h"
+#include "GameObject.h"
+
+void ChunkStreamer::Init(float chunk_width, int enter_radius, int exit_radius)
+{
+	chunk_width_ = chunk_width;
+	enter_radius_ = enter_radius;
+	exit_radius_ = std::max(exit_radius, enter_radius);
+	full_update_ = true;
+}
+
+void ChunkStreamer::AddStatic(GameObject* object)
+{
+	const b2Body* body = object->GetBody();
+	if(body == nullptr)
+		return;
+
+	float min_x = body->GetPosition().x;
+	float max_x = min_x;
+	for(const b2Fixture* fixture = body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+	{
+		for(int child = 0; child < fixture->GetShape()->GetChildCount(); child++)
+		{
+			b2AABB aabb;
+			fixture->GetShape()->ComputeAABB(&aabb, body->GetTransform(), child);
+			min_x = std::min(min_x, aabb.lowerBound.x);
+			max_x = std::max(max_x, aabb.upperBound.x);
+		}
+	}
+
+	statics_.push_back({ object, ChunkOf(min_x), ChunkOf(max_x) });
+	buckets_dirty_ = true;
+	full_update_ = true;
+}
+
+void ChunkStreamer::AddDynamic(GameObject* object)
+{
+	if(object->GetBody() == nullptr)
+		return;
+
+	dynamics_.push_back({ object, ChunkOf(object->GetBody()->GetPosition().x) });
+	full_update_ = true;
+}
+
+void ChunkStreamer::Update(float player_x)
+{
+	if(buckets_dirty_)
+	{
+		int first = 0, last = -1;
+		for(const StaticEntry& entry : statics_)
+		{
+			first = last < first ? entry.first_chunk : std::min(first, entry.first_chunk);
+			last = std::max(last, entry.last_chunk);
+		}
+
+		first_chunk_ = first;
+		static_buckets_.assign(statics_.empty() ? 0 : last - first + 1, {});
+		for(int i = 0; i < (int)statics_.size(); i++)
+		{
+			for(int chunk = statics_[i].first_chunk; chunk <= statics_[i].last_chunk; chunk++)
+			{
+				static_buckets_[ChunkBucket(chunk)].push_back(i);
+			}
+		}
+		buckets_dirty_ = false;
+	}
+
+	const int player_chunk = ChunkOf(player_x);
+	if(full_update_)
+	{
+		for(const StaticEntry& entry : statics_)
+		{
+			UpdateStatic(entry, player_chunk);
+		}
+		full_update_ = false;
+	}
+	else if(player_chunk != player_chunk_)
+	{
+		// Only statics in reach of where the player was or is now can change
+		const int reach = exit_radius_ + 1;
+		const int first = std::max(ChunkBucket(std::min(player_chunk, player_chunk_) - reach), 0);
+		const int last = std::min(ChunkBucket(std::max(player_chunk, player_chunk_) + reach), (int)static_buckets_.size() - 1);
+		for(int bucket = first; bucket <= last; bucket++)
+		{
+			for(int index : static_buckets_[bucket])
+			{
+				UpdateStatic(statics_[index], player_chunk);
+			}
+		}
+	}
+	player_chunk_ = player_chunk;
+
+	for(DynamicEntry& entry : dynamics_)
+	{
+		UpdateDynamic(entry, player_chunk);
+	}
+}
+
+void ChunkStreamer::Reset()
+{
+	for(const StaticEntry& entry : statics_)
+	{
+		entry.object->SetFrozen(false);
+	}
+	for(const DynamicEntry& entry : dynamics_)
+	{
+		entry.object->SetFrozen(false);
+	}
+	full_update_ = true;
+}
+
+void ChunkStreamer::Clear()
+{
+	statics_.clear();
+	static_buckets_.clear();
+	dynamics_.clear();
+	buckets_dirty_ = false;
+	full_update_ = true;
+}
+
+int ChunkStreamer::ChunkOf(float x) const
+{
+	return (int)std::floor(x / chunk_width_);
+}
+
+void ChunkStreamer::UpdateStatic(const StaticEntry& entry, int player_chunk)
+{
+	int distance = 0;
+	if(player_chunk < entry.first_chunk)
+		distance = entry.first_chunk - player_chunk;
+	else if(player_chunk > entry.last_chunk)
+		distance = player_chunk - entry.last_chunk;
+
+	GameObject* object = entry.object;
+	if(object->IsFrozen())
+	{
+		if(distance <= enter_radius_ + 1)
+			object->SetFrozen(false);
+	}
+	else if(distance > exit_radius_ + 1)
+	{
+		object->SetFrozen(true);
+	}
+}
+
+void ChunkStreamer::UpdateDynamic(DynamicEntry& entry, int player_chunk)
+{
+	GameObject* object = entry.object;
+
+	// Its body is already out of the world, a restart brings it back
+	if(object->TimeToDie())
+		return;
+
+	if(!object->IsFrozen())
+	{
+		entry.chunk = ChunkOf(object->GetBody()->GetPosition().x);
+	}
+
+	const int distance = std::abs(entry.chunk - player_chunk);
+	if(object->IsFrozen())
+	{
+		if(distance <= enter_radius_)
+			object->SetFrozen(false);
+	}
+	else if(distance > exit_radius_)
+	{
+		// Taking away anything that weighs on a pressure plate would let its door shut
+		if(contact_graph_ != nullptr && contact_graph_->IsConnectedTo(object, GameObject::Tag::PressurePlate))
+			return;
+
+		object->SetFrozen(true);
+	}
+}
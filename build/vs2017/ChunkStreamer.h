@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+class ContactGraph;
+class GameObject;
+
+// Keeps only the bodies near the player in the physics world.
+// The level is cut into columns chunk_width wide. Objects come back into the simulation once
+// they're within enter_radius chunks of the player's chunk, and are frozen again when they're
+// more than exit_radius chunks away, so walking along a chunk edge doesn't flip them back and forth.
+// Static colliders use one chunk more either side than moving objects, so nothing is ever
+// left standing on ground that has been taken away
+class ChunkStreamer
+{
+public:
+	void Init(float chunk_width, int enter_radius, int exit_radius);
+	void SetContactGraph(ContactGraph* contact_graph) { contact_graph_ = contact_graph; }
+
+	// Objects that never move, placed by the extent of their fixtures
+	void AddStatic(GameObject* object);
+	// Objects that move around, placed by where they are while they're being simulated
+	void AddDynamic(GameObject* object);
+
+	void Update(float player_x);
+
+	// Thaws everything and has the next Update look at every object again, for restarts
+	void Reset();
+	void Clear();
+
+private:
+	struct StaticEntry
+	{
+		GameObject* object;
+		int first_chunk;
+		int last_chunk;
+	};
+
+	struct DynamicEntry
+	{
+		GameObject* object;
+		int chunk;
+	};
+
+	int ChunkOf(float x) const;
+	int ChunkBucket(int chunk) const { return chunk - first_chunk_; }
+	void UpdateStatic(const StaticEntry& entry, int player_chunk);
+	void UpdateDynamic(DynamicEntry& entry, int player_chunk);
+
+	float chunk_width_ = 16.f;
+	int enter_radius_ = 2;
+	int exit_radius_ = 3;
+	ContactGraph* contact_graph_ = nullptr;
+
+	// Statics are looked up by chunk, so a move only touches the chunks near the player
+	std::vector<StaticEntry> statics_;
+	std::vector<std::vector<int>> static_buckets_;
+	int first_chunk_ = 0;
+	bool buckets_dirty_ = false;
+
+	std::vector<DynamicEntry> dynamics_;
+
+	int player_chunk_ = 0;
+	bool full_update_ = true;
+};
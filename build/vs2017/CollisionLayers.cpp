@@ -0,0 +1,97 @@
+#include "CollisionLayers.h"
+
+#include <algorithm>
+#include <string>
+
+#include "AssetFile.h"
+#include "json.h"
+#include "system/debug_log.h"
+
+uint16_t CollisionLayers::masks_[(int)CollisionLayer::Count] = {};
+bool CollisionLayers::loaded_ = false;
+bool CollisionLayers::enabled_ = true;
+
+namespace
+{
+	const char* layer_names[] = { "Static", "Player", "Enemy", "PlayerBullet", "EnemyBullet", "Pickup", "Crate", "Trigger" };
+	static_assert(sizeof(layer_names) / sizeof(layer_names[0]) == (size_t)CollisionLayer::Count, "a layer is missing its name");
+
+	CollisionLayer LayerFromName(const std::string& name)
+	{
+		for(int i = 0; i < (int)CollisionLayer::Count; i++)
+		{
+			if(name == layer_names[i])
+				return (CollisionLayer)i;
+		}
+		return CollisionLayer::Count;
+	}
+}
+
+bool CollisionLayers::Load(const char* filename)
+{
+	AssetFile file;
+	if(!file.Open(filename))
+	{
+		gef::DebugOut(("Could not open " + std::string(filename) + ", collision filtering is off\n").c_str());
+		return false;
+	}
+
+	const nlohmann::json config = nlohmann::json::parse(file.begin(), file.end(), nullptr, false);
+	if(config.is_discarded())
+	{
+		gef::DebugOut(("Could not parse " + std::string(filename) + ", collision filtering is off\n").c_str());
+		return false;
+	}
+
+	// Layers are fixed by CollisionLayer, the list is there to say so and has to match it
+	const nlohmann::json layers = config.value("layers", nlohmann::json::array());
+	bool layers_match = layers.size() == (size_t)CollisionLayer::Count;
+	for(size_t i = 0; layers_match && i < layers.size(); i++)
+	{
+		layers_match = layers[i].is_string() && layers[i].get<std::string>() == layer_names[i];
+	}
+	if(!layers_match)
+	{
+		gef::DebugOut(("Layers in " + std::string(filename) + " don't match CollisionLayer, collision filtering is off\n").c_str());
+		return false;
+	}
+
+	uint16_t masks[(int)CollisionLayer::Count] = {};
+	for(const auto& entry : config.value("collides", nlohmann::json::array()))
+	{
+		const std::string name = entry.value("layer", "");
+		const CollisionLayer layer = LayerFromName(name);
+		if(layer == CollisionLayer::Count)
+		{
+			gef::DebugOut(("Unknown collision layer " + name + " in " + filename + "\n").c_str());
+			continue;
+		}
+
+		for(const auto& other_name : entry.value("with", nlohmann::json::array()))
+		{
+			const CollisionLayer other = LayerFromName(other_name.get<std::string>());
+			if(other == CollisionLayer::Count)
+			{
+				gef::DebugOut(("Unknown collision layer " + other_name.get<std::string>() + " in " + filename + "\n").c_str());
+				continue;
+			}
+			masks[(int)layer] |= 1 << (int)other;
+			masks[(int)other] |= 1 << (int)layer;
+		}
+	}
+
+	std::copy(std::begin(masks), std::end(masks), masks_);
+	loaded_ = true;
+	return true;
+}
+
+b2Filter CollisionLayers::FilterFor(CollisionLayer layer)
+{
+	b2Filter filter;
+	if(loaded_ && enabled_)
+	{
+		filter.categoryBits = 1 << (int)layer;
+		filter.maskBits = masks_[(int)layer];
+	}
+	return filter;
+}
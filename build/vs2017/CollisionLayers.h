@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include "box2d/b2_fixture.h"
+
+// What a body is as far as collision filtering goes. Static comes first so its category
+// is box2d's default, and bodies nobody gave a layer act like level geometry
+enum class CollisionLayer : uint8_t
+{
+	Static,
+	Player,
+	Enemy,
+	PlayerBullet,
+	EnemyBullet,
+	Pickup,
+	Crate,
+	Trigger,
+	Count
+};
+
+// Which layers touch which, read from config/collision.json and handed to box2d as
+// category and mask bits so pairs that never matter don't make it out of the broadphase.
+// Pairs are symmetric, listing one side is enough. The file's "layers" has to list this
+// enum's names in order, adding a layer means adding it here first
+class CollisionLayers
+{
+public:
+	// Until this succeeds, or while filtering is off, everything touches everything
+	static bool Load(const char* filename);
+	static void SetEnabled(bool enabled) { enabled_ = enabled; }
+
+	static b2Filter FilterFor(CollisionLayer layer);
+
+private:
+	static uint16_t masks_[(int)CollisionLayer::Count];
+	static bool loaded_;
+	static bool enabled_;
+};
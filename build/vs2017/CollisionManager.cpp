@@ -1,70 +1,130 @@
 ﻿#include "CollisionManager.h"
 
 
+#include "ContactGraph.h"
 #include "GameObject.h"
+#include "Profiler.h"
 #include "box2d/b2_contact.h"
+#include "box2d/b2_world.h"
 
-void CollisionManager::BeginContact(b2Contact* contact)
+namespace
 {
-	auto* a = reinterpret_cast<GameObject*>(contact->GetFixtureA()->GetUserData().pointer);
-	auto* b = reinterpret_cast<GameObject*>(contact->GetFixtureB()->GetUserData().pointer);
-
- 	if(a != nullptr && !a->TimeToDie())
+	GameObject* ObjectOf(b2Fixture* fixture)
 	{
-		a->BeginCollision(b);
+		return reinterpret_cast<GameObject*>(fixture->GetUserData().pointer);
 	}
 
- 	if(b != nullptr && !b->TimeToDie())
+	bool Wants(GameObject* object, GameObject::ContactPhase phase)
 	{
-		b->BeginCollision(a);
+		return object != nullptr && object->WantsContacts(phase) && !object->TimeToDie();
 	}
+}
 
+void CollisionManager::BeginContact(b2Contact* contact)
+{
+	callbacks_++;
+	const ContactEvent event = { ObjectOf(contact->GetFixtureA()), ObjectOf(contact->GetFixtureB()), true };
+	if(dispatching_ || contact->GetFixtureA()->GetBody()->GetWorld()->IsLocked())
+		events_.push_back(event);
+	else
+		Dispatch(event);
 }
 
 void CollisionManager::EndContact(b2Contact* contact)
 {
-	auto* a = reinterpret_cast<GameObject*>(contact->GetFixtureA()->GetUserData().pointer);
-	auto* b = reinterpret_cast<GameObject*>(contact->GetFixtureB()->GetUserData().pointer);
+	callbacks_++;
+	const ContactEvent event = { ObjectOf(contact->GetFixtureA()), ObjectOf(contact->GetFixtureB()), false };
+	if(dispatching_ || contact->GetFixtureA()->GetBody()->GetWorld()->IsLocked())
+		events_.push_back(event);
+	else
+		Dispatch(event);
+}
+
+void CollisionManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+{
+	callbacks_++;
+	GameObject* a = ObjectOf(contact->GetFixtureA());
+	GameObject* b = ObjectOf(contact->GetFixtureB());
 
- 	if(a != nullptr && !a->TimeToDie())
+	if(Wants(a, GameObject::ContactPreSolve))
 	{
-		a->EndCollision(b);
+		dispatches_++;
+		a->PreResolve(b);
 	}
 
- 	if(b != nullptr && !b->TimeToDie())
+	if(Wants(b, GameObject::ContactPreSolve))
 	{
-		b->EndCollision(a);
+		dispatches_++;
+		b->PreResolve(a);
 	}
 }
 
-void CollisionManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+void CollisionManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
 {
-	auto* a = reinterpret_cast<GameObject*>(contact->GetFixtureA()->GetUserData().pointer);
- 	auto* b = reinterpret_cast<GameObject*>(contact->GetFixtureB()->GetUserData().pointer);
-
- 	if(a != nullptr && !a->TimeToDie())
- 	{
- 		a->PreResolve(b);
- 	}
- 
- 	if(b != nullptr && !b->TimeToDie())
- 	{
- 		b->PreResolve(a);
- 	}
+	callbacks_++;
+	GameObject* a = ObjectOf(contact->GetFixtureA());
+	GameObject* b = ObjectOf(contact->GetFixtureB());
+
+	if(Wants(a, GameObject::ContactPostSolve))
+	{
+		dispatches_++;
+		a->PostResolve(b);
+	}
+
+	if(Wants(b, GameObject::ContactPostSolve))
+	{
+		dispatches_++;
+		b->PostResolve(a);
+	}
 }
 
-void CollisionManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+void CollisionManager::DispatchEvents()
+{
+	PROFILE_ZONE("CollisionManager::DispatchEvents");
+
+	// Handlers can change the world and add to the queue, by index as it may grow
+	dispatching_ = true;
+	for(size_t i = 0; i < events_.size(); i++)
+	{
+		const ContactEvent event = events_[i];
+		Dispatch(event);
+	}
+	events_.clear();
+	dispatching_ = false;
+
+	last_callbacks_ = callbacks_;
+	last_dispatches_ = dispatches_;
+	callbacks_ = 0;
+	dispatches_ = 0;
+}
+
+void CollisionManager::Dispatch(const ContactEvent& event)
 {
-	auto* a = reinterpret_cast<GameObject*>(contact->GetFixtureA()->GetUserData().pointer);
-  	auto* b = reinterpret_cast<GameObject*>(contact->GetFixtureB()->GetUserData().pointer);
-
- 	if(a != nullptr && !a->TimeToDie())
-  	{
-  		a->PostResolve(b);
-  	}
-  
- 	if(b != nullptr && !b->TimeToDie())
-  	{
-  		b->PostResolve(a);
-  	}
+	// Tracked even for dying objects, their contacts still end when their bodies are disabled
+	if(contact_graph_ != nullptr)
+	{
+		if(event.begin)
+			contact_graph_->AddContact(event.a, event.b);
+		else
+			contact_graph_->RemoveContact(event.a, event.b);
+	}
+
+	const GameObject::ContactPhase phase = event.begin ? GameObject::ContactBegin : GameObject::ContactEnd;
+	if(Wants(event.a, phase))
+	{
+		dispatches_++;
+		if(event.begin)
+			event.a->BeginCollision(event.b);
+		else
+			event.a->EndCollision(event.b);
+	}
+
+	if(Wants(event.b, phase))
+	{
+		dispatches_++;
+		if(event.begin)
+			event.b->BeginCollision(event.a);
+		else
+			event.b->EndCollision(event.a);
+	}
 }
@@ -1,9 +1,21 @@
 ﻿#pragma once
+#include <cstdint>
+#include <vector>
 #include "box2d/b2_world_callbacks.h"
 
+class ContactGraph;
+class GameObject;
+
+// Passes box2d contact callbacks on to the game objects that subscribed to them, see GameObject::SubscribeContacts.
+// Begin and end events raised during b2World::Step are queued and dispatched together by DispatchEvents
+// once the step is over, so handlers can change the world. Ones a handler sets off join the back of the
+// queue, so a pair's end can't overtake its begin. Ones raised anywhere else, by bodies being disabled or
+// destroyed, go out straight away as their objects may not be around by the next step
 class CollisionManager : public b2ContactListener
 {
 public:
+	// Graph to keep in step with which objects are touching
+	void SetContactGraph(ContactGraph* contact_graph) { contact_graph_ = contact_graph; }
 	
 	// When entering the collision
 	void BeginContact(b2Contact* contact) override;
@@ -16,5 +28,30 @@ public:
 	
 	// After the collision is resolved by box2d
 	void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
-	
+
+	// Call after every b2World::Step
+	void DispatchEvents();
+
+	// Callbacks box2d made into the listener during the last step, and how many of them reached an object
+	int GetCallbackCount() const { return last_callbacks_; }
+	int GetDispatchCount() const { return last_dispatches_; }
+
+private:
+	struct ContactEvent
+	{
+		GameObject* a;
+		GameObject* b;
+		bool begin;
+	};
+
+	void Dispatch(const ContactEvent& event);
+
+	ContactGraph* contact_graph_ = nullptr;
+	std::vector<ContactEvent> events_;
+	bool dispatching_ = false;
+
+	int callbacks_ = 0;
+	int dispatches_ = 0;
+	int last_callbacks_ = 0;
+	int last_dispatches_ = 0;
 };
@@ -0,0 +1,126 @@
+#include "ContactGraph.h"
+
+#include <algorithm>
+
+#include "GameObject.h"
+
+namespace
+{
+	bool IsTracked(GameObject* object)
+	{
+		return object != nullptr && object->GetTag() != GameObject::Tag::None;
+	}
+}
+
+void ContactGraph::AddContact(GameObject* a, GameObject* b)
+{
+	if(!IsTracked(a) || !IsTracked(b) || a == b)
+		return;
+
+	AddEdge(a, b);
+	AddEdge(b, a);
+}
+
+void ContactGraph::RemoveContact(GameObject* a, GameObject* b)
+{
+	if(!IsTracked(a) || !IsTracked(b) || a == b)
+		return;
+
+	RemoveEdge(a, b);
+	RemoveEdge(b, a);
+}
+
+void ContactGraph::AddEdge(GameObject* from, GameObject* to)
+{
+	// A pair can touch through several contacts at once, only the first one links them
+	std::vector<Edge>& edges = edges_[from];
+	auto edge = std::find_if(edges.begin(), edges.end(), [to](const Edge& e) { return e.other == to; });
+	if(edge != edges.end())
+	{
+		edge->contacts++;
+		return;
+	}
+
+	edges.push_back({ to, 1 });
+	version_++;
+}
+
+void ContactGraph::RemoveEdge(GameObject* from, GameObject* to)
+{
+	auto it = edges_.find(from);
+	if(it == edges_.end())
+		return;
+
+	std::vector<Edge>& edges = it->second;
+	auto edge = std::find_if(edges.begin(), edges.end(), [to](const Edge& e) { return e.other == to; });
+	if(edge == edges.end() || --edge->contacts > 0)
+		return;
+
+	*edge = edges.back();
+	edges.pop_back();
+	version_++;
+}
+
+float ContactGraph::GetStackWeight(GameObject* root)
+{
+	float total_weight = 0.f;
+	open_.clear();
+	visited_.clear();
+	open_.push_back(root);
+	visited_.push_back(root);
+
+	while(!open_.empty())
+	{
+		GameObject* object = open_.back();
+		open_.pop_back();
+
+		auto it = edges_.find(object);
+		if(it == edges_.end())
+			continue;
+
+		for(const Edge& edge : it->second)
+		{
+			GameObject* other = edge.other;
+			if(other->GetTag() == GameObject::Tag::PressurePlate)
+				continue;
+			if(std::find(visited_.begin(), visited_.end(), other) != visited_.end())
+				continue;
+
+			visited_.push_back(other);
+			open_.push_back(other);
+			total_weight += other->GetWeight();
+		}
+	}
+
+	return total_weight;
+}
+
+bool ContactGraph::IsConnectedTo(GameObject* object, GameObject::Tag tag)
+{
+	open_.clear();
+	visited_.clear();
+	open_.push_back(object);
+	visited_.push_back(object);
+
+	while(!open_.empty())
+	{
+		auto it = edges_.find(open_.back());
+		open_.pop_back();
+		if(it == edges_.end())
+			continue;
+
+		for(const Edge& edge : it->second)
+		{
+			GameObject* other = edge.other;
+			if(other->GetTag() == tag)
+				return true;
+			if(std::find(visited_.begin(), visited_.end(), other) != visited_.end())
+				continue;
+
+			visited_.push_back(other);
+			open_.push_back(other);
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "GameObject.h"
+
+// Which game objects are touching which, kept up to date from contact begin/end events.
+// Static scenery (Tag::None) is left out, so what stays connected are the stacks of objects
+// resting on each other
+class ContactGraph
+{
+public:
+	void AddContact(GameObject* a, GameObject* b);
+	void RemoveContact(GameObject* a, GameObject* b);
+
+	// Bumped whenever two objects start or stop touching
+	uint32_t GetVersion() const { return version_; }
+
+	// Total weight of everything connected to root, not counting root itself.
+	// Doesn't carry on through other pressure plates
+	float GetStackWeight(GameObject* root);
+
+	// Whether object is touching something with tag, directly or through what it's touching
+	bool IsConnectedTo(GameObject* object, GameObject::Tag tag);
+
+private:
+	struct Edge
+	{
+		GameObject* other;
+		int contacts;
+	};
+
+	void AddEdge(GameObject* from, GameObject* to);
+	void RemoveEdge(GameObject* from, GameObject* to);
+
+	std::unordered_map<GameObject*, std::vector<Edge>> edges_;
+	uint32_t version_ = 0;
+
+	// Reused by GetStackWeight so it doesn't allocate once warmed up
+	std::vector<GameObject*> open_;
+	std::vector<GameObject*> visited_;
+};
@@ -0,0 +1,99 @@
+#include "CookedTexture.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <assets/png_loader.h>
+#include <system/platform.h>
+
+namespace fs = std::filesystem;
+
+std::string CookedTexture::PathFor(const std::string& png_path)
+{
+	return fs::path(png_path).replace_extension(".tex").string();
+}
+
+bool CookedTexture::GetSourceStamp(const std::string& path, uint64_t& size, int64_t& time)
+{
+	std::error_code error;
+	size = fs::file_size(path, error);
+	if(error)
+		return false;
+	const fs::file_time_type write_time = fs::last_write_time(path, error);
+	if(error)
+		return false;
+	time = (int64_t)write_time.time_since_epoch().count();
+	return true;
+}
+
+bool CookedTexture::Write(const std::string& path, const gef::ImageData& image_data, uint64_t source_size, int64_t source_time)
+{
+	if(image_data.image() == nullptr)
+		return false;
+
+	CookedTextureHeader header;
+	header.width = image_data.width();
+	header.height = image_data.height();
+	header.source_size = source_size;
+	header.source_time = source_time;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if(!file)
+		return false;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(image_data.image()), (std::streamsize)header.width * header.height * 4);
+	return (bool)file;
+}
+
+TextureImage::~TextureImage()
+{
+	// The pixels belong to the mapping when cooked
+	if(cooked_.IsOpen())
+		image_data_.set_image(nullptr);
+}
+
+bool TextureImage::Load(const char* png_path, const gef::Platform& platform)
+{
+	const std::string path = platform.FormatFilename(png_path);
+	if(LoadCooked(path))
+		return true;
+
+	gef::PNGLoader png_loader;
+	png_loader.Load(png_path, platform, image_data_);
+	return image_data_.image() != nullptr;
+}
+
+bool TextureImage::LoadCooked(const std::string& png_path)
+{
+	if(!cooked_.Open(CookedTexture::PathFor(png_path)))
+		return false;
+
+	CookedTextureHeader header;
+	bool valid = cooked_.GetSize() >= sizeof(header);
+	if(valid)
+	{
+		std::memcpy(&header, cooked_.GetData(), sizeof(header));
+		valid = header.magic == CookedTextureHeader::kMagic
+			&& header.version == CookedTextureHeader::kVersion
+			&& cooked_.GetSize() == sizeof(header) + (size_t)header.width * header.height * 4;
+	}
+
+	// Stale if the PNG has changed since, but a cooked file shipped without its PNG is still good
+	uint64_t source_size;
+	int64_t source_time;
+	if(valid && CookedTexture::GetSourceStamp(png_path, source_size, source_time))
+		valid = source_size == header.source_size && source_time == header.source_time;
+
+	if(!valid)
+	{
+		cooked_.Close();
+		return false;
+	}
+
+	// ImageData only reads through the pointer when creating a texture
+	image_data_.set_image(const_cast<uint8_t*>(cooked_.GetData() + sizeof(header)));
+	image_data_.set_width(header.width);
+	image_data_.set_height(header.height);
+	return true;
+}
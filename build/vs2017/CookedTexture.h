@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "AssetFile.h"
+#include "graphics/image_data.h"
+
+namespace gef
+{
+	class Platform;
+}
+
+// PNGs cooked into raw RGBA by cook_textures, so loading one is a map instead of an inflate.
+// foo.png cooks to foo.tex beside it, a CookedTextureHeader followed by width * height RGBA pixels
+struct CookedTextureHeader
+{
+	static constexpr uint32_t kMagic = 0x58455447; // "GTEX"
+	static constexpr uint32_t kVersion = 1;
+
+	uint32_t magic = kMagic;
+	uint32_t version = kVersion;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// Of the PNG it was cooked from, a cooked file that doesn't match is stale
+	uint64_t source_size = 0;
+	int64_t source_time = 0;
+};
+
+namespace CookedTexture
+{
+	std::string PathFor(const std::string& png_path);
+	// False if the file isn't there
+	bool GetSourceStamp(const std::string& path, uint64_t& size, int64_t& time);
+	bool Write(const std::string& path, const gef::ImageData& image_data, uint64_t source_size, int64_t source_time);
+}
+
+// Pixels to create a texture from. Taken from the cooked copy of the PNG when there's one that
+// is up to date, which is viewed in place rather than read, so keep this alive until the texture exists.
+// Falls back to decoding the PNG
+class TextureImage
+{
+public:
+	TextureImage() = default;
+	~TextureImage();
+	TextureImage(const TextureImage&) = delete;
+	TextureImage& operator=(const TextureImage&) = delete;
+
+	bool Load(const char* png_path, const gef::Platform& platform);
+
+	const gef::ImageData& GetImageData() const { return image_data_; }
+	bool IsCooked() const { return cooked_.IsOpen(); }
+
+private:
+	bool LoadCooked(const std::string& png_path);
+
+	gef::ImageData image_data_;
+	AssetFile cooked_;
+};
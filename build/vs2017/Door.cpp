@@ -1,10 +1,11 @@
 #include "Door.h"
 
-#include "audio/audio_manager.h"
-#include "graphics/renderer_3d.h"
+#include "AudioSystem.h"
+#include "RenderSnapshot.h"
 
-Door::Door(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, gef::Mesh* door_wall, gef::Mesh* door_frame, gef::Mesh* door) {
+Door::Door(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, AudioSystem* am, Scheduler* scheduler, const MeshLods* door_wall, const MeshLods* door_frame, const MeshLods* door) {
 	audio_manager_ = am;
+	scheduler_ = scheduler;
 
 	//Door is made of 2 meshes and 1 game object
 	gef::Matrix44 transform_matrix;
@@ -12,67 +13,62 @@ Door::Door(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder
 	transform_matrix.SetTranslation(pos);
 	door_wall_.set_transform(transform_matrix);
 	door_frame_.set_transform(transform_matrix);
-	door_wall_.set_mesh(door_wall);
-	door_frame_.set_mesh(door_frame);
+	door_wall_.SetMeshLods(door_wall);
+	door_frame_.SetMeshLods(door_frame);
 
 	door_ = new GameObject();
 	door_->Init(size, pos, world, builder, am);
-	door_->set_mesh(door);
+	door_->SetMeshLods(door);
 
 	closed_pos_ = pos;
 	open_pos_ = closed_pos_ - gef::Vector4(0, door_->GetSize().y() * 1.4f, 0);
 }
 
-void Door::Update(float dt) {
-	gef::Vector4 translation;
-	switch (current_state_)
-	{
-	case Door::State::OPENING: //Lerp to open position 
-		lerp_time_ += dt;
-		translation;
-		translation.Lerp(start_pos_, open_pos_, lerp_time_);
-		if ((open_pos_ - translation).LengthSqr() <= 0.01) {
-			translation = open_pos_;
-			current_state_ = State::IDLE;
-			door_->GetBody()->SetEnabled(false);
-		}
-		door_->GetBody()->SetTransform(b2Vec2(translation.x(), translation.y()), door_->GetBody()->GetAngle());
-		door_->UpdateBox2d();
-		break;
-	case Door::State::CLOSING: //Lerp to closed position
-		door_->GetBody()->SetEnabled(true); //Top of mesh will still be poking through floor so disable physics body so player can pass easily 
-		lerp_time_ += dt;
-		translation;
-		translation.Lerp(start_pos_, closed_pos_, lerp_time_);
-		if ((closed_pos_ - translation).LengthSqr() <= 0.01) {
-			translation = closed_pos_;
-			current_state_ = State::IDLE;
+Task Door::MoveTo(gef::Vector4 target) {
+	const bool opening = target.y() < closed_pos_.y();
+	const gef::Vector4 start_pos = door_->transform().GetTranslation();
+	float lerp_time = 0.f;
+	bool arrived = false;
+	while (!arrived) {
+		if (!opening) door_->GetBody()->SetEnabled(true);
+		lerp_time += co_await NextFrame();
+
+		gef::Vector4 translation;
+		translation.Lerp(start_pos, target, lerp_time < 1.f ? lerp_time : 1.f);
+		arrived = (target - translation).LengthSqr() <= 0.01;
+		if (arrived) {
+			translation = target;
+			//Top of mesh will still be poking through floor so disable physics body so player can pass easily 
+			if (opening) door_->GetBody()->SetEnabled(false);
 		}
 		door_->GetBody()->SetTransform(b2Vec2(translation.x(), translation.y()), door_->GetBody()->GetAngle());
 		door_->UpdateBox2d();
-		break;
-	case Door::State::IDLE:
-		break;
-	default:
-		break;
 	}
-
 }
 
 void Door::Open() {
-	start_pos_ = door_->transform().GetTranslation();
-	lerp_time_ = 0.f;
-	current_state_ = State::OPENING;
+	scheduler_->Cancel(move_task_);
+	move_task_ = scheduler_->Start(MoveTo(open_pos_));
 }
 
 void Door::Close() {
-	start_pos_ = door_->transform().GetTranslation();
-	lerp_time_ = 0.f;
-	current_state_ = State::CLOSING;
+	scheduler_->Cancel(move_task_);
+	move_task_ = scheduler_->Start(MoveTo(closed_pos_));
+}
+
+void Door::SaveInitialState() {
+	door_->SaveInitialState();
+}
+
+void Door::RestoreInitialState() {
+	door_->GetBody()->SetEnabled(true);
+	door_->GetBody()->SetTransform(b2Vec2(closed_pos_.x(), closed_pos_.y()), door_->GetBody()->GetAngle());
+	door_->RestoreInitialState();
+	scheduler_->Cancel(move_task_);
 }
 
-void Door::Render(gef::Renderer3D* renderer_3d) const {
-	door_->Render(renderer_3d);
-	renderer_3d->DrawMesh(door_frame_);
-	renderer_3d->DrawMesh(door_wall_);
+void Door::Render(RenderSnapshot& snapshot) const {
+	door_->Render(snapshot);
+	snapshot.DrawMesh(door_frame_, door_frame_.GetMeshLods());
+	snapshot.DrawMesh(door_wall_, door_wall_.GetMeshLods());
 }
\ No newline at end of file
@@ -1,30 +1,31 @@
 ﻿#include "Enemy.h"
 
-#include <random>
-
 #include "Bullet.h"
+#include "GravityField.h"
 #include "Player.h"
+#include "LootPool.h"
 #include <maths/math_utils.h>
 
-#include "Pickup.h"
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
+#include "RenderSnapshot.h"
 #include "system/debug_log.h"
 
 void Enemy::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world,
-				PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, const Player* player, std::vector<GameObject*>&
-				dynamic_game_objects)
+				PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, AudioSystem* am, const Player* player, LootPool* loot)
 {
 	audio_manager_ = am;
+	death_sound_ = audio_manager_->GetSound("enemy_death");
 	sprite_animator_ = sprite_animator;
 	player_ = player;
 	tag = Tag::Enemy;
+	SubscribeContacts(ContactBegin);
 	platform_ = sprite_animator->GetPlatform();
 	sprite_animator3D_ = sprite_animator;
 	set_mesh(sprite_animator3D_->GetFirstFrame("EnemyIdle"));
 
 	physics_world_ = world;
 
-	gun_.Init(gef::Vector4(size_x * 0.4f, size_y, size_z), world, sprite_animator, audio_manager_, "Enemy/Gun/gun.png");
+	gun_.Init(gef::Vector4(size_x * 0.4f, size_y, size_z), world, sprite_animator, audio_manager_, "Enemy/Gun/gun.png", "enemy_laser");
 
 	b2BodyDef body_def;
 	body_def.type = b2_dynamicBody;
@@ -39,52 +40,30 @@ void Enemy::Init(float size_x, float size_y, float size_z, float pos_x, float po
 	fixture.density = 2.f;
 	fixture.friction = 0.7f;
 	fixture.userData.pointer = reinterpret_cast<uintptr_t>(this);
+	fixture.filter = CollisionLayers::FilterFor(CollisionLayer::Enemy);
 
 	physics_body_ = world->CreateBody(&body_def);
 	physics_body_->CreateFixture(&fixture);
 	physics_body_->SetSleepingAllowed(false);
 	physics_body_->SetFixedRotation(true);
+	controller_.Init(physics_body_, move_speed_);
 
 	UpdateBox2d();
 
-	dynamic_game_objects_ = &dynamic_game_objects;
-	primitive_builder_ = builder;
-
-	//Decide if this enemy will drop loot and if so, what
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution dist(0.f, 1.f);
-	if(dist(gen) < drop_probability_)
-	{
-		auto pos = GetBody()->GetPosition();
-		pickup_ = new Pickup();
-		if(dist(gen) < 0.5f)
-		{
-			pickup_->SetType(Pickup::Type::Health);
-			pickup_->set_mesh(sprite_animator3D_->CreateMesh("Pickups/Health/health.png", gef::Vector4(0.5, 0.5, 1)));
-		}
-		else
-		{
-			pickup_->SetType(Pickup::Type::MaxAmmo);
-			pickup_->set_mesh(sprite_animator3D_->CreateMesh("Pickups/MaxAmmo/Bullet.png", gef::Vector4(0.5, 0.5, 1)));
-		}
-		pickup_->Init(0.3,0.3,0.3, pos.x, pos.y, physics_world_, primitive_builder_, am, true);
-		pickup_->SetTargetBody(GetBody());
-		dynamic_game_objects_->push_back(pickup_);
-	}
+	loot_ = loot;
 }
 
-void Enemy::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, const
-				Player* player, std::vector<GameObject*>& dynamic_game_objects)
+void Enemy::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, AudioSystem* am, const
+				Player* player, LootPool* loot)
 {
-	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, builder, sprite_animator, am, player, dynamic_game_objects);
+	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, builder, sprite_animator, am, player, loot);
 }
 
 void Enemy::Update(float frame_time)
 {
 	if (animation_state_ != DEATH) {
 
-		world_gravity_ = physics_world_->GetGravity();
+		world_gravity_ = gravity_field_ != nullptr ? gravity_field_->GravityAt(GetBody()->GetPosition()) : physics_world_->GetGravity();
 		if (world_gravity_.y > 0)
 		{
 			world_gravity_direction_ = GravityDirection::GRAVITY_UP;
@@ -116,21 +95,7 @@ void Enemy::Update(float frame_time)
 		if (!bPlayerInRange_) //If player not in range run back and forth in direction depending on gravity direction
 		{
 			animation_state_ = RUNNING;
-			switch (world_gravity_direction_)
-			{
-			case GravityDirection::GRAVITY_UP:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2((moving_left_ ? -1.f : 1.f) * move_speed_ * frame_time, 0), gef::DegToRad(180));
-				break;
-			case GravityDirection::GRAVITY_DOWN:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2((moving_left_ ? -1.f : 1.f) * move_speed_ * frame_time, 0), 0);
-				break;
-			case GravityDirection::GRAVITY_LEFT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, (moving_left_ ? 1.f : -1.f) * move_speed_ * frame_time), gef::DegToRad(-90));
-				break;
-			case GravityDirection::GRAVITY_RIGHT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, (moving_left_ ? -1.f : 1.f) * move_speed_ * frame_time), gef::DegToRad(90));
-				break;
-			}
+			controller_.Move(moving_left_ ? -1.f : 1.f);
 			gun_.SetTargetVector({ moving_left_ ? -1.f : 1.f, 0 });
 			gun_.Update(frame_time, transform().GetTranslation(), world_gravity_direction_);
 		}
@@ -138,18 +103,26 @@ void Enemy::Update(float frame_time)
 		{
 			//Stop and shoot player
 			animation_state_ = IDLE;
+			controller_.Move(0.f);
 			b2Vec2 dir = player_->GetBody()->GetPosition() - GetBody()->GetPosition();
 			gun_.SetTargetVector({ dir.x,-dir.y });
 			gun_.Update(frame_time, transform().GetTranslation(), world_gravity_direction_);
 			gun_.Fire(frame_time, GameObject::Tag::Player);
 		}
 
+		controller_.SetGravityDirection(world_gravity_direction_);
+		controller_.Step();
 		UpdateBox2d();
 
 		if (moving_left_) Rotate(gef::Vector4(0, FRAMEWORK_PI, 0));
 		else Rotate(gef::Vector4(0, 0, 0));
 
 	}
+	else
+	{
+		controller_.Move(0.f);
+		controller_.Step();
+	}
 
 	//Animation
 	anim_time_ += frame_time;
@@ -210,20 +183,20 @@ void Enemy::BeginCollision(GameObject* other)
 	}
 	else
 	{
-		Bullet* bullet = dynamic_cast<::Bullet*>(other);
+		Bullet* bullet = static_cast<::Bullet*>(other);
 		if(bullet->getTarget() == Tag::Enemy && bullet->getDamage() > 0)
 		{
 			health_ -= bullet->getDamage();
 			bullet->setDamage(0);
 			bullet->Kill();
 			
-			if(health_ <= 0 && !dead)
+			if(health_ <= 0 && !dead && animation_state_ != DEATH)
 			{
-				if(pickup_ != nullptr)
+				if(loot_ != nullptr)
 				{
-					pickup_->Activate();
+					loot_->Drop(GetBody()->GetPosition());
 				}
-				if(!audio_manager_->sample_voice_playing(5)) audio_manager_->PlaySample(5);
+				audio_manager_->PlayAt(death_sound_, gef::Vector2(GetBody()->GetPosition().x, GetBody()->GetPosition().y));
 				animation_state_ = DEATH;
 				set_mesh(sprite_animator3D_->GetFirstFrame("EnemyDeath"));
 			}
@@ -231,8 +204,22 @@ void Enemy::BeginCollision(GameObject* other)
 	}
 }
 
-void Enemy::Render(gef::Renderer3D* renderer_3d) const
+void Enemy::RestoreInitialState()
+{
+	GameObject::RestoreInitialState();
+	gun_.Reset();
+	controller_.Reset();
+
+	health_ = starting_health_;
+	moving_left_ = true;
+	bPlayerInRange_ = false;
+	world_gravity_ = b2Vec2(0, -1);
+	world_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
+	animation_state_ = RUNNING;
+}
+
+void Enemy::Render(RenderSnapshot& snapshot) const
 {
-	renderer_3d->DrawMesh(*this);
-	gun_.Render(renderer_3d);
+	snapshot.DrawMesh(*this);
+	gun_.Render(snapshot);
 }
@@ -1,36 +1,40 @@
 ﻿#pragma once
 
 #include "GameObject.h"
-#include <graphics/renderer_3d.h>
 #include "Gun.h"
-#include "Pickup.h"
+#include "CharacterController.h"
 
 class Player;
+class GravityField;
+class LootPool;
 
 class Enemy : public GameObject, public b2RayCastCallback
 {
 public:
 	void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, SpriteAnimator3D
-			* sprite_animator, gef::AudioManager* am, const Player* player, std::vector<GameObject*>& dynamic_game_objects);
-	void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, gef
-			::AudioManager* am, const Player* player, std::vector<GameObject*>& dynamic_game_objects);
+			* sprite_animator, AudioSystem* am, const Player* player, LootPool* loot);
+	void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, SpriteAnimator3D* sprite_animator, AudioSystem* am, const Player* player, LootPool* loot);
 	void Update(float frame_time);
+	void SetGravityField(const GravityField* gravity_field) { gravity_field_ = gravity_field; }
 
 	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override;
 	void InspectClosestFixture();
 
 	void BeginCollision(GameObject* other) override;
+	void RestoreInitialState() override;
 
-	void Render(gef::Renderer3D* renderer_3d) const;
+	void Render(RenderSnapshot& snapshot) const override;
 	
 protected:
-	int health_ = 10;
+	const int starting_health_ = 10;
+	int health_ = starting_health_;
 	int damage_ = 1;
 	float fire_rate_ = 1.f; // shots per second
 	float move_speed_ = 4.f;
 	bool moving_left_ = true;
 
 	b2World* physics_world_ = nullptr;
+	const GravityField* gravity_field_ = nullptr;
 	b2Vec2 world_gravity_ = b2Vec2(0, -1);
 
 	GravityDirection world_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
@@ -43,16 +47,14 @@ protected:
 	b2Fixture* closest_fixture_ = nullptr;
 
 	Gun gun_;
+	CharacterController controller_;
+	SoundHandle death_sound_;
 
-	Pickup* pickup_ = nullptr;
+	// Rolls for a drop when this dies
+	LootPool* loot_ = nullptr;
 
 	enum AnimationState { IDLE, RUNNING, DEATH };
 	AnimationState animation_state_ = RUNNING;
 
-	std::vector<GameObject*>* dynamic_game_objects_ = nullptr;
-	PrimitiveBuilder* primitive_builder_ = nullptr;
-
-	float drop_probability_ = 0.5f;
-
 	SpriteAnimator3D* sprite_animator_ = nullptr;
 };
@@ -0,0 +1,122 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+void FramePacer::SetTargetRate(float frames_per_second)
+{
+	target_rate_ = std::max(frames_per_second, 0.f);
+	period_ = target_rate_ > 0.f
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / target_rate_))
+		: Clock::duration::zero();
+	// Restart the schedule from the next frame
+	started_ = false;
+}
+
+void FramePacer::SetSmoothing(int frames)
+{
+	smoothing_ = std::clamp(frames, 1, kMaxSmoothing);
+	recent_count_ = 0;
+	recent_next_ = 0;
+}
+
+float FramePacer::BeginFrame()
+{
+	float late_ms = 0.f;
+	if (started_ && period_ > Clock::duration::zero())
+	{
+		deadline_ += period_;
+		const Clock::time_point now = Clock::now();
+		if (now < deadline_)
+		{
+			WaitUntil(deadline_);
+		}
+		else
+		{
+			const Clock::duration late = now - deadline_;
+			late_ms = std::chrono::duration<float, std::milli>(late).count();
+			if (late_ms > kLateToleranceMs)
+				stats_.missed_deadlines++;
+			if (late >= period_)
+			{
+				stats_.dropped_frames += late / period_;
+				deadline_ = now;
+			}
+		}
+	}
+
+	const Clock::time_point start = Clock::now();
+	if (!started_)
+	{
+		started_ = true;
+		deadline_ = start;
+		last_start_ = start;
+		return target_rate_ > 0.f ? 1.f / target_rate_ : 1.f / 60.f;
+	}
+
+	const float delta = std::chrono::duration<float>(start - last_start_).count();
+	last_start_ = start;
+	UpdateStats(delta * 1000.f, late_ms);
+
+	recent_deltas_[recent_next_] = std::min(delta, kMaxDelta);
+	recent_next_ = (recent_next_ + 1) % smoothing_;
+	recent_count_ = std::min(recent_count_ + 1, smoothing_);
+	float total = 0.f;
+	for (int i = 0; i < recent_count_; i++)
+		total += recent_deltas_[i];
+	return total / recent_count_;
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline)
+{
+	using Ms = std::chrono::duration<double, std::milli>;
+
+	// Sleep while even a slow sleep would wake up in time
+	for (;;)
+	{
+		const double remaining_ms = Ms(deadline - Clock::now()).count();
+		const double sleep_stddev = sleep_count_ > 1 ? std::sqrt(sleep_m2_ / (sleep_count_ - 1)) : 0.0;
+		if (remaining_ms <= sleep_mean_ms_ + 2.0 * sleep_stddev)
+			break;
+
+		const Clock::time_point before = Clock::now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		const double slept_ms = Ms(Clock::now() - before).count();
+
+		// Welford's running mean and variance
+		sleep_count_++;
+		const double difference = slept_ms - sleep_mean_ms_;
+		sleep_mean_ms_ += difference / sleep_count_;
+		sleep_m2_ += difference * (slept_ms - sleep_mean_ms_);
+	}
+
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::UpdateStats(float delta_ms, float late_ms)
+{
+	stats_.frames++;
+	stats_.last_late_ms = late_ms;
+
+	history_ms_[history_next_] = delta_ms;
+	history_next_ = (history_next_ + 1) % kHistory;
+	history_count_ = std::min(history_count_ + 1, kHistory);
+
+	double total = 0.0;
+	float max_ms = 0.f;
+	for (int i = 0; i < history_count_; i++)
+	{
+		total += history_ms_[i];
+		max_ms = std::max(max_ms, history_ms_[i]);
+	}
+	const double mean = total / history_count_;
+	double squares = 0.0;
+	for (int i = 0; i < history_count_; i++)
+		squares += (history_ms_[i] - mean) * (history_ms_[i] - mean);
+
+	stats_.mean_ms = (float)mean;
+	stats_.jitter_ms = (float)std::sqrt(squares / history_count_);
+	stats_.max_ms = max_ms;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Starts frames at a steady rate and hands the game a delta time that doesn't jump about with OS
+// timer jitter. Waiting sleeps while there's plenty of time left and spins for the last stretch,
+// with how long a sleep really takes learnt as it goes. A frame starting more than a whole period
+// late counts the frames it skipped as dropped, and the schedule starts again from it rather than
+// rushing to catch up
+class FramePacer
+{
+public:
+	static constexpr int kHistory = 240;
+
+	struct Stats
+	{
+		int64_t frames = 0;
+		// Frames that started later than kLateTolerance after their deadline
+		int64_t missed_deadlines = 0;
+		// Periods skipped over entirely by frames running long
+		int64_t dropped_frames = 0;
+		// Over the last kHistory frames, of the time between frame starts
+		float mean_ms = 0.f;
+		float jitter_ms = 0.f;
+		float max_ms = 0.f;
+		// How far past its deadline the last frame started
+		float last_late_ms = 0.f;
+	};
+
+	// Frames a second to start frames at, 0 to leave it to vsync and only measure
+	void SetTargetRate(float frames_per_second);
+	float GetTargetRate() const { return target_rate_; }
+	// Frames the delta time is averaged over, 1 for none
+	void SetSmoothing(int frames);
+
+	// Call first thing each frame. Waits for the frame's start time and returns the smoothed
+	// seconds since the last one, capped so a hitch can't ask for one huge step
+	float BeginFrame();
+
+	const Stats& GetStats() const { return stats_; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void WaitUntil(Clock::time_point deadline);
+	void UpdateStats(float delta_ms, float late_ms);
+
+	static constexpr float kMaxDelta = 0.1f;
+	static constexpr float kLateToleranceMs = 1.f;
+	static constexpr int kMaxSmoothing = 16;
+
+	float target_rate_ = 0.f;
+	Clock::duration period_ = Clock::duration::zero();
+	Clock::time_point deadline_;
+	Clock::time_point last_start_;
+	bool started_ = false;
+
+	// What asking for a 1 ms sleep costs, mean and spread, so the spin takes over in time
+	double sleep_mean_ms_ = 1.5;
+	double sleep_m2_ = 0.0;
+	int64_t sleep_count_ = 0;
+
+	float recent_deltas_[kMaxSmoothing] = {};
+	int smoothing_ = 4;
+	int recent_count_ = 0;
+	int recent_next_ = 0;
+
+	float history_ms_[kHistory] = {};
+	int history_count_ = 0;
+	int history_next_ = 0;
+	Stats stats_;
+};
@@ -0,0 +1,97 @@
+#include "FramePipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Profiler.h"
+
+FramePipeline::FramePipeline(std::function<void()> simulate)
+	: simulate_(std::move(simulate))
+{
+	worker_ = std::thread(&FramePipeline::WorkerLoop, this);
+}
+
+FramePipeline::~FramePipeline()
+{
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	wake_.notify_all();
+	worker_.join();
+}
+
+void FramePipeline::Start()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		started_ = true;
+		running_ = true;
+	}
+	wake_.notify_one();
+}
+
+void FramePipeline::Run()
+{
+	const int64_t start_us = Profiler::NowMicroseconds();
+	simulate_();
+	const int64_t end_us = Profiler::NowMicroseconds();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	started_ = true;
+	simulate_start_us_ = start_us;
+	simulate_end_us_ = end_us;
+}
+
+void FramePipeline::Wait()
+{
+	PROFILE_ZONE("FramePipeline::Wait");
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_.wait(lock, [this] { return !running_; });
+	if(!started_)
+		return;
+	started_ = false;
+
+	// The render in between went alongside it, or came after it for a frame that was Run
+	simulate_us_ = simulate_end_us_ - simulate_start_us_;
+	render_us_ = render_end_us_ - render_start_us_;
+	const int64_t overlap_start = std::max(simulate_start_us_, render_start_us_);
+	const int64_t overlap_end = std::min(simulate_end_us_, render_end_us_);
+	overlap_us_ = std::max<int64_t>(0, overlap_end - overlap_start);
+}
+
+void FramePipeline::BeginRender()
+{
+	render_start_us_ = Profiler::NowMicroseconds();
+}
+
+void FramePipeline::EndRender()
+{
+	render_end_us_ = Profiler::NowMicroseconds();
+}
+
+void FramePipeline::WorkerLoop()
+{
+	Profiler::SetThreadName("Simulation");
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(true)
+	{
+		wake_.wait(lock, [this] { return stopping_ || running_; });
+		if(stopping_)
+			break;
+
+		lock.unlock();
+		const int64_t start_us = Profiler::NowMicroseconds();
+		simulate_();
+		const int64_t end_us = Profiler::NowMicroseconds();
+		lock.lock();
+
+		simulate_start_us_ = start_us;
+		simulate_end_us_ = end_us;
+		running_ = false;
+		done_.notify_all();
+	}
+}
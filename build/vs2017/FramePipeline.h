@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "RenderSnapshot.h"
+
+// Simulates a frame on a thread of its own while the main thread renders the snapshot the
+// frame before it left. The simulation writes the back snapshot and Publish makes it the front
+// one, which is only ever read between a Wait and the next Start.
+// Game state belongs to the simulation from Start until Wait returns
+class FramePipeline
+{
+public:
+	explicit FramePipeline(std::function<void()> simulate);
+	~FramePipeline();
+	FramePipeline(const FramePipeline&) = delete;
+	FramePipeline& operator=(const FramePipeline&) = delete;
+
+	// Runs simulate on the worker, every Start needs a Wait before the next one
+	void Start();
+	// Runs simulate on the calling thread, for frames that have to render what the simulation left live
+	void Run();
+	// Returns once the simulation started last has finished, or straight away if none is running
+	void Wait();
+
+	RenderSnapshot& GetBackSnapshot() { return snapshots_[back_]; }
+	const RenderSnapshot& GetFrontSnapshot() const { return snapshots_[1 - back_]; }
+	void Publish() { back_ = 1 - back_; }
+
+	// Around the render, to measure how much of it ran alongside the simulation
+	void BeginRender();
+	void EndRender();
+
+	// Of the last frame, the overlap is 0 when it simulated and rendered one after the other
+	float GetSimulateMs() const { return simulate_us_ / 1000.f; }
+	float GetRenderMs() const { return render_us_ / 1000.f; }
+	float GetOverlapMs() const { return overlap_us_ / 1000.f; }
+
+private:
+	void WorkerLoop();
+
+	std::function<void()> simulate_;
+	RenderSnapshot snapshots_[2];
+	int back_ = 0;
+
+	int64_t render_start_us_ = 0;
+	int64_t render_end_us_ = 0;
+	int64_t simulate_us_ = 0;
+	int64_t render_us_ = 0;
+	int64_t overlap_us_ = 0;
+
+	// Guards everything below, shared with the worker
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	bool started_ = false;
+	bool running_ = false;
+	bool stopping_ = false;
+	int64_t simulate_start_us_ = 0;
+	int64_t simulate_end_us_ = 0;
+
+	std::thread worker_;
+};
@@ -1,10 +1,9 @@
 #include "GameObject.h"
 #include "primitive_builder.h"
-#include "graphics/renderer_3d.h"
+#include "RenderSnapshot.h"
 #include "system/debug_log.h"
 
-void GameObject::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, gef::
-					AudioManager* am, bool dynamic) {
+void GameObject::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, AudioSystem* am, bool dynamic) {
 
 	audio_manager_ = am;
 	
@@ -24,6 +23,7 @@ void GameObject::Init(float size_x, float size_y, float size_z, float pos_x, flo
 	fixture.density = 1.f;
 	fixture.friction = 0.7f;
 	fixture.userData.pointer = reinterpret_cast<uintptr_t>(this);
+	fixture.filter = CollisionLayers::FilterFor(dynamic ? CollisionLayer::Crate : CollisionLayer::Static);
 
 	physics_body_ = world->CreateBody(&body_def);
 	physics_body_->CreateFixture(&fixture);
@@ -31,7 +31,7 @@ void GameObject::Init(float size_x, float size_y, float size_z, float pos_x, flo
 	UpdateBox2d();
 }
 
-void GameObject::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic) {
+void GameObject::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, AudioSystem* am, bool dynamic) {
 	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, builder, am, dynamic);
 }
 
@@ -39,9 +39,15 @@ void GameObject::Update(float frame_time) {
 	UpdateBox2d();
 }
 
-void GameObject::Render(gef::Renderer3D* renderer_3d) const
+void GameObject::Render(RenderSnapshot& snapshot) const
 {
-	renderer_3d->DrawMesh(*this);
+	snapshot.DrawMesh(*this, mesh_lods_);
+}
+
+void GameObject::SetMeshLods(const MeshLods* lods)
+{
+	mesh_lods_ = lods;
+	set_mesh(lods != nullptr ? lods->meshes[0] : nullptr);
 }
 
 void GameObject::BeginCollision(GameObject* other)
@@ -61,6 +67,15 @@ void GameObject::PostResolve(GameObject* other)
 {
 }
 
+void GameObject::SetCollisionLayer(CollisionLayer layer)
+{
+	const b2Filter filter = CollisionLayers::FilterFor(layer);
+	for(b2Fixture* fixture = physics_body_->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+	{
+		fixture->SetFilterData(filter);
+	}
+}
+
 void GameObject::EnableCollisionResolution(bool enable)
 {
 	b2Fixture* fixture = physics_body_->GetFixtureList();
@@ -91,6 +106,48 @@ bool GameObject::TimeToDie()
 	return dead;
 }
 
+void GameObject::SetFrozen(bool frozen)
+{
+	if(frozen == frozen_)
+		return;
+
+	frozen_ = frozen;
+	if(physics_body_ == nullptr)
+		return;
+
+	if(frozen)
+	{
+		enabled_before_freeze_ = physics_body_->IsEnabled();
+		physics_body_->SetEnabled(false);
+	}
+	else if(enabled_before_freeze_)
+	{
+		physics_body_->SetEnabled(true);
+		// Gravity may have changed while it was away
+		physics_body_->SetAwake(true);
+	}
+}
+
+void GameObject::SaveInitialState()
+{
+	initial_mesh_ = mesh_;
+	initial_translate_ = translate_;
+	initial_rotate_ = rotate_;
+}
+
+void GameObject::RestoreInitialState()
+{
+	dead = false;
+	anim_time_ = 0;
+	set_mesh(initial_mesh_);
+	translate_ = initial_translate_;
+	rotate_ = initial_rotate_;
+	if(physics_body_ != nullptr)
+	{
+		UpdateBox2d();
+	}
+}
+
 void GameObject::UpdateBox2d() {
 	gef::Matrix44 transform;
 	transform.SetIdentity();
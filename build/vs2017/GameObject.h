@@ -1,10 +1,16 @@
 #pragma once
+#include <cstdint>
 #include "graphics/mesh_instance.h"
 #include "maths/vector4.h"
 #include <box2d/box2d.h>
 #include "primitive_builder.h"
 #include "maths/vector2.h"
 #include "SpriteAnimator3D.h"
+#include "CollisionLayers.h"
+#include "MeshLod.h"
+
+class AudioSystem;
+class RenderSnapshot;
 
 enum class GravityDirection { GRAVITY_UP, GRAVITY_DOWN, GRAVITY_LEFT, GRAVITY_RIGHT };
 
@@ -24,18 +30,31 @@ public:
 		WinObject,
 		NextObject
 	};
+
+	// Contact callbacks CollisionManager passes on, an object only gets the ones it subscribes to
+	enum ContactPhase : uint8_t
+	{
+		ContactBegin = 1 << 0,
+		ContactEnd = 1 << 1,
+		ContactPreSolve = 1 << 2,
+		ContactPostSolve = 1 << 3,
+	};
 	
-	virtual void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic = false);
-	virtual void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic = false);
+	virtual void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, AudioSystem* am, bool dynamic = false);
+	virtual void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, AudioSystem* am, bool dynamic = false);
 	void UpdateBox2d();
 	void Translate(gef::Vector4 translation) { translate_ = translation; };
 	void Rotate(gef::Vector4 rotation) { rotate_ = rotation; };
 	virtual void Update(float frame_time);
-	virtual void Render(gef::Renderer3D* renderer_3d) const;
+	virtual void Render(RenderSnapshot& snapshot) const;
 	virtual void BeginCollision(GameObject* other);
 	virtual void EndCollision(GameObject* other);
 	virtual void PreResolve(GameObject* other);
 	virtual void PostResolve(GameObject* other);
+	void SubscribeContacts(uint8_t phases) { contact_phases_ |= phases; }
+	bool WantsContacts(ContactPhase phase) const { return (contact_phases_ & phase) != 0; }
+	// Bodies are created on the layer for their type, this moves one that turns out to be something else
+	void SetCollisionLayer(CollisionLayer layer);
 	void EnableCollisionResolution(bool enable);
 	b2Body* GetBody() { return physics_body_; }
 	const b2Body* GetBody() const { return physics_body_; }
@@ -43,12 +62,24 @@ public:
 	void SetTag(Tag tag);
 	const gef::Vector4 GetSize() const { return size_; }
 
+	// For objects whose mesh never changes, draws the level that suits their size on screen
+	void SetMeshLods(const MeshLods* lods);
+
 	void Kill();
 	bool TimeToDie();
 
 	float GetWeight() const { return weight_; }
 	void SetWeight(float weight) { weight_ = weight; }
 
+	// Takes the object's body out of the world while it's far from the player, see ChunkStreamer.
+	// Position and velocity are kept, and bodies the game had already switched off stay off
+	void SetFrozen(bool frozen);
+	bool IsFrozen() const { return frozen_; }
+
+	// Used by Level to restart in place without reloading
+	virtual void SaveInitialState();
+	virtual void RestoreInitialState();
+
 protected:
 	b2Body* physics_body_ = nullptr;
 	Tag tag = Tag::None;
@@ -59,6 +90,15 @@ protected:
 	SpriteAnimator3D* sprite_animator3D_;
 	float anim_time_ = 0;
 	float weight_ = 1; //For pressure plates
-	gef::AudioManager* audio_manager_ = nullptr;
+	bool frozen_ = false;
+	bool enabled_before_freeze_ = false;
+	uint8_t contact_phases_ = 0;
+	AudioSystem* audio_manager_ = nullptr;
+	const MeshLods* mesh_lods_ = nullptr;
+
+	//Initial state
+	const gef::Mesh* initial_mesh_ = nullptr;
+	gef::Vector4 initial_translate_ = gef::Vector4(0, 0, 0);
+	gef::Vector4 initial_rotate_ = gef::Vector4(0, 0, 0);
 };
 
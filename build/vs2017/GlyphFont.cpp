@@ -0,0 +1,125 @@
+#include "GlyphFont.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "AssetFile.h"
+#include "SpriteAnimator3D.h"
+#include "graphics/texture.h"
+#include "system/debug_log.h"
+
+namespace
+{
+	// Value of key=value on a .fnt line, or 0 if it isn't there
+	float FieldValue(const std::string& line, const char* key)
+	{
+		const std::string pattern = std::string(" ") + key + "=";
+		const size_t found = line.find(pattern);
+		if(found == std::string::npos)
+			return 0.f;
+		return (float)std::atof(line.c_str() + found + pattern.size());
+	}
+}
+
+std::map<std::string, std::weak_ptr<gef::Texture>> GlyphFont::textures_;
+std::mutex GlyphFont::textures_mutex_;
+
+bool GlyphFont::Load(const char* font_name, gef::Platform& platform)
+{
+	AssetFile file;
+	if(!file.Open(std::string(font_name) + ".fnt"))
+	{
+		gef::DebugOut((std::string(font_name) + ".fnt not found\n").c_str());
+		return false;
+	}
+
+	std::string line;
+	for(const char* start = file.begin(); start < file.end();)
+	{
+		const char* line_end = std::find(start, file.end(), '\n');
+		line.assign(start, line_end);
+		start = line_end == file.end() ? line_end : line_end + 1;
+
+		if(line.rfind("common ", 0) == 0)
+		{
+			texture_width_ = FieldValue(line, "scaleW");
+			texture_height_ = FieldValue(line, "scaleH");
+		}
+		else if(line.rfind("char ", 0) == 0)
+		{
+			const int id = (int)FieldValue(line, "id");
+			if(id < 0 || id > 255)
+				continue;
+
+			Glyph& glyph = glyphs_[id];
+			glyph.x = FieldValue(line, "x");
+			glyph.y = FieldValue(line, "y");
+			glyph.width = FieldValue(line, "width");
+			glyph.height = FieldValue(line, "height");
+			glyph.x_offset = FieldValue(line, "xoffset");
+			glyph.y_offset = FieldValue(line, "yoffset");
+			glyph.x_advance = FieldValue(line, "xadvance");
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(textures_mutex_);
+		texture_ = textures_[font_name].lock();
+	}
+	if(texture_ == nullptr)
+	{
+		// Not under the lock, from a load the upload waits on the main thread
+		std::shared_ptr<gef::Texture> texture(SpriteAnimator3D::CreateTexture((std::string(font_name) + "_0.png").c_str(), &platform));
+		std::lock_guard<std::mutex> lock(textures_mutex_);
+		std::weak_ptr<gef::Texture>& shared = textures_[font_name];
+		texture_ = shared.lock();
+		if(texture_ == nullptr)
+		{
+			texture_ = texture;
+			shared = texture;
+		}
+	}
+	return texture_ != nullptr && texture_width_ > 0.f && texture_height_ > 0.f;
+}
+
+float GlyphFont::GetStringLength(const char* text) const
+{
+	float length = 0.f;
+	for(const char* c = text; *c != '\0'; c++)
+	{
+		length += glyphs_[(unsigned char)*c].x_advance;
+	}
+	return length;
+}
+
+void GlyphFont::Layout(const char* text, const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, std::vector<gef::Sprite>& quads) const
+{
+	quads.clear();
+
+	float cursor_x = position.x();
+	if(justification == gef::TJ_CENTRE)
+		cursor_x -= GetStringLength(text) * scale * 0.5f;
+	else if(justification == gef::TJ_RIGHT)
+		cursor_x -= GetStringLength(text) * scale;
+
+	for(const char* c = text; *c != '\0'; c++)
+	{
+		const Glyph& glyph = glyphs_[(unsigned char)*c];
+		if(glyph.width > 0.f && glyph.height > 0.f)
+		{
+			// Sprites are positioned by their centre
+			gef::Sprite quad;
+			quad.set_position(gef::Vector4(cursor_x + (glyph.x_offset + glyph.width * 0.5f) * scale, position.y() + (glyph.y_offset + glyph.height * 0.5f) * scale, position.z()));
+			quad.set_width(glyph.width * scale);
+			quad.set_height(glyph.height * scale);
+			quad.set_uv_position(gef::Vector2(glyph.x / texture_width_, glyph.y / texture_height_));
+			quad.set_uv_width(glyph.width / texture_width_);
+			quad.set_uv_height(glyph.height / texture_height_);
+			quad.set_texture(texture_.get());
+			quad.set_colour(colour);
+			quads.push_back(quad);
+		}
+		cursor_x += glyph.x_advance * scale;
+	}
+}
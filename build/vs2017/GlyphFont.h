@@ -0,0 +1,46 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "graphics/font.h"
+#include "graphics/sprite.h"
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+}
+
+// Glyph metrics from a BMFont .fnt file, the same files gef::Font reads.
+// Lays text out into sprite quads up front so retained HUD text doesn't go back
+// through gef::Font::RenderText every frame. Fonts loaded by the same name share one texture
+class GlyphFont
+{
+public:
+	bool Load(const char* font_name, gef::Platform& platform);
+
+	// Replaces quads with one sprite per visible glyph of text, placed the way gef::Font::RenderText would
+	void Layout(const char* text, const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, std::vector<gef::Sprite>& quads) const;
+	float GetStringLength(const char* text) const;
+
+private:
+	struct Glyph
+	{
+		float x = 0.f, y = 0.f;
+		float width = 0.f, height = 0.f;
+		float x_offset = 0.f, y_offset = 0.f;
+		float x_advance = 0.f;
+	};
+
+	Glyph glyphs_[256];
+	float texture_width_ = 1.f;
+	float texture_height_ = 1.f;
+	std::shared_ptr<gef::Texture> texture_;
+
+	// Textures of fonts still loaded by someone, levels load theirs on the loader thread
+	static std::map<std::string, std::weak_ptr<gef::Texture>> textures_;
+	static std::mutex textures_mutex_;
+};
@@ -0,0 +1,138 @@
+#include "GravityField.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+void GravityField::Init(b2World* world)
+{
+	world_ = world;
+	global_ = world->GetGravity();
+}
+
+void GravityField::SetGlobal(const b2Vec2& gravity)
+{
+	if (gravity == global_)
+		return;
+
+	global_ = gravity;
+	world_->SetGravity(gravity);
+
+	// Disabled bodies are woken too, otherwise they'd be left hanging when the chunk streamer
+	// brings them back. It costs nothing until then
+	for (b2Body* body = world_->GetBodyList(); body != nullptr; body = body->GetNext())
+	{
+		if (!IsPulled(body) || body->IsAwake() || ZoneAt(body->GetPosition()) >= 0)
+			continue;
+		body->SetAwake(true);
+		wake_count_++;
+	}
+}
+
+int GravityField::AddZone(const b2AABB& bounds, const b2Vec2& gravity)
+{
+	zones_.push_back({ bounds, gravity, gravity });
+	return (int)zones_.size() - 1;
+}
+
+void GravityField::SetZoneGravity(int zone, const b2Vec2& gravity)
+{
+	if (zones_[zone].gravity == gravity)
+		return;
+
+	zones_[zone].gravity = gravity;
+	for (b2Body* body = world_->GetBodyList(); body != nullptr; body = body->GetNext())
+	{
+		if (!IsPulled(body) || body->IsAwake() || ZoneAt(body->GetPosition()) != zone)
+			continue;
+		body->SetAwake(true);
+		wake_count_++;
+	}
+}
+
+b2Vec2 GravityField::GravityAt(const b2Vec2& point) const
+{
+	const int zone = ZoneAt(point);
+	return zone >= 0 ? zones_[zone].gravity : global_;
+}
+
+void GravityField::ApplyImpulse(const b2Vec2& impulse)
+{
+	for (b2Body* body = world_->GetBodyList(); body != nullptr; body = body->GetNext())
+	{
+		if (!IsPulled(body) || !body->IsEnabled() || ZoneAt(body->GetPosition()) >= 0)
+			continue;
+		body->ApplyLinearImpulseToCenter(impulse, true);
+	}
+}
+
+void GravityField::Apply()
+{
+	if (zones_.empty())
+		return;
+
+	PROFILE_ZONE("GravityField::Apply");
+
+	// The world already pulls with global gravity, so a zone adds the difference.
+	// Only bodies inside a zone are looked at, and sleeping ones are left to sleep
+	struct BodyCollector : public b2QueryCallback
+	{
+		std::vector<b2Body*>* bodies;
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			b2Body* body = fixture->GetBody();
+			if (body->IsAwake() && IsPulled(body))
+				bodies->push_back(body);
+			return true;
+		}
+	};
+
+	zone_bodies_.clear();
+	BodyCollector collector;
+	collector.bodies = &zone_bodies_;
+	for (const Zone& zone : zones_)
+		world_->QueryAABB(&collector, zone.bounds);
+	std::sort(zone_bodies_.begin(), zone_bodies_.end());
+	zone_bodies_.erase(std::unique(zone_bodies_.begin(), zone_bodies_.end()), zone_bodies_.end());
+
+	for (b2Body* body : zone_bodies_)
+	{
+		const int zone = ZoneAt(body->GetPosition());
+		if (zone < 0)
+			continue;
+		const b2Vec2 difference = zones_[zone].gravity - global_;
+		body->ApplyForceToCenter(body->GetMass() * body->GetGravityScale() * difference, false);
+	}
+}
+
+void GravityField::Reset(const b2Vec2& global)
+{
+	global_ = global;
+	world_->SetGravity(global);
+	for (Zone& zone : zones_)
+		zone.gravity = zone.initial_gravity;
+	wake_count_ = 0;
+}
+
+void GravityField::Clear()
+{
+	zones_.clear();
+	zone_bodies_.clear();
+	wake_count_ = 0;
+}
+
+int GravityField::ZoneAt(const b2Vec2& point) const
+{
+	for (size_t i = 0; i < zones_.size(); i++)
+	{
+		const b2AABB& bounds = zones_[i].bounds;
+		if (point.x >= bounds.lowerBound.x && point.x <= bounds.upperBound.x && point.y >= bounds.lowerBound.y && point.y <= bounds.upperBound.y)
+			return (int)i;
+	}
+	return -1;
+}
+
+bool GravityField::IsPulled(const b2Body* body)
+{
+	return body->GetType() == b2_dynamicBody && body->GetGravityScale() != 0.f;
+}
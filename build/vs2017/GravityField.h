@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <box2d/box2d.h>
+
+// Where gravity pulls in a level: one global gravity, set on the world, and zones that pull their own
+// way on bodies whose centre is inside them. A change only wakes the bodies it pulls on differently,
+// and box2d brings along anything resting on them, so everything else stays asleep and what was woken
+// settles back to sleep once it stops
+class GravityField
+{
+public:
+	void Init(b2World* world);
+
+	// Gravity everywhere outside a zone
+	void SetGlobal(const b2Vec2& gravity);
+	const b2Vec2& GetGlobal() const { return global_; }
+
+	// Zones listed first win where they overlap. Returns the zone's index
+	int AddZone(const b2AABB& bounds, const b2Vec2& gravity);
+	void SetZoneGravity(int zone, const b2Vec2& gravity);
+	int GetZoneCount() const { return (int)zones_.size(); }
+
+	// What pulls on something at point
+	b2Vec2 GravityAt(const b2Vec2& point) const;
+
+	// Pushes every body global gravity pulls on
+	void ApplyImpulse(const b2Vec2& impulse);
+
+	// Call before every b2World::Step, zone gravity goes on as a force
+	void Apply();
+
+	// Back to how it was loaded without waking anything, for restarts. The bodies are put back separately
+	void Reset(const b2Vec2& global);
+	void Clear();
+
+	// Bodies woken by gravity changes since the level started
+	int GetWakeCount() const { return wake_count_; }
+
+private:
+	struct Zone
+	{
+		b2AABB bounds;
+		b2Vec2 gravity;
+		b2Vec2 initial_gravity;
+	};
+
+	int ZoneAt(const b2Vec2& point) const;
+	// Bodies gravity pulls on at all
+	static bool IsPulled(const b2Body* body);
+
+	b2World* world_ = nullptr;
+	b2Vec2 global_ = b2Vec2(0, 0);
+	std::vector<Zone> zones_;
+	std::vector<b2Body*> zone_bodies_;
+	int wake_count_ = 0;
+};
@@ -6,14 +6,15 @@
 #include <maths/math_utils.h>
 #include "SpriteAnimator3D.h"
 #include <cmath>
-#include <thread>
 #include <system/debug_log.h>
 
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
+#include "RenderSnapshot.h"
 
-void Gun::Init(gef::Vector4 size, b2World* world, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, const char* filename)
+void Gun::Init(gef::Vector4 size, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, const char* filename, const char* fire_sound)
 {
 	am_ = am;
+	fire_sound_ = am_->GetSound(fire_sound);
 	set_mesh(sprite_animator->CreateMesh(filename, size));
 	getBulletManager()->Init(world, sprite_animator->GetPrimitiveBuilder(), am_);
 }
@@ -93,7 +94,7 @@ void Gun::Fire(float dt, GameObject::Tag target) {
 			bullet_manager_.Fire(target_vector_, pos, damage_, target, 40.f);
 			if(target == GameObject::Tag::Player)
 			{
-				am_->PlaySample(3, false);
+				am_->PlayAt(fire_sound_, pos);
 			}
 			fire_time_ = 0;
 			decreaseLoaded();
@@ -102,10 +103,17 @@ void Gun::Fire(float dt, GameObject::Tag target) {
 	}
 }
 
-void Gun::Render(gef::Renderer3D* renderer_3d) const
+void Gun::Render(RenderSnapshot& snapshot) const
 {
-	renderer_3d->DrawMesh(*this);
-	getBulletManager()->Render(renderer_3d);
+	snapshot.DrawMesh(*this);
+	getBulletManager()->Render(snapshot);
+}
+
+void Gun::Reset()
+{
+	fire_time_ = 0;
+	reloading_ = false;
+	bullet_manager_.Clear();
 }
 
 Gun::~Gun()
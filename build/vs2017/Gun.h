@@ -1,6 +1,8 @@
 #pragma once
+#include <climits>
 #include "graphics/mesh_instance.h"
 #include <system/platform.h>
+#include "AudioSystem.h"
 #include "BulletManager.h"
 
 class InputActionManager;
@@ -8,16 +10,17 @@ enum class GravityDirection;
 
 class Gun : public gef::MeshInstance {
 public:
-	void Init(gef::Vector4 size, b2World* world, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, const char* filename);
+	void Init(gef::Vector4 size, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, const char* filename, const char* fire_sound);
 	void Update(float frame_time, gef::Vector4 translation, GravityDirection grav_dir);
 	void Fire(float dt, GameObject::Tag target);
 	virtual void Reload(bool* reloading) {};
+	virtual void Reset();
 	void SetTargetVector(gef::Vector2 vec) { target_vector_ = vec; target_vector_.Normalise(); }
 	void SetDamage(int dam) { damage_ = dam; }
 	void SetFireRate(int rate) { fire_rate_ = rate; }
 	const BulletManager* getBulletManager() const { return &bullet_manager_; }
 	BulletManager* getBulletManager() { return &bullet_manager_; }
-	void Render(gef::Renderer3D* renderer_3d) const;
+	void Render(RenderSnapshot& snapshot) const;
 	virtual int* loaded() { return &ammo_loaded_; }
 	~Gun();
 
@@ -32,7 +35,8 @@ protected:
 	bool reloading_ = false;
 
 	BulletManager bullet_manager_;
-	gef::AudioManager* am_;
+	AudioSystem* am_ = nullptr;
+	SoundHandle fire_sound_;
 private:
 
 	int ammo_reserve_ = INT_MAX; //Default (enemies) have infinite ammo
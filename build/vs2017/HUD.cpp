@@ -0,0 +1,103 @@
+#include "HUD.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "RenderSnapshot.h"
+#include "SpriteAnimator3D.h"
+#include "graphics/texture.h"
+#include "system/platform.h"
+
+namespace
+{
+	// Most HUD strings fit in this without the element ever reallocating
+	constexpr size_t kTextReserve = 64;
+	constexpr size_t kQuadReserve = 64;
+}
+
+HUDString& HUDString::operator<<(const char* text)
+{
+	const size_t space = kCapacity - 1 - length_;
+	const size_t count = std::min(std::strlen(text), space);
+	std::memcpy(buffer_ + length_, text, count);
+	length_ += count;
+	buffer_[length_] = '\0';
+	return *this;
+}
+
+HUDString& HUDString::operator<<(int value)
+{
+	const std::to_chars_result result = std::to_chars(buffer_ + length_, buffer_ + kCapacity - 1, value);
+	if(result.ec == std::errc())
+	{
+		length_ = result.ptr - buffer_;
+		buffer_[length_] = '\0';
+	}
+	return *this;
+}
+
+HUD::~HUD()
+{
+	delete icon_texture_;
+}
+
+bool HUD::Init(gef::Platform& platform, const char* font_name)
+{
+	platform_ = &platform;
+	return font_.Load(font_name, platform);
+}
+
+int HUD::AddText(const gef::Vector2& anchor)
+{
+	TextElement element;
+	element.position = gef::Vector4(platform_->width() * anchor.x, platform_->height() * anchor.y, -0.9f);
+	element.text.reserve(kTextReserve);
+	element.quads.reserve(kQuadReserve);
+	texts_.push_back(std::move(element));
+	return (int)texts_.size() - 1;
+}
+
+void HUD::SetText(int index, const char* text)
+{
+	TextElement& element = texts_[index];
+	if(element.text == text)
+		return;
+
+	element.text = text;
+	font_.Layout(text, element.position, 1.f, 0xffffffff, gef::TJ_CENTRE, element.quads);
+}
+
+void HUD::SetIcons(const char* filepath, const gef::Vector2& anchor, float size, float spacing, int count)
+{
+	// One texture shared by every icon
+	delete icon_texture_;
+	icon_texture_ = SpriteAnimator3D::CreateTexture(filepath, platform_);
+
+	icons_.clear();
+	for(int i = 0; i < count; i++)
+	{
+		gef::Sprite icon;
+		icon.set_texture(icon_texture_);
+		icon.set_width(size);
+		icon.set_height(size);
+		icon.set_position(platform_->width() * anchor.x + i * spacing, platform_->height() * anchor.y, -0.9f);
+		icons_.push_back(icon);
+	}
+}
+
+void HUD::Render(RenderSnapshot& snapshot) const
+{
+	for(const TextElement& element : texts_)
+	{
+		for(const gef::Sprite& quad : element.quads)
+		{
+			snapshot.DrawSprite(quad, OverlayLayer::Text);
+		}
+	}
+	const int visible_icons = std::min(visible_icons_, (int)icons_.size());
+	for(int i = 0; i < visible_icons; i++)
+	{
+		snapshot.DrawSprite(icons_[i]);
+	}
+}
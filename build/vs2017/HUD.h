@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "GlyphFont.h"
+#include "maths/vector2.h"
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+}
+
+class RenderSnapshot;
+
+// Fixed size buffer for building HUD strings without allocating.
+// Anything past the capacity is dropped
+class HUDString
+{
+public:
+	static constexpr size_t kCapacity = 128;
+
+	HUDString& operator<<(const char* text);
+	HUDString& operator<<(int value);
+	const char* c_str() const { return buffer_; }
+
+private:
+	char buffer_[kCapacity] = {};
+	size_t length_ = 0;
+};
+
+// Retained HUD layer for a level.
+// Text keeps its glyph quads and is only laid out again when it changes, and goes into the
+// level's render snapshot as they are
+class HUD
+{
+public:
+	~HUD();
+	bool Init(gef::Platform& platform, const char* font_name);
+
+	// Centred text at anchor, given as a fraction of the screen like UIElement. Returns its index
+	int AddText(const gef::Vector2& anchor);
+	void SetText(int index, const char* text);
+
+	// Row of count copies of one image, of which SetVisibleIcons decides how many are drawn
+	void SetIcons(const char* filepath, const gef::Vector2& anchor, float size, float spacing, int count);
+	void SetVisibleIcons(int count) { visible_icons_ = count; }
+
+	void Render(RenderSnapshot& snapshot) const;
+
+private:
+	struct TextElement
+	{
+		gef::Vector4 position;
+		std::string text;
+		std::vector<gef::Sprite> quads;
+	};
+
+	gef::Platform* platform_ = nullptr;
+	GlyphFont font_;
+	std::vector<TextElement> texts_;
+	std::vector<gef::Sprite> icons_;
+	int visible_icons_ = 0;
+	gef::Texture* icon_texture_ = nullptr;
+};
@@ -1,7 +1,6 @@
 ﻿#include "Image.h"
 
 #include "graphics/sprite.h"
-#include "graphics/sprite_renderer.h"
 #include "system/platform.h"
 
 Image::Image(const gef::Vector2& anchor, gef::Sprite* sprite, const gef::Platform& platform)
@@ -10,9 +9,9 @@ Image::Image(const gef::Vector2& anchor, gef::Sprite* sprite, const gef::Platfor
 	sprite_->set_position(platform.width() * anchor_.x, platform.height() * anchor_.y, -0.9f);
 }
 
-void Image::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) const
+void Image::Render(Overlay& overlay) const
 {
-	sprite_renderer->DrawSprite(*sprite_);
+	overlay.DrawSprite(*sprite_, layer_);
 }
 
 void Image::SetAlpha(float alpha)
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include "Overlay.h"
 #include "UIElement.h"
 
 namespace gef
@@ -10,9 +11,12 @@ class Image : public UIElement
 {
 public:
 	Image(const gef::Vector2& anchor, gef::Sprite* sprite, const gef::Platform& platform);
-	void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) const override;
+	void Render(Overlay& overlay) const override;
 	void SetAlpha(float alpha) override;
 	gef::Sprite* GetSprite() { return sprite_; }
+	// Full screen backgrounds go under everything else with OverlayLayer::Background
+	void SetLayer(OverlayLayer layer) { layer_ = layer; }
 private:
 	gef::Sprite* sprite_ = nullptr;
+	OverlayLayer layer_ = OverlayLayer::Sprites;
 };
@@ -1,61 +1,92 @@
 ﻿#include "InputActionManager.h"
-#include <fstream>
+#include <stdexcept>
+#include "json.h"
+#include "AssetFile.h"
 #include <input/input_manager.h>
 #include <input/sony_controller_input_manager.h>
 #include <input/keyboard.h>
 #include <input/touch_input_manager.h>
+#include <system/debug_log.h>
+#include "Random.h"
 #include "StringToGefInputEnum.h"
 
-InputActionManager::InputActionManager(gef::Platform& platform)
+namespace
 {
-	platform_ = &platform;
+	// Written at the start of every recorded session
+	struct SessionHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t seed;
+	};
+	constexpr uint32_t session_magic = 0x52494747; // "GGIR"
+	constexpr uint32_t session_version = 2;
+}
 
-	// initialize actions vector from string
-	initializeActions(actionsStr.c_str());
+InputActionManager::InputActionManager(gef::Platform& platform, bool headless)
+{
+	platform_ = &platform;
 
 	// read bindings.json in config folder
-	std::ifstream i("config/bindings.json");
+	AssetFile i;
 
 	// handle error if file not found
-	if (i.fail())
+	if (!i.Open("config/bindings.json"))
 	{
-		throw std::exception("bindings.json not found");
+		throw std::runtime_error("bindings.json not found");
 	}
 
 	// parse json into cpp object
-	bindingsJson = json::parse(i);
+	const nlohmann::json bindingsJson = nlohmann::json::parse(i.begin(), i.end());
 
 	// setup action bindings
-	for (auto actionBinding : bindingsJson["actions"])
+	for (const auto& actionBinding : bindingsJson["actions"])
 	{
-		const Action action = stringToAction[actionBinding["action"]];
-		for (const auto& key : actionBinding["keys"])
+		const std::string name = actionBinding["action"];
+		const Action action = actionFromName(name);
+		if (action == ActionCount)
 		{
-			actionKeyBindings[stringToKeyCode[key]].push_back(action);
+			gef::DebugOut(("Unknown action " + name + " in bindings.json\n").c_str());
+			continue;
 		}
 
-		for (const auto& controllerButton : actionBinding["buttons"])
+		for (const auto& key : actionBinding.value("keys", nlohmann::json::array()))
 		{
-			actionControllerBindings[stringToControllerButton[controllerButton]].push_back(action);
+			const auto keyCode = stringToKeyCode.find(key.get<std::string>());
+			if (keyCode != stringToKeyCode.end())
+				keyBindings.push_back({ keyCode->second, action });
+		}
+
+		for (const auto& controllerButton : actionBinding.value("buttons", nlohmann::json::array()))
+		{
+			const auto button = stringToControllerButton.find(controllerButton.get<std::string>());
+			if (button != stringToControllerButton.end())
+				controllerBindings[action] |= button->second;
 		}
 	}
 
-	inputManager = gef::InputManager::Create(platform);
+	// Headless runs have no devices and are driven through SetScriptedActions instead
+	inputManager = headless ? nullptr : gef::InputManager::Create(platform);
+}
+
+InputActionManager::~InputActionManager()
+{
+	StopRecording();
 }
 
 bool InputActionManager::isPressed(Action action)
 {
-	return actionMapPressed[action];
+	return actionsPressed[action];
 }
 
 bool InputActionManager::isLMBPressed()
 {
-	return !lmb_pressed_ && inputManager->touch_manager()->is_button_down(0);
+	return !lmb_pressed_ && lmb_down_;
 }
 
 bool InputActionManager::isRMBPressed()
 {
-	return !rmb_pressed_ && inputManager->touch_manager()->is_button_down(1);
+	return !rmb_pressed_ && rmb_down_;
 }
 
 bool InputActionManager::isHeld(Action action)
@@ -68,7 +99,7 @@ bool InputActionManager::isHeld(Action action)
 			return getLeftStickX() > 0 ? true : false;
 		}
 	}
-	return actionMapHeld[action];
+	return actionsHeld[action];
 }
 
 bool InputActionManager::isReleased(Action action)
@@ -81,13 +112,51 @@ bool InputActionManager::isReleased(Action action)
 			return getLeftStickX() <= 0 ? true : false;
 		}
 	}
-	return actionMapReleased[action];
+	return actionsReleased[action];
 }
 
-void InputActionManager::Update()
+void InputActionManager::Update(float frame_time)
 {
-	lmb_pressed_ = inputManager->touch_manager()->is_button_down(0);
-	rmb_pressed_ = inputManager->touch_manager()->is_button_down(1);
+	frame_time_ = frame_time;
+
+	if (mode_ == Mode::Replay)
+	{
+		// While suspended (e.g. loading) the last replayed state is held and no frames are consumed
+		if (recording_suspended_)
+		{
+			return;
+		}
+
+		if (session_file_.read(reinterpret_cast<char*>(&current_frame_), sizeof(InputFrame)))
+		{
+			applyFrame(current_frame_);
+			frame_time_ = current_frame_.frame_time;
+			frame_pending_ = true;
+			return;
+		}
+
+		// Out of recorded frames, hand back to the devices
+		gef::DebugOut(("Replay finished after " + std::to_string(frame_number_) + " frames, " + std::to_string(diverged_frames_) + " diverged\n").c_str());
+		StopRecording();
+		replay_finished_ = true;
+	}
+
+	if (inputManager != nullptr)
+	{
+		pollDevices();
+	}
+
+	if (mode_ == Mode::Record && !recording_suspended_)
+	{
+		current_frame_ = captureFrame(frame_time);
+		frame_pending_ = true;
+	}
+}
+
+void InputActionManager::pollDevices()
+{
+	lmb_pressed_ = lmb_down_;
+	rmb_pressed_ = rmb_down_;
 	
 	auto kb = inputManager->keyboard();
 
@@ -95,76 +164,42 @@ void InputActionManager::Update()
 
 	inputManager->Update();
 
-	for (auto actionStr : actions)
+	// One pass over the bindings; pressed and released come from comparing with last frame
+	ActionSet heldNow;
+	bool keyPressed = false;
+	for (const KeyBinding& binding : keyBindings)
 	{
-		Action action = stringToAction[actionStr];
+		if (kb->IsKeyDown(binding.key))
+			heldNow.set(binding.action);
+		keyPressed = keyPressed || kb->IsKeyPressed(binding.key);
+	}
 
-		bool breakOut = false;
+	bool buttonPressed = false;
+	const uint32_t buttonsDown = controller->buttons_down();
+	const uint32_t buttonsPressed = controller->buttons_pressed();
+	for (int i = 0; i < ActionCount; i++)
+	{
+		if (buttonsDown & controllerBindings[i])
+			heldNow.set(i);
+		buttonPressed = buttonPressed || (buttonsPressed & controllerBindings[i]);
+	}
 
-		for (const auto binding : actionKeyBindings)
-		{
-			for(int i=0; i < binding.second.size(); i++)
-			{
-				if (action == binding.second[i])
-				{
-					bool oldMapPressed = actionMapPressed[action];
-					bool oldMapHeld = actionMapHeld[action];
-					bool oldMapReleased = actionMapReleased[action];
-
-					actionMapPressed[action] = kb->IsKeyPressed(binding.first);
-					actionMapHeld[action] = kb->IsKeyDown(binding.first);
-					actionMapReleased[action] = kb->IsKeyReleased(binding.first);
-
-					if (kb->IsKeyPressed(binding.first)) {
-						using_keyboard_ = true;
-					}
-					if (oldMapPressed != actionMapPressed[action] || oldMapHeld != actionMapHeld[action] || oldMapReleased != actionMapReleased[action])
-					{
-						breakOut = true;
-					}
-				}
-			}
-			if(breakOut)
-				break;
-		}
+	if (keyPressed)
+		using_keyboard_ = true;
+	else if (buttonPressed)
+		using_keyboard_ = false;
 
-		if (breakOut)
-		{
-			continue;
-		}
+	setHeld(heldNow);
+
+	left_stick_x_ = controller->left_stick_x_axis();
+	left_stick_y_ = controller->left_stick_y_axis();
+	right_stick_x_ = controller->right_stick_x_axis();
+	right_stick_y_ = controller->right_stick_y_axis();
+	if (left_stick_x_ || left_stick_y_ || right_stick_x_ || right_stick_y_) using_keyboard_ = false;
+
+	lmb_down_ = inputManager->touch_manager()->is_button_down(0);
+	rmb_down_ = inputManager->touch_manager()->is_button_down(1);
 
-		for (const auto binding : actionControllerBindings)
-		{
-			bool breakAgain = false;
-			for(int i=0; i < binding.second.size(); i++)
-			{
-				if (action == binding.second[i])
-				{
-					bool oldMapPressed = actionMapPressed[action];
-					bool oldMapHeld = actionMapHeld[action];
-					bool oldMapReleased = actionMapReleased[action];
-
-					actionMapPressed[action] = controller->buttons_pressed() & binding.first;
-					actionMapHeld[action] = controller->buttons_down() & binding.first;
-					actionMapReleased[action] = controller->buttons_released() & binding.first;
-
-					if (controller->buttons_pressed() & binding.first) {
-						using_keyboard_ = false;
-					}
-					if (oldMapPressed != actionMapPressed[action] || oldMapHeld != actionMapHeld[action] || oldMapReleased != actionMapReleased[action])
-					{
-						breakAgain = true;
-					}
-				}
-			}
-			if(breakAgain)
-				break;
-		}
-	}
-	getLeftStickX();
-	getLeftStickY();
-	getRightStickX();
-	getRightStickY();
 	gef::Vector2 old_mouse_pos = mouse_pos_;
 	mouse_pos_ = inputManager->touch_manager()->mouse_position();
 	if (old_mouse_pos.x != mouse_pos_.x || old_mouse_pos.y != mouse_pos_.y) using_keyboard_ = true;
@@ -172,53 +207,147 @@ void InputActionManager::Update()
 
 float InputActionManager::getLeftStickX()
 {
-	float value = inputManager->controller_input()->GetController(0)->left_stick_x_axis();
-	if (value) using_keyboard_ = false;
-	return value;
+	return left_stick_x_;
 }
 
 float InputActionManager::getLeftStickY()
 {
-	float value = inputManager->controller_input()->GetController(0)->left_stick_y_axis();
-	if (value) using_keyboard_ = false;
-	return value;
+	return left_stick_y_;
 }
 
 float InputActionManager::getRightStickX()
 {
-	float value = inputManager->controller_input()->GetController(0)->right_stick_x_axis();
-	if (value) using_keyboard_ = false;
-	return value;
+	return right_stick_x_;
 }
 
 float InputActionManager::getRightStickY()
 {
-	float value = inputManager->controller_input()->GetController(0)->right_stick_y_axis();
-	if (value) using_keyboard_ = false;
-	return value;
+	return right_stick_y_;
 }
 
-void InputActionManager::initializeActions(const char* values)
+void InputActionManager::SetScriptedActions(uint32_t held)
 {
-	// parse string into vector of strings on the commas
-	for (int i = 0; values[i] != '\0'; i++) {
-		if (values[i] == ',') {
-			actions.push_back(std::string(values, i));
-			values = values + i + 1;
-			i = -1;
-		}
+	setHeld(ActionSet(held));
+}
+
+void InputActionManager::setHeld(const ActionSet& held_now)
+{
+	actionsPressed = held_now & ~actionsHeld;
+	actionsReleased = actionsHeld & ~held_now;
+	actionsHeld = held_now;
+}
+
+bool InputActionManager::StartRecording(const char* filename)
+{
+	StopRecording();
+	session_file_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (session_file_.fail())
+	{
+		return false;
+	}
+
+	// New seed per recording, stored so the replay makes the same random choices
+	Random::Seed(Random::NewSeed());
+	const SessionHeader header = { session_magic, session_version, Random::GetSeed() };
+	session_file_.write(reinterpret_cast<const char*>(&header), sizeof(SessionHeader));
+
+	mode_ = Mode::Record;
+	frame_number_ = 0;
+	return true;
+}
+
+bool InputActionManager::StartReplay(const char* filename)
+{
+	StopRecording();
+	session_file_.open(filename, std::ios::in | std::ios::binary);
+	if (session_file_.fail())
+	{
+		return false;
+	}
+
+	SessionHeader header;
+	if (!session_file_.read(reinterpret_cast<char*>(&header), sizeof(SessionHeader)) || header.magic != session_magic || header.version != session_version)
+	{
+		session_file_.close();
+		return false;
 	}
-	actions.push_back(values);
+	Random::Seed(header.seed);
 
-	// clear up spaces
-	for (int i = 0; i < actions.size(); i++)
+	mode_ = Mode::Replay;
+	frame_number_ = 0;
+	diverged_frames_ = 0;
+	replay_finished_ = false;
+	return true;
+}
+
+void InputActionManager::StopRecording()
+{
+	if (session_file_.is_open())
+	{
+		session_file_.close();
+	}
+	mode_ = Mode::Live;
+	frame_pending_ = false;
+}
+
+void InputActionManager::EndFrame(uint32_t state_checksum)
+{
+	if (!frame_pending_)
+	{
+		return;
+	}
+	frame_pending_ = false;
+
+	if (mode_ == Mode::Record)
+	{
+		current_frame_.state_checksum = state_checksum;
+		session_file_.write(reinterpret_cast<const char*>(&current_frame_), sizeof(InputFrame));
+	}
+	else if (mode_ == Mode::Replay && current_frame_.state_checksum != state_checksum)
 	{
-		if (actions[i][0] == ' ')
+		if (diverged_frames_ == 0)
 		{
-			actions[i] = actions[i].substr(1);
+			gef::DebugOut(("Replay diverged from recording at frame " + std::to_string(frame_number_) + "\n").c_str());
 		}
-
-		// setup string to action map for easy lookup
-		stringToAction[actions[i]] = (Action)i;
+		diverged_frames_++;
 	}
+	frame_number_++;
+}
+
+InputActionManager::InputFrame InputActionManager::captureFrame(float frame_time)
+{
+	InputFrame frame{};
+	frame.frame_time = frame_time;
+	frame.pressed = (uint32_t)actionsPressed.to_ulong();
+	frame.held = (uint32_t)actionsHeld.to_ulong();
+	frame.released = (uint32_t)actionsReleased.to_ulong();
+	frame.mouse_x = mouse_pos_.x;
+	frame.mouse_y = mouse_pos_.y;
+	frame.left_stick_x = left_stick_x_;
+	frame.left_stick_y = left_stick_y_;
+	frame.right_stick_x = right_stick_x_;
+	frame.right_stick_y = right_stick_y_;
+	if (using_keyboard_) frame.flags |= UsingKeyboard;
+	if (lmb_down_) frame.flags |= LMBDown;
+	if (rmb_down_) frame.flags |= RMBDown;
+	if (lmb_pressed_) frame.flags |= LMBWasDown;
+	if (rmb_pressed_) frame.flags |= RMBWasDown;
+	return frame;
+}
+
+void InputActionManager::applyFrame(const InputFrame& frame)
+{
+	actionsPressed = ActionSet(frame.pressed);
+	actionsHeld = ActionSet(frame.held);
+	actionsReleased = ActionSet(frame.released);
+	mouse_pos_ = gef::Vector2(frame.mouse_x, frame.mouse_y);
+	left_stick_x_ = frame.left_stick_x;
+	left_stick_y_ = frame.left_stick_y;
+	right_stick_x_ = frame.right_stick_x;
+	right_stick_y_ = frame.right_stick_y;
+	using_keyboard_ = frame.flags & UsingKeyboard;
+	lmb_down_ = frame.flags & LMBDown;
+	rmb_down_ = frame.flags & RMBDown;
+	lmb_pressed_ = frame.flags & LMBWasDown;
+	rmb_pressed_ = frame.flags & RMBWasDown;
 }
@@ -1,5 +1,9 @@
 ﻿#pragma once
-#include "json.h"
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+#include <vector>
 #include "input/keyboard.h"
 #include <maths/vector2.h>
 
@@ -9,43 +13,61 @@ namespace gef
 	class InputManager;
 }
 
-using json = nlohmann::json;
-
-#define DEFINE_ACTIONS(...) \
-	enum Action { __VA_ARGS__ }; \
-	const std::string actionsStr = {#__VA_ARGS__}; \
-
-DEFINE_ACTIONS(
-	MoveLeft,
-	MoveRight,
-	Jump,
-	GravityLock,
-	GravityUp,
-	GravityDown,
-	GravityLeft,
-	GravityRight,
-	GravityStrenghtUp,
-	GravityStrengthDown,
-	Fire,
-	Grapple,
-	Reload,
-	Pause,
-	MenuSelect,
-	MenuSelectRight,
-	MenuSelectLeft,
-	UseItem
-	)
-
-	class InputActionManager
+// Every action, in bit order. Append new actions at the end so recorded sessions keep their meaning
+#define ACTION_LIST(X) \
+	X(MoveLeft) \
+	X(MoveRight) \
+	X(Jump) \
+	X(GravityLock) \
+	X(GravityUp) \
+	X(GravityDown) \
+	X(GravityLeft) \
+	X(GravityRight) \
+	X(GravityStrenghtUp) \
+	X(GravityStrengthDown) \
+	X(Fire) \
+	X(Grapple) \
+	X(Reload) \
+	X(Pause) \
+	X(MenuSelect) \
+	X(MenuSelectRight) \
+	X(MenuSelectLeft) \
+	X(UseItem) \
+	X(ToggleProfiler) \
+	X(ExportProfilerTrace)
+
+#define ACTION_ENUM_ENTRY(name) name,
+#define ACTION_NAME_ENTRY(name) #name,
+
+enum Action { ACTION_LIST(ACTION_ENUM_ENTRY) ActionCount };
+constexpr std::string_view actionNames[] = { ACTION_LIST(ACTION_NAME_ENTRY) };
+
+// Recordings and scripted input store actions as 32 bit masks
+static_assert(ActionCount <= 32, "too many actions for a uint32_t mask");
+
+// Action called name in bindings.json, or ActionCount if there isn't one
+constexpr Action actionFromName(std::string_view name)
+{
+	for (int i = 0; i < ActionCount; i++)
+	{
+		if (actionNames[i] == name)
+			return (Action)i;
+	}
+	return ActionCount;
+}
+
+class InputActionManager
 {
 public:
-	explicit InputActionManager(gef::Platform& platform);
+	explicit InputActionManager(gef::Platform& platform, bool headless = false);
+	~InputActionManager();
 	bool isPressed(Action action);
 	bool isLMBPressed();
 	bool isRMBPressed();
+	bool isLMBHeld() { return lmb_down_; }
 	bool isHeld(Action action);
 	bool isReleased(Action action);
-	void Update();
+	void Update(float frame_time);
 	float getLeftStickX();
 	float getLeftStickY();
 	float getRightStickX();
@@ -54,20 +76,91 @@ public:
 	gef::InputManager* getInputManager() { return inputManager; }
 	bool getUsingKeyboard() { return using_keyboard_; }
 
+	// Sets every action from a mask of held actions (bit n = Action n), working out pressed/released edges
+	void SetScriptedActions(uint32_t held);
+
+	// Recording and replay of input sessions
+	bool StartRecording(const char* filename);
+	bool StartReplay(const char* filename);
+	void StopRecording();
+	void SetRecordingSuspended(bool suspended) { recording_suspended_ = suspended; }
+	void EndFrame(uint32_t state_checksum);
+	float getFrameTime() { return frame_time_; }
+	bool isReplaying() { return mode_ == Mode::Replay; }
+	bool replayFinished() { return replay_finished_; }
+	int getDivergedFrames() { return diverged_frames_; }
+
 private:
-	void initializeActions(const char* values);
-	json bindingsJson;
-	std::map<gef::Keyboard::KeyCode, std::vector<Action>> actionKeyBindings;
-	std::map<uint32_t, std::vector<Action>> actionControllerBindings;
-	std::map<Action, bool> actionMapPressed;
-	std::map<Action, bool> actionMapHeld;
-	std::map<Action, bool> actionMapReleased;
-	std::vector<std::string> actions;
-	std::map<std::string, Action> stringToAction;
+	enum class Mode { Live, Record, Replay };
+
+	// One frame of input as written to a recording, byte for byte. Laid out with no padding so
+	// the same session always writes the same file
+	struct InputFrame
+	{
+		float frame_time = 0.f;
+		uint32_t pressed = 0;
+		uint32_t held = 0;
+		uint32_t released = 0;
+		float mouse_x = 0.f;
+		float mouse_y = 0.f;
+		float left_stick_x = 0.f;
+		float left_stick_y = 0.f;
+		float right_stick_x = 0.f;
+		float right_stick_y = 0.f;
+		uint32_t state_checksum = 0;
+		uint8_t flags = 0;
+		uint8_t reserved[3] = {};
+	};
+	static_assert(sizeof(InputFrame) == 48, "InputFrame is written as is and can't have padding");
+	enum FrameFlags : uint8_t
+	{
+		UsingKeyboard = 1 << 0,
+		LMBDown = 1 << 1,
+		RMBDown = 1 << 2,
+		LMBWasDown = 1 << 3,
+		RMBWasDown = 1 << 4
+	};
+
+	using ActionSet = std::bitset<ActionCount>;
+
+	struct KeyBinding
+	{
+		gef::Keyboard::KeyCode key;
+		Action action;
+	};
+
+	void pollDevices();
+	void setHeld(const ActionSet& held_now);
+	InputFrame captureFrame(float frame_time);
+	void applyFrame(const InputFrame& frame);
+
+	// Flat binding tables, walked once per frame
+	std::vector<KeyBinding> keyBindings;
+	uint32_t controllerBindings[ActionCount] = {};
+
+	ActionSet actionsPressed;
+	ActionSet actionsHeld;
+	ActionSet actionsReleased;
 	gef::InputManager* inputManager;
 	gef::Platform* platform_;
 	gef::Vector2 mouse_pos_;
 	bool using_keyboard_ = true;
 	bool lmb_pressed_ = false;
 	bool rmb_pressed_ = false;
+	bool lmb_down_ = false;
+	bool rmb_down_ = false;
+	float left_stick_x_ = 0.f;
+	float left_stick_y_ = 0.f;
+	float right_stick_x_ = 0.f;
+	float right_stick_y_ = 0.f;
+
+	Mode mode_ = Mode::Live;
+	std::fstream session_file_;
+	InputFrame current_frame_{};
+	bool recording_suspended_ = false;
+	bool frame_pending_ = false;
+	bool replay_finished_ = false;
+	int frame_number_ = 0;
+	int diverged_frames_ = 0;
+	float frame_time_ = 0.f;
 };
@@ -1,27 +1,31 @@
 ﻿#include "Level.h"
 
-#include <d3d10.h>
-#include <fstream>
+#include <cfloat>
+#include <stdexcept>
 
+#include "AssetFile.h"
 #include "Enemy.h"
 #include "GameObject.h"
 #include "json.h"
 
 #include "PressurePlate.h"
+#include "Profiler.h"
 #include "primitive_builder.h"
+#include "SimulationTimings.h"
 #include "Text.h"
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_contact_manager.h"
 #include "box2d/b2_math.h"
 #include "box2d/b2_world.h"
 #include "graphics/font.h"
-#include "graphics/sprite_renderer.h"
 #include "maths/math_utils.h"
 #include "system/debug_log.h"
 #include "InputActionManager.h"
 #include "input/sony_controller_input_manager.h"
-#include "LoadingScreen.h"
+#include "LoaderService.h"
 #include "Menu.h"
 #include "Button.h"
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
 #include "input/input_manager.h"
 #include "graphics/image_data.h"
 #include "graphics/texture.h"
@@ -38,41 +42,40 @@ Level::~Level()
 	CleanUp();
 }
 
-void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OBJMeshLoader& obj_loader)
+void Level::LoadFromFile(const char* filename, LoadContext& context, OBJMeshLoader& obj_loader)
 {
+	PROFILE_ZONE("Level::LoadFromFile");
+
 	// load level from file
 	obj_loader_ = &obj_loader;
 	file_name_ = filename;
-	loading_screen->SetStatusText("Reading level file...");
-	std::ifstream i(std::string("levels/") + std::string(filename));
+	context.Stage("Reading level file...");
+	AssetFile i;
 
 	// handle error if file not found
-	if (i.fail())
+	if (!i.Open(std::string("levels/") + std::string(filename)))
 	{
-		throw std::exception((std::string(filename)+ " not found").c_str());
+		throw std::runtime_error(std::string(filename)+ " not found");
 	}
 	
 	// parse json into cpp object
-	loading_screen->SetStatusText("Parsing level JSON...");
-	json levelJson = json::parse(i);
+	context.Stage("Parsing level JSON...");
+	json levelJson = json::parse(i.begin(), i.end());
 
-	loading_screen->SetStatusText("Initializing level...");
+	context.Stage("Initializing level...");
 	Init();
 	camera_.GetBackground()->set_mesh(sprite_animator3D_->CreateMesh("space.png", gef::Vector4(960, 540, 0)));
-
-	loading_screen->SetStatusText("Loading HUD...");
-	gef::ImageData image_data("UI/heart.png");
-	for (int i = 0; i < 10; i++) {
-		gef::Sprite* heart = new gef::Sprite();
-		heart->set_texture(gef::Texture::Create(*platform_, image_data));
-		heart->set_width(25);
-		heart->set_height(25);
-		healthbar_.push_back(Image({ 0.1, 0.1 }, heart, *platform_));
-		healthbar_.back().GetSprite()->set_position(healthbar_.back().GetSprite()->position() + gef::Vector4(i * 30, 0, 0));
-	}
+	loot_.Init(b2_world_, sprite_animator3D_, audio_manager_, random_);
+
+	context.Stage("Loading HUD...");
+	hud_.Init(*platform_, "ranger");
+	hud_.AddText({0.9f, 0.9f}); // Ammo
+	hud_.AddText({0.5f, 0.5f}); // EndText
+	hud_.AddText({0.5f, 0.9f}); // GravLock
+	hud_.SetIcons("UI/heart.png", { 0.1f, 0.1f }, 25.f, 30.f, 10);
 	
 	// LOAD 3D MODELS
-	loading_screen->SetStatusText("Loading 3D meshes...");
+	context.Stage("Loading 3D meshes...");
 	if(!obj_loader.Load(MeshResource::Level, "Models/Generic/crate2/crate2.obj", "Crate_1__Default_0", *platform_))
 	{
 		gef::DebugOut(obj_loader.GetLastError().c_str());
@@ -136,7 +139,7 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 		{
 			if(layer["name"] == "StaticLevelCollisions")
 			{
-				loading_screen->SetStatusText("Creating static game objects...");
+				context.Stage("Creating static game objects...");
 				gef::Vector4 old_scale;
 
 				for(const auto& obj : layer["objects"])
@@ -155,29 +158,31 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 						gef::Vector4 scale = gef::Vector4(obj["width"], obj["height"], 1.f);
 						LoadObject(obj, MeshResource::Consol, obj_loader, scale);
 						static_game_objects_.back()->SetTag(GameObject::Tag::NextObject);
+						static_game_objects_.back()->SetCollisionLayer(CollisionLayer::Trigger);
 					}
 					else if (type == "win") {
 						gef::Vector4 scale = gef::Vector4(obj["width"], obj["height"], 2.f);
 						LoadObject(obj, MeshResource::Reactor, obj_loader, scale);
 						static_game_objects_.back()->SetTag(GameObject::Tag::WinObject);
+						static_game_objects_.back()->SetCollisionLayer(CollisionLayer::Trigger);
 					}
 					else if (type == "door") {
 						gef::Vector4 scale = gef::Vector4(obj["width"], obj["height"], 10.f);
-						gef::Mesh* door_wall = obj_loader.GetMesh(MeshResource::DoorWall, scale);
-						gef::Mesh* door_frame = obj_loader.GetMesh(MeshResource::DoorFrame, scale);
-						gef::Mesh* door = obj_loader.GetMesh(MeshResource::Door, scale);
+						const MeshLods* door_wall = obj_loader.GetMeshLods(MeshResource::DoorWall, scale);
+						const MeshLods* door_frame = obj_loader.GetMeshLods(MeshResource::DoorFrame, scale);
+						const MeshLods* door = obj_loader.GetMeshLods(MeshResource::Door, scale);
 
 						int ID = std::find_if(obj["properties"].begin(), obj["properties"].end(), [](const json& element)
 							{ return element["name"] == "ID"; }).value()["value"];
-						door_objects_[ID] = new Door(gef::Vector4(obj["width"] / 2.f, obj["height"] / 2.f, 0.f), gef::Vector4((float)obj["x"] + ((float)obj["width"] / 2.f), (-(float)obj["y"]) - ((float)obj["height"] / 2.f), 0.f), b2_world_, primitive_builder_, audio_manager_, door_wall, door_frame, door);
+						door_objects_[ID] = new Door(gef::Vector4(obj["width"] / 2.f, obj["height"] / 2.f, 0.f), gef::Vector4((float)obj["x"] + ((float)obj["width"] / 2.f), (-(float)obj["y"]) - ((float)obj["height"] / 2.f), 0.f), b2_world_, primitive_builder_, audio_manager_, &scheduler_, door_wall, door_frame, door);
 					}
 				}
 			}
 			if (layer["name"] == "Background") {
-				loading_screen->SetStatusText("Creating background scenery...");
+				context.Stage("Creating background scenery...");
 				gef::Matrix44 transform_matrix;
 				transform_matrix.SetIdentity();
-				gef::Mesh* new_mesh;
+				const MeshLods* new_mesh;
 
 				for (const auto& obj : layer["objects"])
 				{
@@ -186,31 +191,63 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 					gef::Vector4 scale = gef::Vector4(obj["width"], obj["height"], 1.f);
 					
 					if (type == "wall") {
-						new_mesh = obj_loader.GetMesh(MeshResource::BackWall, scale);
+						new_mesh = obj_loader.GetMeshLods(MeshResource::BackWall, scale);
 					}
 					else if (type == "window") {
-						new_mesh = obj_loader.GetMesh(MeshResource::Window, scale);
+						new_mesh = obj_loader.GetMeshLods(MeshResource::Window, scale);
 					}
 
 					transform_matrix.SetTranslation(gef::Vector4((float)obj["x"] + ((float)obj["width"] / 2.f), (-(float)obj["y"]) - ((float)obj["height"] / 2.f), -5.f));
-					background_objects_.emplace_back(new gef::MeshInstance());
+					background_objects_.emplace_back(new LodMeshInstance());
 					background_objects_.back()->set_transform(transform_matrix);
-					background_objects_.back()->set_mesh(new_mesh);
+					background_objects_.back()->SetMeshLods(new_mesh);
+				}
+			}
+			if(layer["name"] == "GravityZones")
+			{
+				// Rectangles pulling "direction" (up, down, left or right) at "strength", 10 by default
+				for(const auto& obj : layer["objects"])
+				{
+					std::string direction = "down";
+					float strength = 10.f;
+					if(obj.contains("properties"))
+					{
+						for(const auto& property : obj["properties"])
+						{
+							if(property["name"] == "direction")
+								direction = property["value"];
+							else if(property["name"] == "strength")
+								strength = property["value"];
+						}
+					}
+
+					b2Vec2 gravity(0, -strength);
+					if(direction == "up")
+						gravity.Set(0, strength);
+					else if(direction == "left")
+						gravity.Set(-strength, 0);
+					else if(direction == "right")
+						gravity.Set(strength, 0);
+
+					b2AABB bounds;
+					bounds.lowerBound.Set((float)obj["x"], -(float)obj["y"] - (float)obj["height"]);
+					bounds.upperBound.Set((float)obj["x"] + (float)obj["width"], -(float)obj["y"]);
+					gravity_field_.AddZone(bounds, gravity);
 				}
 			}
 			if(layer["name"] == "PlayerSpawn")
 			{
-				loading_screen->SetStatusText("Creating player...");
+				context.Stage("Creating player...");
 				auto playerJson = layer["objects"][0];
 				player_.Init(1, 1, 1, playerJson["x"], 0-playerJson["y"], b2_world_, sprite_animator3D_, audio_manager_, &camera_, this);
 				camera_.SetPosition(gef::Vector4(playerJson["x"], 1-playerJson["y"], 30));
 			}
 			if(layer["name"] == "DynamicSpawns")
 			{
-				loading_screen->SetStatusText("Creating dynamic game objects...");
-				gef::Mesh* crate_mesh;
+				context.Stage("Creating dynamic game objects...");
+				const MeshLods* crate_mesh;
 				gef::Vector4 scale = gef::Vector4(1.f, 1.f, 1.f);
-				crate_mesh = obj_loader.GetMesh(MeshResource::Crate, scale);
+				crate_mesh = obj_loader.GetMeshLods(MeshResource::Crate, scale);
 				float plate_offset_ = 0.f;
 				for(const auto& object : layer["objects"])
 				{
@@ -222,14 +259,13 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 					
 					if(type == "enemy")
 					{
-						loading_screen->SetStatusText("Creating enemy...");
 						Enemy* enemy = new Enemy();
-						enemy->Init(1, 1, 1, object["x"], 0-object["y"], b2_world_, primitive_builder_, sprite_animator3D_, audio_manager_, &player_, dynamic_game_objects_);
+						enemy->Init(1, 1, 1, object["x"], 0-object["y"], b2_world_, primitive_builder_, sprite_animator3D_, audio_manager_, &player_, &loot_);
+						enemy->SetGravityField(&gravity_field_);
 						enemies_.push_back(enemy);
 					}
 					else if(type == "plate")
 					{
-						loading_screen->SetStatusText("Creating pressure plates...");
 						PressurePlate* plate = new PressurePlate();
 						
 						float threshold = std::find_if(object["properties"].begin(), object["properties"].end(), [](const json& element)
@@ -239,17 +275,15 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 						bool fussy = std::find_if(object["properties"].begin(), object["properties"].end(), [](const json& element)
 							{ return element["name"] == "fussy"; }).value()["value"];
 						
-						plate->Init(object["width"]/2.f,0.f,1.f,object["x"] + object["width"]/2.f, (-(float)object["y"]), b2_world_, primitive_builder_, sprite_renderer_, font_, threshold, platform_, audio_manager_, plate_offset_, fussy);
+						plate->Init(object["width"]/2.f,0.f,1.f,object["x"] + object["width"]/2.f, (-(float)object["y"]), b2_world_, primitive_builder_, threshold, platform_, audio_manager_, plate_offset_, fussy);
 						plate_offset_ += 32.f;
+						plate->SetContactGraph(&contact_graph_);
 						plate->SetOnActivate([this, door_ID] { door_objects_[door_ID]->Open(); gef::DebugOut("\n"); gef::DebugOut(std::to_string(door_ID).c_str()); });
 						plate->SetOnDeactivate([this, door_ID] { door_objects_[door_ID]->Close(); });
 						static_game_objects_.push_back(plate);
 					}
 					else
 					{
-						if(type == "crate") loading_screen->SetStatusText("Creating crate...");
-						else loading_screen->SetStatusText("Creating dynamic game object...");
-						
 						dynamic_game_objects_.emplace_back(new GameObject());
 						GameObject* dynObject = dynamic_game_objects_.back();
 						dynObject->Init(0.6f, 0.6f, 0.6f, object["x"], 0-object["y"], b2_world_, primitive_builder_, audio_manager_, true);
@@ -257,7 +291,7 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 						{
 							dynObject->SetTag(GameObject::Tag::Crate);
 							if (crate_mesh) {
-								dynObject->set_mesh(crate_mesh);
+								dynObject->SetMeshLods(crate_mesh);
 							}
 						}
 					}
@@ -265,17 +299,51 @@ void Level::LoadFromFile(const char* filename, LoadingScreen* loading_screen, OB
 			}
 		}
 	}
+
+	context.Stage("Dividing level into chunks...");
+	chunk_streamer_.Init(16.f, 2, 3);
+	chunk_streamer_.SetContactGraph(&contact_graph_);
+	for(GameObject* object : static_game_objects_)
+	{
+		// Plates have to keep feeling what's on them
+		if(object->GetTag() != GameObject::Tag::PressurePlate)
+		{
+			chunk_streamer_.AddStatic(object);
+		}
+	}
+	for(GameObject* object : dynamic_game_objects_)
+	{
+		chunk_streamer_.AddDynamic(object);
+	}
+	for(Enemy* enemy : enemies_)
+	{
+		chunk_streamer_.AddDynamic(enemy);
+	}
+
+	context.Stage("Saving initial state...");
+	SaveInitialState();
 }
 
 void Level::LoadObject(auto obj, MeshResource mr, OBJMeshLoader& obj_loader, gef::Vector4& scale) {
-	gef::Mesh* new_mesh = obj_loader.GetMesh(mr, scale);
+	const MeshLods* new_mesh = obj_loader.GetMeshLods(mr, scale);
 	static_game_objects_.emplace_back(new GameObject());
 	static_game_objects_.back()->Init(obj["width"] / 2.f, obj["height"] / 2.f, 1.f, (float)obj["x"] + ((float)obj["width"] / 2.f), (-(float)obj["y"]) - ((float)obj["height"] / 2.f), b2_world_, primitive_builder_, audio_manager_);
-	static_game_objects_.back()->set_mesh(new_mesh);
+	static_game_objects_.back()->SetMeshLods(new_mesh);
 }
 
 void Level::CleanUp()
 {
+	// Dead objects are only disabled, so once the initial state is saved it is the list that owns everything
+	if(initial_state_.captured)
+	{
+		dynamic_game_objects_ = initial_state_.dynamic_game_objects;
+		enemies_ = initial_state_.enemies;
+		initial_state_.dynamic_game_objects.clear();
+		initial_state_.enemies.clear();
+		initial_state_.captured = false;
+	}
+	chunk_streamer_.Clear();
+	scheduler_.CancelAll();
 	for(auto& object : static_game_objects_)
 	{
 		delete object;
@@ -302,6 +370,8 @@ void Level::CleanUp()
 		object = nullptr;
 	}
 	
+	gravity_field_.Clear();
+	loot_.Clear();
 	delete b2_world_;
 	b2_world_ = nullptr;
 	
@@ -314,7 +384,170 @@ void Level::CleanUp()
 
 const char* Level::GetFileName() const
 {
-	return file_name_;
+	return file_name_.c_str();
+}
+
+int Level::GetBroadphaseProxyCount() const
+{
+	return b2_world_->GetProxyCount();
+}
+
+int Level::GetContactCount() const
+{
+	return b2_world_->GetContactCount();
+}
+
+int Level::GetAwakeBodyCount() const
+{
+	int awake = 0;
+	for(const b2Body* body = b2_world_->GetBodyList(); body != nullptr; body = body->GetNext())
+	{
+		if(body->GetType() != b2_staticBody && body->IsEnabled() && body->IsAwake())
+			awake++;
+	}
+	return awake;
+}
+
+void Level::CountBroadphaseMoves()
+{
+	// A proxy is only moved in the tree when it's given new fattened bounds, so comparing them with
+	// last frame's counts the moves without box2d having to say
+	struct ProxyCollector
+	{
+		std::vector<int32>* ids;
+		bool QueryCallback(int32 proxy_id)
+		{
+			ids->push_back(proxy_id);
+			return true;
+		}
+	};
+
+	const b2BroadPhase& broad_phase = b2_world_->GetContactManager().m_broadPhase;
+	b2AABB everything;
+	everything.lowerBound.Set(-FLT_MAX, -FLT_MAX);
+	everything.upperBound.Set(FLT_MAX, FLT_MAX);
+	proxy_ids_.clear();
+	ProxyCollector collector{ &proxy_ids_ };
+	broad_phase.Query(&collector, everything);
+
+	broadphase_moves_ = 0;
+	for(const int32 id : proxy_ids_)
+	{
+		if(id >= (int32)proxy_bounds_.size())
+		{
+			b2AABB unseen;
+			unseen.lowerBound.Set(FLT_MAX, FLT_MAX);
+			unseen.upperBound.Set(-FLT_MAX, -FLT_MAX);
+			proxy_bounds_.resize(id + 1, unseen);
+		}
+		const b2AABB& bounds = broad_phase.GetFatAABB(id);
+		b2AABB& last = proxy_bounds_[id];
+		if(bounds.lowerBound != last.lowerBound || bounds.upperBound != last.upperBound)
+		{
+			broadphase_moves_++;
+			last = bounds;
+		}
+	}
+}
+
+std::string Level::GetNextLevelFileName() const
+{
+	if(file_name_ == "lvl_4.json")
+	{
+		return std::string();
+	}
+
+	std::string nlf = file_name_;
+	nlf = nlf.substr(nlf.find(".json") - 1, 1);
+	return "lvl_" + std::to_string(std::stoi(nlf) + 1) + ".json";
+}
+
+void Level::SaveInitialState()
+{
+	initial_state_.gravity = b2_world_->GetGravity();
+
+	// Static colliders never move, so only keep bodies that can (doors handle their own)
+	initial_state_.bodies.clear();
+	for(b2Body* body = b2_world_->GetBodyList(); body != nullptr; body = body->GetNext())
+	{
+		if(body->GetType() == b2_staticBody)
+			continue;
+		initial_state_.bodies.push_back({ body, body->GetPosition(), body->GetAngle(), body->GetLinearVelocity(), body->GetAngularVelocity(), body->GetGravityScale(), body->IsAwake(), body->IsEnabled() });
+	}
+
+	player_.SaveInitialState();
+	for(GameObject* object : static_game_objects_)
+	{
+		object->SaveInitialState();
+	}
+	for(GameObject* object : dynamic_game_objects_)
+	{
+		object->SaveInitialState();
+	}
+	for(Enemy* enemy : enemies_)
+	{
+		enemy->SaveInitialState();
+	}
+	for(const std::pair<const int, Door*> object : door_objects_)
+	{
+		object.second->SaveInitialState();
+	}
+
+	initial_state_.dynamic_game_objects = dynamic_game_objects_;
+	initial_state_.enemies = enemies_;
+	initial_state_.camera = camera_;
+	initial_state_.captured = true;
+}
+
+bool Level::Restart()
+{
+	if(!initial_state_.captured)
+		return false;
+
+	// Everything goes back in the world before the snapshot is put back
+	chunk_streamer_.Reset();
+	scheduler_.CancelAll();
+	gravity_field_.Reset(initial_state_.gravity);
+	loot_.Reset();
+	b2_world_->ClearForces();
+	for(const BodySnapshot& snapshot : initial_state_.bodies)
+	{
+		b2Body* body = snapshot.body;
+		body->SetEnabled(snapshot.enabled);
+		body->SetTransform(snapshot.position, snapshot.angle);
+		body->SetLinearVelocity(snapshot.linear_velocity);
+		body->SetAngularVelocity(snapshot.angular_velocity);
+		body->SetGravityScale(snapshot.gravity_scale);
+		body->SetAwake(snapshot.awake);
+	}
+
+	dynamic_game_objects_ = initial_state_.dynamic_game_objects;
+	enemies_ = initial_state_.enemies;
+	objects_to_destroy_.clear();
+
+	sprite_animator3D_->ResetAll();
+	player_.RestoreInitialState();
+	for(GameObject* object : static_game_objects_)
+	{
+		object->RestoreInitialState();
+	}
+	for(GameObject* object : dynamic_game_objects_)
+	{
+		object->RestoreInitialState();
+	}
+	for(Enemy* enemy : enemies_)
+	{
+		enemy->RestoreInitialState();
+	}
+	for(const std::pair<const int, Door*> object : door_objects_)
+	{
+		object.second->RestoreInitialState();
+	}
+
+	camera_ = initial_state_.camera;
+	end_state_ = NONE;
+	is_paused_ = false;
+	return true;
 }
 
 void Level::Init()
@@ -324,20 +557,32 @@ void Level::Init()
 
 	// Set collision manager as contact listener for the world
 	b2_world_->SetContactListener(&collision_manager_);
+	collision_manager_.SetContactGraph(&contact_graph_);
 	b2_world_->SetAutoClearForces(false);
+	gravity_field_.Init(b2_world_);
+	camera_.SetScheduler(&scheduler_);
 	
 	// initialise primitive builder to make create some 3D geometry easier
 	primitive_builder_ = new PrimitiveBuilder(*platform_);
 	sprite_animator3D_ = new SpriteAnimator3D(platform_, primitive_builder_, gef::Vector4(1, 1, 1));
 	sprite_animator3D_->Init();
-
-	hud_text_[Ammo] = new Text({0.9f, 0.9f}, "", *platform_);
-	hud_text_[EndText] = new Text({0.5f, 0.5f}, "", *platform_);
-	hud_text_[GravLock] = new Text({0.5f, 0.9f}, "", *platform_);
 }
 
 void Level::Update(InputActionManager* iam_, float frame_time)
 {
+	PROFILE_ZONE("Level::Update");
+
+	// Get the next level loading while this one is played so moving on to it is quick
+	if(!next_level_prefetched_ && obj_loader_ != nullptr)
+	{
+		next_level_prefetched_ = true;
+		const std::string next_level = GetNextLevelFileName();
+		if(!next_level.empty())
+		{
+			state_manager_->PrefetchLevel(new Level(*platform_, *state_manager_, audio_manager_), next_level.c_str(), *obj_loader_);
+		}
+	}
+
 	if(iam_->isPressed(Action::Pause))
 	{
 		is_paused_ = !is_paused_;
@@ -360,7 +605,8 @@ void Level::Update(InputActionManager* iam_, float frame_time)
 		
 		if(end_state_ == WIN)
 		{
-			if(std::string(file_name_) == std::string("lvl_4.json"))
+			const std::string nlf = GetNextLevelFileName();
+			if(nlf.empty())
 			{
 				end->AddUIElement(new Text({ 0.5,0.3 }, "Thanks For Playing!"));
 			}
@@ -369,13 +615,13 @@ void Level::Update(InputActionManager* iam_, float frame_time)
 				end->AddUIElement(new Text({ 0.5,0.3 }, "Level Complete"));
 				Button* nextLevelButton = new Button({ 0.5,0.5 }, *platform_, "Next Level", 220.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 
-				std::string nlf = file_name_;
-				nlf = nlf.substr(nlf.find(".json") - 1, 1);
-				nlf = "lvl_" + std::to_string(std::stoi(nlf) + 1) + ".json";
 				nextLevelButton->SetOnClick([this, nlf]
 					{
 						CleanUp();
-						state_manager_->PushLevel(new Level(*platform_, sprite_renderer_, font_, *state_manager_, audio_manager_), nlf.c_str(), *obj_loader_);
+						if(!state_manager_->PushPrefetchedLevel(nlf.c_str()))
+						{
+							state_manager_->PushLevel(new Level(*platform_, *state_manager_, audio_manager_), nlf.c_str(), *obj_loader_);
+						}
 						state_manager_->NextScene();
 						delete this;
 					});
@@ -387,10 +633,9 @@ void Level::Update(InputActionManager* iam_, float frame_time)
 			Button* restartButton = new Button({ 0.5,0.5 }, *platform_, "Restart Level", 220.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 			restartButton->SetOnClick([this]
 				{
-					CleanUp();
-					state_manager_->PushLevel(new Level(*platform_, sprite_renderer_, font_, *state_manager_, audio_manager_), file_name_, *obj_loader_);
+					Restart();
+					state_manager_->PushScene(this);
 					state_manager_->NextScene();
-					delete this;
 				});
 			end->AddUIElement(restartButton);
 			end->AddUIElement(new Text({ 0.5,0.3 }, "Game Over"));
@@ -402,104 +647,107 @@ void Level::Update(InputActionManager* iam_, float frame_time)
 
 	else if(!is_paused_)
 	{
-		
-		b2_world_->Step(frame_time, 20, 20);
-		b2_world_->ClearForces();
+		SimulationTimings::SetActive(timings_);
+
+		{
+			ScopedSimulationTimer timer("ChunkStreamer::Update", &SimulationTimings::streaming);
+			chunk_streamer_.Update(getPlayerPosition().x);
+		}
 
-		player_.Update(iam_, frame_time);
+		// Enemies too far from the player to matter aren't heard
+		audio_manager_->SetListener(getPlayerPosition());
 
-		for(int i=0; i < static_game_objects_.size(); i++)
 		{
-			static_game_objects_[i]->Update(frame_time);
+			ScopedSimulationTimer timer("b2World::Step", &SimulationTimings::physics);
+			gravity_field_.Apply();
+			b2_world_->Step(frame_time, 20, 20);
+			b2_world_->ClearForces();
+			collision_manager_.DispatchEvents();
 		}
-		for (const std::pair<const int, Door*> object : door_objects_)
+		if(timings_ != nullptr)
 		{
-			object.second->Update(frame_time);
+			CountBroadphaseMoves();
 		}
 
-		for(int i = 0; i < dynamic_game_objects_.size(); i++)
 		{
-			auto* object = dynamic_game_objects_[i];
-			object->Update(frame_time);
-			if(object->TimeToDie())
-			{
-				objects_to_destroy_.push_back(object);
-				dynamic_game_objects_.erase(dynamic_game_objects_.begin() + i);
-			}
+			ScopedSimulationTimer timer("Player::Update", &SimulationTimings::player);
+			player_.Update(iam_, frame_time);
 		}
 
-		for(int i=0; i < enemies_.size(); i++)
 		{
-			auto* enemy = enemies_[i];
-			enemy->Update(frame_time);
-			if(enemy->TimeToDie())
+			ScopedSimulationTimer timer("Level::Update static objects", &SimulationTimings::plates);
+			for(int i=0; i < static_game_objects_.size(); i++)
 			{
-				objects_to_destroy_.push_back(enemy);
-				enemies_.erase(enemies_.begin() + i);
+				static_game_objects_[i]->Update(frame_time);
 			}
 		}
-		
-		b2_world_->SetAllowSleeping(true);
+		{
+			ScopedSimulationTimer timer("Scheduler::Update", &SimulationTimings::timers);
+			scheduler_.Update(frame_time);
+		}
 
-		for(auto* object : objects_to_destroy_)
 		{
-			if(object->GetBody() != nullptr)
+			ScopedSimulationTimer timer("Level::Update dynamic objects", &SimulationTimings::dynamic_objects);
+			for(int i = 0; i < dynamic_game_objects_.size(); i++)
 			{
-				b2_world_->DestroyBody(object->GetBody());
+				auto* object = dynamic_game_objects_[i];
+				if(object->IsFrozen())
+					continue;
+				object->Update(frame_time);
+				if(object->TimeToDie())
+				{
+					objects_to_destroy_.push_back(object);
+					dynamic_game_objects_.erase(dynamic_game_objects_.begin() + i);
+				}
 			}
+			loot_.Update(frame_time);
 		}
-		objects_to_destroy_.clear();
 
-		for(auto hud : hud_text_)
 		{
-			hud.second->Update(iam_, frame_time);
+			ScopedSimulationTimer timer("Level::Update enemies", &SimulationTimings::enemies);
+			for(int i=0; i < enemies_.size(); i++)
+			{
+				auto* enemy = enemies_[i];
+				if(enemy->IsFrozen())
+					continue;
+				enemy->Update(frame_time);
+				if(enemy->TimeToDie())
+				{
+					objects_to_destroy_.push_back(enemy);
+					enemies_.erase(enemies_.begin() + i);
+				}
+			}
 		}
 		
-		std::ostringstream ammoOss;
-		if(player_.GetGun()->getReloading())
-		{
-			ammoOss << "Reloading...";
-		}
-		else
 		{
-			ammoOss << "Ammo: " << player_.GetGun()->getAmmoLoaded() << "/" << player_.GetGun()->getAmmoReserve();
+			ScopedSimulationTimer timer("Level::Update cleanup", &SimulationTimings::cleanup);
+			// Bodies are disabled rather than destroyed so a restart can bring them back
+			for(auto* object : objects_to_destroy_)
+			{
+				if(object->GetBody() != nullptr)
+				{
+					object->GetBody()->SetEnabled(false);
+				}
+			}
+			objects_to_destroy_.clear();
 		}
-		hud_text_[Ammo]->UpdateText(ammoOss.str());
 
-		std::ostringstream endOss;
-		if(player_.GetTouchingEnd())
-		{
-			endOss << "Press " << (iam_->getUsingKeyboard() ? "X" : "Circle") << " to repair the hyperdrive!";
-		}
-		else if (player_.GetTouchingNext()) {
-			endOss << "Press " << (iam_->getUsingKeyboard() ? "X" : "Circle") << " to complete level.";
-		}
-		else
-		{
-			ammoOss << "";
-		}
-		hud_text_[EndText]->UpdateText(endOss.str());
+		UpdateHUD(iam_, frame_time);
 
-		std::ostringstream gravOss;
-		if (player_.GetGravityLock())
-		{
-			gravOss << "Gravity Lock ON";
-		}
-		else
 		{
-			gravOss << "";
+			ScopedSimulationTimer timer("Camera::Update", &SimulationTimings::camera);
+			camera_.Update(frame_time, getPlayerPosition());
+
+			if (camera_.GetEffectState() != EffectState::NORMAL && iam_->getInputManager() != nullptr) {
+				const gef::SonyController* controller = iam_->getInputManager()->controller_input()->GetController(0);
+				gef::ControllerOutputData out_data = controller->get_output_data();
+				if (camera_.GetEffectState() == EffectState::SHAKE) out_data.left_rumble = 0.6f;
+				else if (camera_.GetEffectState() != EffectState::WARP)  out_data.right_rumble = 0.6f;
+				controller->set_output_data(out_data);
+			}
 		}
-		hud_text_[GravLock]->UpdateText(gravOss.str());
-
-		camera_.Update(frame_time, getPlayerPosition());
 
-		if (camera_.GetEffectState() != EffectState::NORMAL) {
-			const gef::SonyController* controller = iam_->getInputManager()->controller_input()->GetController(0);
-			gef::ControllerOutputData out_data = controller->get_output_data();
-			if (camera_.GetEffectState() == EffectState::SHAKE) out_data.left_rumble = 0.6f;
-			else if (camera_.GetEffectState() != EffectState::WARP)  out_data.right_rumble = 0.6f;
-			controller->set_output_data(out_data);
-		}
+		SimulationTimings::SetActive(nullptr);
 	}
 	else if(pause_menu_ != nullptr)
 	{
@@ -507,69 +755,131 @@ void Level::Update(InputActionManager* iam_, float frame_time)
 	}
 }
 
+void Level::UpdateHUD(InputActionManager* iam_, float frame_time)
+{
+	ScopedSimulationTimer timer("Level::UpdateHUD", &SimulationTimings::hud);
+
+	HUDString ammo_text;
+	if(player_.GetGun()->getReloading())
+	{
+		ammo_text << "Reloading...";
+	}
+	else
+	{
+		ammo_text << "Ammo: " << player_.GetGun()->getAmmoLoaded() << "/" << player_.GetGun()->getAmmoReserve();
+	}
+	hud_.SetText(Ammo, ammo_text.c_str());
+
+	HUDString end_text;
+	if(player_.GetTouchingEnd())
+	{
+		end_text << "Press " << (iam_->getUsingKeyboard() ? "X" : "Circle") << " to repair the hyperdrive!";
+	}
+	else if (player_.GetTouchingNext()) {
+		end_text << "Press " << (iam_->getUsingKeyboard() ? "X" : "Circle") << " to complete level.";
+	}
+	hud_.SetText(EndText, end_text.c_str());
+
+	hud_.SetText(GravLock, player_.GetGravityLock() ? "Gravity Lock ON" : "");
+	hud_.SetVisibleIcons(player_.GetHealth());
+}
+
 void Level::Render(gef::Renderer3D* renderer_3d)
 {
 }
 
-void Level::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void Level::Render(Overlay& overlay)
+{
+}
+
+void Level::Render(gef::Renderer3D* renderer_3d, Overlay& overlay)
 {
+	PROFILE_ZONE("Level::Render");
+
+	BuildSnapshot(snapshot_);
+	snapshot_.Submit(renderer_3d, overlay);
+	if(is_paused_ && pause_menu_ != nullptr)
+	{
+		pause_menu_->Render(renderer_3d, overlay);
+	}
 }
 
-void Level::Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void Level::BuildSnapshot(RenderSnapshot& snapshot) const
 {
+	PROFILE_ZONE("Level::BuildSnapshot");
+
 	// projection
 	float fov = gef::DegToRad(45.0f);
 	float aspect_ratio = (float)platform_->width() / (float)platform_->height();
 	gef::Matrix44 projection_matrix;
 	projection_matrix = platform_->PerspectiveProjectionFov(fov, aspect_ratio, 0.1f, 100.0f);
-	renderer_3d->set_projection_matrix(projection_matrix);
-	
-	// view
-	renderer_3d->set_view_matrix(camera_.GetViewMatrix());
-	
-	renderer_3d->Begin();
-		renderer_3d->DrawMesh(*camera_.GetBackground());
-		for (const gef::MeshInstance* object : background_objects_)
-		{
-			renderer_3d->DrawMesh(*object);
-		}
-		for(const GameObject* object : static_game_objects_)
-		{
-			object->Render(renderer_3d);
-		}
-		for(const std::pair<const int, Door*> object : door_objects_)
-		{
-			object.second->Render(renderer_3d);
-		}
-		renderer_3d->set_override_material(NULL);
-		for(const GameObject* object : dynamic_game_objects_)
-		{
-			object->Render(renderer_3d);
-		}
-		player_.Render(renderer_3d);
-		for(const Enemy* enemy : enemies_)
-		{
-			enemy->Render(renderer_3d);
-		}
 
-	renderer_3d->End();
-	
-	// start drawing sprites, but don't clear the frame buffer
-	sprite_renderer->Begin(false);
-		for(auto hud : hud_text_)
+	snapshot.Begin(projection_matrix, camera_.GetViewMatrix());
+	snapshot.DrawMesh(*camera_.GetBackground());
+	for (const LodMeshInstance* object : background_objects_)
+	{
+		snapshot.DrawMesh(*object, object->GetMeshLods());
+	}
+	for(const GameObject* object : static_game_objects_)
+	{
+		object->Render(snapshot);
+	}
+	for(const std::pair<const int, Door*> object : door_objects_)
+	{
+		object.second->Render(snapshot);
+	}
+	snapshot.SetOverrideMaterial(NULL);
+	for(const GameObject* object : dynamic_game_objects_)
+	{
+		object->Render(snapshot);
+	}
+	loot_.Render(snapshot);
+	player_.Render(snapshot);
+	for(const Enemy* enemy : enemies_)
+	{
+		enemy->Render(snapshot);
+	}
+
+	hud_.Render(snapshot);
+}
+
+uint32_t Level::GetStateChecksum() const
+{
+	// FNV-1a over the state a replay should reproduce exactly
+	uint32_t hash = 2166136261u;
+	auto mix = [&hash](const void* data, size_t size)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for(size_t i = 0; i < size; i++)
 		{
-			hud.second->Render(sprite_renderer, font);
+			hash ^= bytes[i];
+			hash *= 16777619u;
 		}
-		if (!healthbar_.empty()) {
-			for (int i = 0; i < player_.GetHealth(); i++) {
-				healthbar_[i].Render(sprite_renderer, font);
-			}
-		}
-	sprite_renderer->End();
-	if(is_paused_ && pause_menu_ != nullptr)
+	};
+	auto mix_body = [&mix](const b2Body* body)
+	{
+		const b2Vec2 position = body->GetPosition();
+		const b2Vec2 velocity = body->GetLinearVelocity();
+		mix(&position, sizeof(position));
+		mix(&velocity, sizeof(velocity));
+	};
+
+	mix_body(player_.GetBody());
+	const int player_state[] = { player_.GetHealth(), player_.GetGun()->getAmmoLoaded(), player_.GetGun()->getAmmoReserve(), (int)end_state_, (int)enemies_.size(), (int)dynamic_game_objects_.size(), loot_.GetActiveCount() };
+	mix(player_state, sizeof(player_state));
+	for(const Enemy* enemy : enemies_)
+	{
+		mix_body(enemy->GetBody());
+	}
+	for(const GameObject* object : dynamic_game_objects_)
+	{
+		mix_body(object->GetBody());
+	}
+	for(const Pickup* pickup : loot_.GetActive())
 	{
-		pause_menu_->Render(renderer_3d, sprite_renderer, font);
+		mix_body(pickup->GetBody());
 	}
+	return hash;
 }
 
 gef::Vector2 Level::getPlayerPosition() const
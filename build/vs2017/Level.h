@@ -1,16 +1,26 @@
 ﻿#pragma once
 #include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
+#include "ChunkStreamer.h"
 #include "CollisionManager.h"
+#include "ContactGraph.h"
 #include "Player.h"
+#include "Random.h"
+#include "RenderSnapshot.h"
+#include "Scheduler.h"
 #include "Scene.h"
 #include "SpriteAnimator3D.h"
 #include "Camera.h"
 #include "graphics/scene.h"
 #include "Door.h"
-#include "Image.h"
+#include "GravityField.h"
+#include "HUD.h"
+#include "LootPool.h"
 #include "obj_mesh_loader.h"
 
+class LoadContext;
 class Menu;
 class Text;
 class Enemy;
@@ -22,25 +32,29 @@ namespace gef
 {
 	class Platform;
 	class Renderer3D;
-	class Font;
-	class SpriteRenderer;
 }
 
 class b2World;
 class PrimitiveBuilder;
 class Gun;
+struct SimulationTimings;
 
 class Level : public Scene
 {
 public:
-	Level(gef::Platform& platform, gef::SpriteRenderer* sr, gef::Font* font, StateManager& state_manager, gef::AudioManager* am) : Scene(platform, state_manager), audio_manager_(am), sprite_renderer_(sr), font_(font) {}
+	Level(gef::Platform& platform, StateManager& state_manager, AudioSystem* am) : Scene(platform, state_manager), audio_manager_(am), random_(Random::NextSeed()) {}
 	~Level();
-	void LoadFromFile(const char* filename, LoadingScreen* loading_screen, OBJMeshLoader& obj_loader);
+	void LoadFromFile(const char* filename, LoadContext& context, OBJMeshLoader& obj_loader);
 	void CleanUp();
 	void Update(InputActionManager* iam_,float frame_time) override;
 	void Render(gef::Renderer3D* renderer_3d) override;
-	void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) override;
-	void Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font) override;
+	void Render(Overlay& overlay) override;
+	void Render(gef::Renderer3D* renderer_3d, Overlay& overlay) override;
+	// Copies out what the frame draws, so it can be rendered while the next frame is simulated
+	void BuildSnapshot(RenderSnapshot& snapshot) const;
+	bool IsPaused() const { return is_paused_; }
+	// Starting the prefetch, the end of level menu and the pause menu's buttons all change scenes
+	bool NeedsMainThread() const override { return is_paused_ || end_state_ != NONE || (!next_level_prefetched_ && obj_loader_ != nullptr); }
 	void SetPauseMenu(Menu* pause_menu) {pause_menu_ = pause_menu;}
 	void Pause() {is_paused_ = true;}
 	void Unpause() {is_paused_ = false;}
@@ -50,9 +64,30 @@ public:
 	std::vector<GameObject*>& getBodiesToDestroy() {return objects_to_destroy_;}
 	void SetEndState(EndState end_state) { end_state_ = end_state; }
 	const char* GetFileName() const;
+	bool Restart();
+	uint32_t GetStateChecksum() const;
+	EndState GetEndState() const { return end_state_; }
+	int GetBroadphaseProxyCount() const;
+	// Contact callbacks box2d made during the last step
+	int GetContactCallbackCount() const { return collision_manager_.GetCallbackCount(); }
+	int GetContactCount() const;
+	// Proxies box2d had to move in its tree over the last frame, by the body moving out of its fattened
+	// bounds or being teleported. Only counted while timings are attached
+	int GetBroadphaseMoveCount() const { return broadphase_moves_; }
+	Scheduler& GetScheduler() { return scheduler_; }
+	GravityField& GetGravityField() { return gravity_field_; }
+	// Dynamic bodies box2d is simulating rather than leaving asleep
+	int GetAwakeBodyCount() const;
+	void SetTimings(SimulationTimings* timings) { timings_ = timings; }
+	// Everything random in the level comes from here, so levels can be simulated side by side.
+	// Seeded from the shared sequence, set it before loading for a level of its own
+	void SetRandomSeed(uint32_t seed) { random_.Seed(seed); }
+	RandomStream& GetRandom() { return random_; }
 
 private:
 	void LoadObject(auto obj, MeshResource mr, OBJMeshLoader& obj_loader, gef::Vector4& scale);
+	// Empty after the last level
+	std::string GetNextLevelFileName() const;
 
 	enum HudElement
 	{
@@ -61,36 +96,74 @@ private:
 		GravLock
 	};
 	void Init();
-	b2World* b2_world_;
-	PrimitiveBuilder* primitive_builder_;
+	void SaveInitialState();
+	void UpdateHUD(InputActionManager* iam_, float frame_time);
+	void CountBroadphaseMoves();
+
+	// Everything a restart needs to put the level back to how it was after loading
+	struct BodySnapshot
+	{
+		b2Body* body;
+		b2Vec2 position;
+		float angle;
+		b2Vec2 linear_velocity;
+		float angular_velocity;
+		float gravity_scale;
+		bool awake;
+		bool enabled;
+	};
+	struct InitialState
+	{
+		bool captured = false;
+		b2Vec2 gravity;
+		std::vector<BodySnapshot> bodies;
+		std::vector<GameObject*> dynamic_game_objects;
+		std::vector<Enemy*> enemies;
+		Camera camera;
+	};
+
+	b2World* b2_world_ = nullptr;
+	PrimitiveBuilder* primitive_builder_ = nullptr;
 	
 	Camera camera_;
 
 	//Objects
 	std::vector<GameObject*> static_game_objects_;
 	std::vector<GameObject*> dynamic_game_objects_;
-	std::vector<gef::MeshInstance*> background_objects_;
+	std::vector<LodMeshInstance*> background_objects_;
 	std::unordered_map<int, Door*> door_objects_;
 	Player player_;
 	std::vector<Enemy*> enemies_;
 
 	//Scene loading etc
-	SpriteAnimator3D* sprite_animator3D_;
+	SpriteAnimator3D* sprite_animator3D_ = nullptr;
 	gef::Scene scene_loader_;
 	EndState end_state_ = NONE;
 	std::vector<GameObject*> objects_to_destroy_;
+	InitialState initial_state_;
 	CollisionManager collision_manager_;
-	const char* file_name_ = nullptr;
+	ContactGraph contact_graph_;
+	ChunkStreamer chunk_streamer_;
+	GravityField gravity_field_;
+	RandomStream random_;
+	LootPool loot_;
+	Scheduler scheduler_;
+	std::string file_name_;
 	OBJMeshLoader* obj_loader_ = nullptr;
+	bool next_level_prefetched_ = false;
 
 	//HUD
-	std::map<HudElement, Text*> hud_text_;
-	std::vector<Image> healthbar_;
-	gef::SpriteRenderer* sprite_renderer_ = nullptr;
-	gef::Font* font_ = nullptr;
+	HUD hud_;
+	RenderSnapshot snapshot_;
 	Menu* pause_menu_ = nullptr;
 	bool is_paused_ = false;
 
 	//Audio
-	gef::AudioManager* audio_manager_ = nullptr;
+	AudioSystem* audio_manager_ = nullptr;
+
+	SimulationTimings* timings_ = nullptr;
+	// Each proxy's fattened bounds when last counted, by proxy id
+	std::vector<b2AABB> proxy_bounds_;
+	std::vector<int32> proxy_ids_;
+	int broadphase_moves_ = 0;
 };
@@ -0,0 +1,372 @@
+#include "LoaderService.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+#include "system/debug_log.h"
+
+namespace
+{
+	thread_local LoadContext* current_context = nullptr;
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void LogTimings(const std::string& name, LoadStatus status, const std::vector<LoadStageTiming>& timings)
+	{
+		double total = 0.0;
+		std::string stages;
+		for(const LoadStageTiming& timing : timings)
+		{
+			total += timing.seconds;
+			stages += "  " + std::string(timing.stage) + " " + std::to_string(timing.seconds * 1000.0) + " ms\n";
+		}
+
+		const char* outcome = status == LoadStatus::Completed ? "Loaded" : status == LoadStatus::Cancelled ? "Cancelled" : "Failed";
+		gef::DebugOut((std::string(outcome) + " " + name + " after " + std::to_string(total * 1000.0) + " ms\n" + stages).c_str());
+	}
+}
+
+LoadContext* LoadContext::Current()
+{
+	return current_context;
+}
+
+void LoadContext::SetCurrent(LoadContext* context)
+{
+	current_context = context;
+}
+
+void LoadContext::RunGPUUpload(const std::function<void()>& upload, size_t bytes)
+{
+	if(current_context != nullptr)
+	{
+		current_context->AddStagedBytes(bytes);
+		current_context->RunOnMainThread(upload);
+	}
+	else
+	{
+		upload();
+	}
+}
+
+ImmediateLoadContext::ImmediateLoadContext()
+	: previous_(Current())
+{
+	SetCurrent(this);
+}
+
+ImmediateLoadContext::~ImmediateLoadContext()
+{
+	SetCurrent(previous_);
+}
+
+void ImmediateLoadContext::Stage(const char* name)
+{
+	Finish();
+	stage_ = name;
+	stage_start_ = std::chrono::steady_clock::now();
+}
+
+const std::vector<LoadStageTiming>& ImmediateLoadContext::Finish()
+{
+	if(stage_ != nullptr)
+	{
+		stage_timings_.push_back({ stage_, SecondsSince(stage_start_) });
+		stage_ = nullptr;
+	}
+	return stage_timings_;
+}
+
+// Context handed to a job running on the worker thread
+class LoaderService::TaskContext : public LoadContext
+{
+public:
+	TaskContext(LoaderService& service, const std::shared_ptr<LoadTask>& task)
+		: service_(service), task_(task)
+	{
+		SetCurrent(this);
+	}
+
+	~TaskContext()
+	{
+		SetCurrent(nullptr);
+	}
+
+	void Stage(const char* name) override
+	{
+		if(IsCancelled())
+			throw LoadCancelled();
+
+		EndStage();
+		stage_ = name;
+		stage_start_ = std::chrono::steady_clock::now();
+
+		LoadEvent event;
+		event.type = LoadEvent::Type::StageStarted;
+		event.stage = name;
+		service_.PostEvent(task_, std::move(event));
+	}
+
+	bool IsCancelled() const override
+	{
+		return task_->cancel_requested_;
+	}
+
+	void RunOnMainThread(const std::function<void()>& job) override
+	{
+		service_.PostToMainThread(job);
+	}
+
+	void AddStagedBytes(size_t bytes) override
+	{
+		const size_t staged = task_->staged_bytes_ += bytes;
+		if(task_->priority_ == LoadPriority::Background && task_->memory_budget_ != 0 && staged > task_->memory_budget_)
+			throw LoadBudgetExceeded();
+	}
+
+	void EndStage()
+	{
+		if(stage_ != nullptr)
+		{
+			task_->stage_timings_.push_back({ stage_, SecondsSince(stage_start_) });
+			stage_ = nullptr;
+		}
+	}
+
+private:
+	LoaderService& service_;
+	std::shared_ptr<LoadTask> task_;
+	const char* stage_ = nullptr;
+	std::chrono::steady_clock::time_point stage_start_;
+};
+
+LoaderService::LoaderService()
+	: main_thread_id_(std::this_thread::get_id())
+{
+	worker_ = std::thread(&LoaderService::WorkerLoop, this);
+}
+
+LoaderService::~LoaderService()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		if(current_task_ != nullptr)
+		{
+			current_task_->Cancel();
+		}
+		for(auto& task : tasks_)
+		{
+			task->Cancel();
+		}
+	}
+	worker_wake_.notify_all();
+
+	// A running load may be waiting on main thread work, keep serving it until the worker is done
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(running_task_ || !tasks_.empty())
+	{
+		lock.unlock();
+		if(!RunMainThreadJob())
+		{
+			lock.lock();
+			main_wake_.wait_for(lock, std::chrono::milliseconds(1));
+			continue;
+		}
+		lock.lock();
+	}
+	lock.unlock();
+	worker_.join();
+}
+
+std::shared_ptr<LoadTask> LoaderService::Submit(const std::string& name, Job job, EventHandler on_event,
+	LoadPriority priority, size_t memory_budget)
+{
+	auto task = std::make_shared<LoadTask>();
+	task->name_ = name;
+	task->priority_ = priority;
+	task->memory_budget_ = memory_budget;
+	task->job_ = std::move(job);
+	task->on_event_ = std::move(on_event);
+	task->future_ = task->promise_.get_future().share();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push_back(task);
+	}
+	worker_wake_.notify_one();
+	return task;
+}
+
+bool LoaderService::IsBusy() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return running_task_ || !tasks_.empty();
+}
+
+void LoaderService::Update()
+{
+	PROFILE_ZONE("LoaderService::Update");
+
+	// A background load only gets what's already waiting, up to its smaller budget, so it
+	// doesn't eat into the frame of whatever is being played
+	bool background = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		background = current_task_ != nullptr && current_task_->priority_ == LoadPriority::Background;
+	}
+
+	// The worker posts its next upload soon after the last one, so wait for it rather than leave
+	// it for next frame, as long as there's budget left
+	const float budget = background ? background_budget_ : main_thread_budget_;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<float>(budget);
+	while(true)
+	{
+		if(RunMainThreadJob())
+		{
+			if(std::chrono::steady_clock::now() >= deadline)
+				break;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		if(background || !running_task_ || std::chrono::steady_clock::now() >= deadline)
+			break;
+		main_wake_.wait_until(lock, deadline, [this] { return !main_thread_jobs_.empty() || !running_task_; });
+		if(main_thread_jobs_.empty())
+			break;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		delivering_.swap(events_);
+	}
+	for(PendingEvent& pending : delivering_)
+	{
+		if(pending.event.type == LoadEvent::Type::Finished)
+		{
+			LogTimings(pending.task->name_, pending.event.status, pending.task->stage_timings_);
+		}
+		if(pending.task->on_event_)
+		{
+			pending.task->on_event_(pending.event);
+		}
+	}
+	delivering_.clear();
+}
+
+void LoaderService::WorkerLoop()
+{
+	Profiler::SetThreadName("Loading");
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(true)
+	{
+		worker_wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+		if(tasks_.empty())
+			break;
+
+		// Anything at normal priority goes ahead of queued background loads
+		auto next = std::find_if(tasks_.begin(), tasks_.end(), [](const std::shared_ptr<LoadTask>& queued)
+			{ return queued->priority_ == LoadPriority::Normal; });
+		if(next == tasks_.end())
+			next = tasks_.begin();
+		std::shared_ptr<LoadTask> task = *next;
+		tasks_.erase(next);
+		current_task_ = task;
+		running_task_ = true;
+		lock.unlock();
+
+		Run(task);
+
+		lock.lock();
+		current_task_.reset();
+		running_task_ = false;
+		main_wake_.notify_all();
+	}
+}
+
+void LoaderService::Run(const std::shared_ptr<LoadTask>& task)
+{
+	PROFILE_ZONE("LoaderService::Run");
+
+	LoadEvent finished;
+	finished.type = LoadEvent::Type::Finished;
+	finished.status = LoadStatus::Completed;
+
+	{
+		TaskContext context(*this, task);
+		try
+		{
+			if(task->cancel_requested_)
+				throw LoadCancelled();
+			task->job_(context);
+		}
+		catch(const LoadCancelled&)
+		{
+			finished.status = LoadStatus::Cancelled;
+		}
+		catch(const std::exception& e)
+		{
+			finished.status = LoadStatus::Failed;
+			finished.error = e.what();
+		}
+		context.EndStage();
+	}
+
+	task->status_ = finished.status;
+	task->promise_.set_value(finished.status);
+	PostEvent(task, std::move(finished));
+}
+
+void LoaderService::PostEvent(const std::shared_ptr<LoadTask>& task, LoadEvent event)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	events_.push_back({ task, std::move(event) });
+}
+
+void LoaderService::PostToMainThread(const std::function<void()>& job)
+{
+	if(std::this_thread::get_id() == main_thread_id_)
+	{
+		job();
+		return;
+	}
+
+	std::future<void> done;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		main_thread_jobs_.push_back({ job, std::promise<void>() });
+		done = main_thread_jobs_.back().done.get_future();
+	}
+	main_wake_.notify_all();
+
+	// Rethrows anything the job threw
+	done.get();
+}
+
+bool LoaderService::RunMainThreadJob()
+{
+	MainThreadJob job;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if(main_thread_jobs_.empty())
+			return false;
+		job = std::move(main_thread_jobs_.front());
+		main_thread_jobs_.pop_front();
+	}
+
+	try
+	{
+		job.job();
+		job.done.set_value();
+	}
+	catch(...)
+	{
+		job.done.set_exception(std::current_exception());
+	}
+	return true;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Thrown out of a load by LoadContext::Stage once the load has been cancelled
+class LoadCancelled : public std::runtime_error
+{
+public:
+	LoadCancelled() : std::runtime_error("load cancelled") {}
+};
+
+// Thrown out of a background load once it has staged more than its memory budget
+class LoadBudgetExceeded : public std::runtime_error
+{
+public:
+	LoadBudgetExceeded() : std::runtime_error("load went over its memory budget") {}
+};
+
+enum class LoadStatus { Pending, Completed, Cancelled, Failed };
+
+// Background loads run behind anything else queued, get a smaller share of the main thread
+// and are held to their memory budget
+enum class LoadPriority { Normal, Background };
+
+// Time spent in one named stage of a load
+struct LoadStageTiming
+{
+	const char* stage;
+	double seconds;
+};
+
+// Progress of a load, always delivered on the main thread
+struct LoadEvent
+{
+	enum class Type { StageStarted, Finished };
+
+	Type type;
+	const char* stage = nullptr;				// StageStarted
+	LoadStatus status = LoadStatus::Pending;	// Finished
+	std::string error;							// Finished with LoadStatus::Failed
+};
+
+// What a load job sees of whoever is running it
+class LoadContext
+{
+public:
+	virtual ~LoadContext() = default;
+
+	// Starts the next named stage of the load. Throws LoadCancelled if the load has been cancelled
+	virtual void Stage(const char* name) = 0;
+	virtual bool IsCancelled() const = 0;
+
+	// Runs job on the main thread and waits for it to finish
+	virtual void RunOnMainThread(const std::function<void()>& job) = 0;
+
+	// Counts memory the load has created towards its budget
+	virtual void AddStagedBytes(size_t bytes) = 0;
+
+	// Context of the load running on the calling thread, nullptr outside of loads
+	static LoadContext* Current();
+
+	// For steps that create GPU resources: posted to the main thread when called from a load,
+	// run straight away otherwise. bytes is roughly what the resource will take up
+	static void RunGPUUpload(const std::function<void()>& upload, size_t bytes = 0);
+
+protected:
+	static void SetCurrent(LoadContext* context);
+};
+
+// Runs a load inline on the calling thread, for tools like the headless benchmark
+class ImmediateLoadContext : public LoadContext
+{
+public:
+	ImmediateLoadContext();
+	~ImmediateLoadContext();
+
+	void Stage(const char* name) override;
+	bool IsCancelled() const override { return false; }
+	void RunOnMainThread(const std::function<void()>& job) override { job(); }
+	void AddStagedBytes(size_t bytes) override { staged_bytes_ += bytes; }
+
+	// Closes the last stage and returns every stage's timing
+	const std::vector<LoadStageTiming>& Finish();
+	size_t GetStagedBytes() const { return staged_bytes_; }
+
+private:
+	LoadContext* previous_ = nullptr;
+	size_t staged_bytes_ = 0;
+	std::vector<LoadStageTiming> stage_timings_;
+	const char* stage_ = nullptr;
+	std::chrono::steady_clock::time_point stage_start_;
+};
+
+// Handle to a load submitted to the LoaderService
+class LoadTask
+{
+public:
+	const std::string& GetName() const { return name_; }
+	LoadStatus GetStatus() const { return status_; }
+	bool IsDone() const { return status_ != LoadStatus::Pending; }
+	LoadPriority GetPriority() const { return priority_; }
+	size_t GetStagedBytes() const { return staged_bytes_; }
+
+	// Raises a background load to normal priority, lifting its memory budget
+	void Promote() { priority_ = LoadPriority::Normal; }
+
+	// Asks the load to stop at its next stage boundary
+	void Cancel() { cancel_requested_ = true; }
+	bool IsCancelRequested() const { return cancel_requested_; }
+
+	// Becomes ready when the job has finished, whether or not the main thread has seen it yet
+	std::shared_future<LoadStatus> GetFuture() const { return future_; }
+
+	// Only complete once the task is done
+	const std::vector<LoadStageTiming>& GetStageTimings() const { return stage_timings_; }
+
+private:
+	friend class LoaderService;
+
+	std::string name_;
+	std::function<void(LoadContext&)> job_;
+	std::function<void(const LoadEvent&)> on_event_;
+	std::atomic<bool> cancel_requested_ = false;
+	std::atomic<LoadStatus> status_ = LoadStatus::Pending;
+	std::atomic<LoadPriority> priority_ = LoadPriority::Normal;
+	size_t memory_budget_ = 0;
+	std::atomic<size_t> staged_bytes_ = 0;
+	std::promise<LoadStatus> promise_;
+	std::shared_future<LoadStatus> future_;
+	std::vector<LoadStageTiming> stage_timings_;
+};
+
+// Runs loads one at a time on a background thread.
+// Progress events and completion are handed to the main thread in Update, and work that has
+// to happen on the main thread (creating GPU resources) is posted back to it and run there too
+class LoaderService
+{
+public:
+	using Job = std::function<void(LoadContext&)>;
+	using EventHandler = std::function<void(const LoadEvent&)>;
+
+	// Must be created on the main thread
+	LoaderService();
+	~LoaderService();
+	LoaderService(const LoaderService&) = delete;
+	LoaderService& operator=(const LoaderService&) = delete;
+
+	// memory_budget is in bytes and only applies to background loads, 0 for no limit
+	std::shared_ptr<LoadTask> Submit(const std::string& name, Job job, EventHandler on_event,
+		LoadPriority priority = LoadPriority::Normal, size_t memory_budget = 0);
+
+	// Call once per frame on the main thread. While a load is running this spends up to
+	// the main thread budget on its posted work, then delivers any events
+	void Update();
+
+	void SetMainThreadBudget(float seconds) { main_thread_budget_ = seconds; }
+	void SetBackgroundBudget(float seconds) { background_budget_ = seconds; }
+	bool IsBusy() const;
+
+private:
+	class TaskContext;
+
+	struct MainThreadJob
+	{
+		std::function<void()> job;
+		std::promise<void> done;
+	};
+
+	struct PendingEvent
+	{
+		std::shared_ptr<LoadTask> task;
+		LoadEvent event;
+	};
+
+	void WorkerLoop();
+	void Run(const std::shared_ptr<LoadTask>& task);
+	void PostEvent(const std::shared_ptr<LoadTask>& task, LoadEvent event);
+	void PostToMainThread(const std::function<void()>& job);
+	bool RunMainThreadJob();
+
+	std::thread::id main_thread_id_;
+	std::thread worker_;
+	float main_thread_budget_ = 0.008f;
+	float background_budget_ = 0.001f;
+
+	mutable std::mutex mutex_;
+	std::condition_variable worker_wake_;
+	std::condition_variable main_wake_;
+	std::deque<std::shared_ptr<LoadTask>> tasks_;
+	std::deque<MainThreadJob> main_thread_jobs_;
+	std::vector<PendingEvent> events_;
+	std::vector<PendingEvent> delivering_;
+	std::shared_ptr<LoadTask> current_task_;
+	bool running_task_ = false;
+	bool stopping_ = false;
+};
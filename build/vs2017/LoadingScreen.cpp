@@ -1,7 +1,6 @@
 ﻿#include "LoadingScreen.h"
 
-#include "graphics/font.h"
-#include "graphics/sprite_renderer.h"
+#include "Overlay.h"
 #include "system/platform.h"
 
 void LoadingScreen::SetStatusText(const char* text)
@@ -38,10 +37,9 @@ void LoadingScreen::Update(InputActionManager* iam, float frame_time)
 	}
 }
 
-void LoadingScreen::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void LoadingScreen::Render(Overlay& overlay)
 {
-	sprite_renderer->Begin(true);
-	sprite_renderer->DrawSprite(sprite_);
-	font->RenderText(sprite_renderer, gef::Vector4(platform_->width() / 2.f, platform_->height() / 2.f + 100.f, -0.9f), 1.0f, 0xffffffff, gef::TJ_CENTRE, status_text_);
-	sprite_renderer->End();
+	overlay.Clear();
+	overlay.DrawSprite(sprite_);
+	overlay.DrawText(gef::Vector4(platform_->width() / 2.f, platform_->height() / 2.f + 100.f, -0.9f), 1.0f, 0xffffffff, gef::TJ_CENTRE, status_text_);
 }
@@ -18,8 +18,8 @@ class LoadingScreen : public Scene
 		void SetStatusText(const char* text);
     	void Update(InputActionManager* iam, float frame_time) override;
     	void Render(gef::Renderer3D* renderer_3d) override {}
-    	void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) override;
-    	void Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font) override {Render(sprite_renderer, font);}
+    	void Render(Overlay& overlay) override;
+    	void Render(gef::Renderer3D* renderer_3d, Overlay& overlay) override {Render(overlay);}
     private:
 		const char* status_text_{};
 		gef::Sprite sprite_;
@@ -0,0 +1,133 @@
+#include "LootPool.h"
+
+#include <algorithm>
+#include "Random.h"
+#include "RenderSnapshot.h"
+#include "SpriteAnimator3D.h"
+#include "graphics/material.h"
+#include "graphics/texture.h"
+
+LootPool::~LootPool()
+{
+	Clear();
+}
+
+void LootPool::Init(b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, RandomStream& random)
+{
+	world_ = world;
+	audio_manager_ = am;
+	random_ = &random;
+	LoadMesh(health_mesh_, "Pickups/Health/health.png", sprite_animator);
+	LoadMesh(max_ammo_mesh_, "Pickups/MaxAmmo/Bullet.png", sprite_animator);
+}
+
+void LootPool::Drop(const b2Vec2& position)
+{
+	// Both rolls are made either way, so what drops later doesn't depend on what dropped before
+	const bool drops = random_->Float() < drop_probability_;
+	const bool health = random_->Float() < 0.5f;
+	if(!drops)
+		return;
+
+	if(pickups_.empty())
+		Allocate();
+
+	Pickup* pickup;
+	if(!free_.empty())
+	{
+		pickup = free_.back();
+		free_.pop_back();
+	}
+	else
+	{
+		pickup = active_.front();
+		active_.erase(active_.begin());
+	}
+	active_.push_back(pickup);
+
+	if(health)
+		pickup->Spawn(Pickup::Type::Health, health_mesh_.mesh, position);
+	else
+		pickup->Spawn(Pickup::Type::MaxAmmo, max_ammo_mesh_.mesh, position);
+}
+
+void LootPool::Update(float frame_time)
+{
+	for(size_t i = 0; i < active_.size();)
+	{
+		Pickup* pickup = active_[i];
+		if(pickup->TimeToDie())
+		{
+			pickup->Despawn();
+			free_.push_back(pickup);
+			active_.erase(active_.begin() + i);
+			continue;
+		}
+		pickup->Update(frame_time);
+		i++;
+	}
+}
+
+void LootPool::Render(RenderSnapshot& snapshot) const
+{
+	for(const Pickup* pickup : active_)
+	{
+		pickup->Render(snapshot);
+	}
+}
+
+void LootPool::Reset()
+{
+	for(Pickup* pickup : active_)
+	{
+		pickup->Despawn();
+		free_.push_back(pickup);
+	}
+	active_.clear();
+}
+
+void LootPool::Clear()
+{
+	// Bodies go with the world
+	for(Pickup* pickup : pickups_)
+	{
+		delete pickup;
+	}
+	pickups_.clear();
+	free_.clear();
+	active_.clear();
+
+	FreeMesh(health_mesh_);
+	FreeMesh(max_ammo_mesh_);
+}
+
+void LootPool::Allocate()
+{
+	pickups_.reserve(kCapacity);
+	free_.reserve(kCapacity);
+	active_.reserve(kCapacity);
+	for(int i = 0; i < kCapacity; i++)
+	{
+		Pickup* pickup = new Pickup();
+		pickup->Init(world_, audio_manager_);
+		pickups_.push_back(pickup);
+	}
+	// Handed out in order
+	free_.assign(pickups_.rbegin(), pickups_.rend());
+}
+
+void LootPool::LoadMesh(SharedMesh& shared, const char* filepath, SpriteAnimator3D* sprite_animator)
+{
+	shared.texture = SpriteAnimator3D::CreateTexture(filepath, sprite_animator->GetPlatform());
+	shared.material = new gef::Material();
+	shared.material->set_texture(shared.texture);
+	shared.mesh = sprite_animator->GetPrimitiveBuilder()->CreatePlaneMesh(gef::Vector4(0.5, 0.5, 1), gef::Vector4(0, 0, 0), &shared.material);
+}
+
+void LootPool::FreeMesh(SharedMesh& shared)
+{
+	delete shared.mesh;
+	delete shared.material;
+	delete shared.texture;
+	shared = SharedMesh();
+}
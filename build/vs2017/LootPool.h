@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include "Pickup.h"
+
+class RandomStream;
+class RenderSnapshot;
+class SpriteAnimator3D;
+
+namespace gef
+{
+	class Material;
+	class Mesh;
+	class Texture;
+}
+
+// What enemies drop, rolled for when they die. Pickups come from a fixed set made the first time
+// anything drops and share one mesh per type, so living enemies carry nothing extra and loading
+// a level makes no pickups at all
+class LootPool
+{
+public:
+	static constexpr int kCapacity = 8;
+
+	~LootPool();
+	// Loads the shared meshes, rolls come from random
+	void Init(b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, RandomStream& random);
+	// An enemy died at position. With every pickup out the oldest is taken back
+	void Drop(const b2Vec2& position);
+	void Update(float frame_time);
+	void Render(RenderSnapshot& snapshot) const;
+	// Takes every pickup back, for a restart
+	void Reset();
+	void Clear();
+
+	int GetActiveCount() const { return (int)active_.size(); }
+	const std::vector<Pickup*>& GetActive() const { return active_; }
+
+private:
+	// A pickup type's look, owned here with everything it's made of
+	struct SharedMesh
+	{
+		gef::Texture* texture = nullptr;
+		gef::Material* material = nullptr;
+		gef::Mesh* mesh = nullptr;
+	};
+
+	void Allocate();
+	static void LoadMesh(SharedMesh& shared, const char* filepath, SpriteAnimator3D* sprite_animator);
+	static void FreeMesh(SharedMesh& shared);
+
+	float drop_probability_ = 0.5f;
+
+	b2World* world_ = nullptr;
+	AudioSystem* audio_manager_ = nullptr;
+	RandomStream* random_ = nullptr;
+	SharedMesh health_mesh_;
+	SharedMesh max_ammo_mesh_;
+
+	std::vector<Pickup*> pickups_;
+	std::vector<Pickup*> free_;
+	// Oldest first
+	std::vector<Pickup*> active_;
+};
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(data == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	file_ = file;
+	mapping_ = mapping;
+	data_ = static_cast<const uint8_t*>(data);
+	size_ = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data_ != nullptr)
+		UnmapViewOfFile(data_);
+	if(mapping_ != nullptr)
+		CloseHandle(mapping_);
+	if(file_ != nullptr)
+		CloseHandle(file_);
+
+	data_ = nullptr;
+	size_ = 0;
+	mapping_ = nullptr;
+	file_ = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+	const int file = open(filename, O_RDONLY);
+	if(file < 0)
+		return false;
+
+	struct stat info;
+	if(fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps the file alive on its own
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if(data == MAP_FAILED)
+		return false;
+
+	data_ = static_cast<const uint8_t*>(data);
+	size_ = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data_ != nullptr)
+		munmap(const_cast<uint8_t*>(data_), size_);
+
+	data_ = nullptr;
+	size_ = 0;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Read only view of a whole file mapped into memory, which stays valid until Close
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Fails for files that are missing or empty
+	bool Open(const char* filename);
+	void Close();
+
+	bool IsOpen() const { return data_ != nullptr; }
+	const uint8_t* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+
+private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+};
@@ -1,8 +1,8 @@
 ﻿#include "Menu.h"
 
 #include "InputActionManager.h"
+#include "Overlay.h"
 #include "UIElement.h"
-#include "graphics/sprite_renderer.h"
 
 void Menu::AddUIElement(UIElement* element)
 {
@@ -61,15 +61,19 @@ void Menu::Update(InputActionManager* iam, float frame_time)
 	}
 }
 
-void Menu::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void Menu::Render(Overlay& overlay)
 {
+	// A HUD menu draws over the level, anything else has the screen to itself
+	if(!is_hud_)
+	{
+		overlay.Clear();
+	}
+
 	// Render UI Elements
-	sprite_renderer->Begin(!is_hud_);
 	for (auto& element : ui_elements_)
 	{
-		element->Render(sprite_renderer, font);
+		element->Render(overlay);
 	}
-	sprite_renderer->End();
 }
 
 void Menu::SetAlpha(float alpha)
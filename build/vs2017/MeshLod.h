@@ -0,0 +1,45 @@
+#pragma once
+#include "graphics/mesh_instance.h"
+
+namespace gef
+{
+	class Mesh;
+}
+
+// A mesh at full detail and simpler versions of it, built by OBJMeshLoader, and how much of the
+// screen it has to cover for each to be drawn. See RenderSnapshot::DrawMesh
+struct MeshLods
+{
+	static constexpr int kMaxLevels = 3;
+
+	const gef::Mesh* meshes[kMaxLevels] = {};
+	int triangle_counts[kMaxLevels] = {};
+	// Of the screen height, by the diameter of the full mesh's bounding sphere
+	float min_screen_size[kMaxLevels] = {};
+	int count = 0;
+
+	int Select(float screen_size) const
+	{
+		for(int level = 0; level < count - 1; level++)
+		{
+			if(screen_size >= min_screen_size[level])
+				return level;
+		}
+		return count - 1;
+	}
+};
+
+// Mesh instance that isn't a game object but still draws through LODs
+class LodMeshInstance : public gef::MeshInstance
+{
+public:
+	void SetMeshLods(const MeshLods* lods)
+	{
+		lods_ = lods;
+		set_mesh(lods != nullptr ? lods->meshes[0] : nullptr);
+	}
+	const MeshLods* GetMeshLods() const { return lods_; }
+
+private:
+	const MeshLods* lods_ = nullptr;
+};
@@ -0,0 +1,297 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+	struct Vec3
+	{
+		double x, y, z;
+	};
+
+	Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	double Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	double Length(const Vec3& a) { return std::sqrt(Dot(a, a)); }
+
+	// Sum of squared distances to a set of planes, as the upper triangle of a symmetric 4x4
+	struct Quadric
+	{
+		double q[10] = {};
+
+		void AddPlane(const Vec3& normal, double d, double weight)
+		{
+			const double p[4] = { normal.x, normal.y, normal.z, d };
+			int i = 0;
+			for(int row = 0; row < 4; row++)
+				for(int column = row; column < 4; column++)
+					q[i++] += weight * p[row] * p[column];
+		}
+
+		void Add(const Quadric& other)
+		{
+			for(int i = 0; i < 10; i++)
+				q[i] += other.q[i];
+		}
+
+		double Error(const Vec3& v) const
+		{
+			return q[0] * v.x * v.x + 2.0 * q[1] * v.x * v.y + 2.0 * q[2] * v.x * v.z + 2.0 * q[3] * v.x
+				+ q[4] * v.y * v.y + 2.0 * q[5] * v.y * v.z + 2.0 * q[6] * v.y
+				+ q[7] * v.z * v.z + 2.0 * q[8] * v.z
+				+ q[9];
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		// from moves onto to
+		int from;
+		int to;
+		uint32_t from_version;
+		uint32_t to_version;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	uint64_t EdgeKey(int a, int b)
+	{
+		return ((uint64_t)(uint32_t)std::min(a, b) << 32) | (uint32_t)std::max(a, b);
+	}
+
+	// Keeps open edges where they are, otherwise nothing stops the outline of a mesh from shrinking
+	constexpr double kBoundaryWeight = 1000.0;
+	// Collapses that turn a triangle further than this from where it faced are refused
+	constexpr double kMinFacingDot = 0.2;
+}
+
+void MeshSimplifier::Simplify(const std::vector<gef::Vector4>& positions, const std::vector<Int32>& face_indices, const std::vector<Int32>& primitive_starts,
+	int target_triangles, std::vector<Int32>& out_face_indices, std::vector<Int32>& out_primitive_starts)
+{
+	const int triangle_count = (int)face_indices.size() / 9;
+	const int vertex_count = (int)positions.size();
+
+	// Exporters often write a position per corner, so triangles only share an edge once
+	// positions at the same place are welded into one vertex
+	std::vector<Vec3> points(vertex_count);
+	std::vector<int> welded(vertex_count);
+	std::unordered_map<uint64_t, std::vector<int>> by_place;
+	by_place.reserve(vertex_count);
+	for(int v = 0; v < vertex_count; v++)
+	{
+		const float place[3] = { positions[v].x(), positions[v].y(), positions[v].z() };
+		points[v] = { place[0], place[1], place[2] };
+
+		uint32_t bits[3];
+		std::memcpy(bits, place, sizeof(bits));
+		std::vector<int>& same_hash = by_place[((uint64_t)bits[0] * 73856093u) ^ ((uint64_t)bits[1] * 19349663u) ^ ((uint64_t)bits[2] * 83492791u)];
+		welded[v] = v;
+		for(const int other : same_hash)
+		{
+			if(points[other].x == points[v].x && points[other].y == points[v].y && points[other].z == points[v].z)
+			{
+				welded[v] = other;
+				break;
+			}
+		}
+		if(welded[v] == v)
+			same_hash.push_back(v);
+	}
+
+	std::vector<int> corners(triangle_count * 3);
+	std::vector<bool> triangle_removed(triangle_count, false);
+	for(int t = 0; t < triangle_count; t++)
+	{
+		for(int c = 0; c < 3; c++)
+			corners[t * 3 + c] = welded[face_indices[t * 9 + c * 3] - 1];
+	}
+
+	auto normal_of = [&](int t, int moved, const Vec3& moved_to)
+	{
+		Vec3 p[3];
+		for(int c = 0; c < 3; c++)
+			p[c] = corners[t * 3 + c] == moved ? moved_to : points[corners[t * 3 + c]];
+		return Cross(p[1] - p[0], p[2] - p[0]);
+	};
+
+	// Every vertex starts with the planes of the triangles around it, weighted by area
+	std::vector<Quadric> quadrics(vertex_count);
+	std::vector<std::vector<int>> vertex_triangles(vertex_count);
+	std::unordered_map<uint64_t, int> edge_uses;
+	edge_uses.reserve(triangle_count * 3);
+	for(int t = 0; t < triangle_count; t++)
+	{
+		const int* corner = &corners[t * 3];
+		const Vec3 normal = normal_of(t, -1, {});
+		const double area = Length(normal);
+		for(int c = 0; c < 3; c++)
+		{
+			vertex_triangles[corner[c]].push_back(t);
+			edge_uses[EdgeKey(corner[c], corner[(c + 1) % 3])]++;
+		}
+		if(area <= 0.0)
+			continue;
+
+		const Vec3 unit = { normal.x / area, normal.y / area, normal.z / area };
+		const double d = -Dot(unit, points[corner[0]]);
+		for(int c = 0; c < 3; c++)
+			quadrics[corner[c]].AddPlane(unit, d, area * 0.5);
+	}
+
+	// Open edges get a plane at right angles to their triangle pinning them in place
+	for(int t = 0; t < triangle_count; t++)
+	{
+		const int* corner = &corners[t * 3];
+		const Vec3 normal = normal_of(t, -1, {});
+		if(Length(normal) <= 0.0)
+			continue;
+		for(int c = 0; c < 3; c++)
+		{
+			const int a = corner[c];
+			const int b = corner[(c + 1) % 3];
+			if(edge_uses[EdgeKey(a, b)] != 1)
+				continue;
+
+			const Vec3 edge = points[b] - points[a];
+			Vec3 side = Cross(edge, normal);
+			const double length = Length(side);
+			if(length <= 0.0)
+				continue;
+			side = { side.x / length, side.y / length, side.z / length };
+			const double d = -Dot(side, points[a]);
+			quadrics[a].AddPlane(side, d, kBoundaryWeight);
+			quadrics[b].AddPlane(side, d, kBoundaryWeight);
+		}
+	}
+
+	std::vector<uint32_t> versions(vertex_count, 0);
+	std::vector<bool> vertex_removed(vertex_count, false);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+
+	// The cheaper way round of collapsing an edge
+	auto push_edge = [&](int a, int b)
+	{
+		Quadric sum = quadrics[a];
+		sum.Add(quadrics[b]);
+		const double a_onto_b = sum.Error(points[b]);
+		const double b_onto_a = sum.Error(points[a]);
+		if(a_onto_b <= b_onto_a)
+			collapses.push({ a_onto_b, a, b, versions[a], versions[b] });
+		else
+			collapses.push({ b_onto_a, b, a, versions[b], versions[a] });
+	};
+
+	for(const auto& edge : edge_uses)
+		push_edge((int)(edge.first >> 32), (int)(edge.first & 0xffffffffu));
+
+	int live_triangles = triangle_count;
+	std::vector<int> neighbours;
+	while(live_triangles > target_triangles && !collapses.empty())
+	{
+		const Collapse collapse = collapses.top();
+		collapses.pop();
+		const int from = collapse.from;
+		const int to = collapse.to;
+		if(vertex_removed[from] || vertex_removed[to] || versions[from] != collapse.from_version || versions[to] != collapse.to_version)
+			continue;
+
+		// Refuse to fold a triangle over, the ones sharing the edge are going anyway
+		bool flips = false;
+		for(const int t : vertex_triangles[from])
+		{
+			if(triangle_removed[t])
+				continue;
+			const int* corner = &corners[t * 3];
+			if(corner[0] == to || corner[1] == to || corner[2] == to)
+				continue;
+			const Vec3 before = normal_of(t, -1, {});
+			if(Length(before) <= 0.0)
+				continue;
+			const Vec3 after = normal_of(t, from, points[to]);
+			const double lengths = Length(before) * Length(after);
+			if(lengths <= 0.0 || Dot(before, after) < kMinFacingDot * lengths)
+			{
+				flips = true;
+				break;
+			}
+		}
+		if(flips)
+			continue;
+
+		vertex_removed[from] = true;
+		quadrics[to].Add(quadrics[from]);
+		versions[to]++;
+		for(const int t : vertex_triangles[from])
+		{
+			if(triangle_removed[t])
+				continue;
+			int* corner = &corners[t * 3];
+			for(int c = 0; c < 3; c++)
+			{
+				if(corner[c] == from)
+					corner[c] = to;
+			}
+			if(corner[0] == corner[1] || corner[1] == corner[2] || corner[0] == corner[2])
+			{
+				triangle_removed[t] = true;
+				live_triangles--;
+			}
+			else
+			{
+				vertex_triangles[to].push_back(t);
+			}
+		}
+		vertex_triangles[from].clear();
+
+		// Drop what's gone from the survivor's list and requeue its edges at the new cost
+		std::vector<int>& around = vertex_triangles[to];
+		around.erase(std::remove_if(around.begin(), around.end(), [&](int t) { return triangle_removed[t]; }), around.end());
+		std::sort(around.begin(), around.end());
+		around.erase(std::unique(around.begin(), around.end()), around.end());
+
+		neighbours.clear();
+		for(const int t : around)
+		{
+			for(int c = 0; c < 3; c++)
+			{
+				if(corners[t * 3 + c] != to)
+					neighbours.push_back(corners[t * 3 + c]);
+			}
+		}
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		for(const int neighbour : neighbours)
+			push_edge(to, neighbour);
+	}
+
+	// Write out what's left in the original order, which keeps each material's triangles together
+	out_face_indices.clear();
+	out_face_indices.reserve(live_triangles * 9);
+	out_primitive_starts.assign(primitive_starts.size(), 0);
+	size_t primitive = 0;
+	for(int t = 0; t <= triangle_count; t++)
+	{
+		while(primitive < primitive_starts.size() && primitive_starts[primitive] <= t * 9)
+			out_primitive_starts[primitive++] = (Int32)out_face_indices.size();
+		if(t == triangle_count)
+			break;
+		if(triangle_removed[t])
+			continue;
+
+		for(int c = 0; c < 3; c++)
+		{
+			out_face_indices.push_back(corners[t * 3 + c] + 1);
+			out_face_indices.push_back(face_indices[t * 9 + c * 3 + 1]);
+			out_face_indices.push_back(face_indices[t * 9 + c * 3 + 2]);
+		}
+	}
+	// Starts past the end, if there are any
+	while(primitive < primitive_starts.size())
+		out_primitive_starts[primitive++] = (Int32)out_face_indices.size();
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <gef.h>
+#include <vector>
+
+#include "maths/vector4.h"
+
+// Quadric error metric edge collapse (Garland and Heckbert, 1997) over an OBJ's triangles, for
+// building LODs. Works on OBJMeshLoader's layout: 9 face indices per triangle, position, uv and
+// normal for each corner, 1 based. A collapsed vertex moves onto the one it collapses into and
+// the corners keep their own uvs and normals, so nothing new has to be made up for them
+namespace MeshSimplifier
+{
+	// primitive_starts are where each material's triangles start in face_indices, and
+	// out_primitive_starts the same for what's left, with every triangle keeping its material
+	void Simplify(const std::vector<gef::Vector4>& positions, const std::vector<Int32>& face_indices, const std::vector<Int32>& primitive_starts,
+		int target_triangles, std::vector<Int32>& out_face_indices, std::vector<Int32>& out_primitive_starts);
+}
@@ -0,0 +1,78 @@
+#include "Overlay.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "Profiler.h"
+#include "graphics/sprite_renderer.h"
+
+namespace
+{
+	// Enough for a busy menu and the profiler lines without growing mid-frame
+	constexpr size_t kCommandReserve = 1024;
+}
+
+bool Overlay::Init(gef::Platform& platform, const char* font_name)
+{
+	commands_.reserve(kCommandReserve);
+	keys_.reserve(kCommandReserve);
+	return font_.Load(font_name, platform);
+}
+
+void Overlay::DrawSprite(const gef::Sprite& sprite, OverlayLayer layer)
+{
+	commands_.push_back({ sprite, layer });
+}
+
+void Overlay::DrawText(const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, const char* text, OverlayLayer layer)
+{
+	if(text == nullptr)
+		return;
+
+	font_.Layout(text, position, scale, colour, justification, glyphs_);
+	for(const gef::Sprite& glyph : glyphs_)
+	{
+		commands_.push_back({ glyph, layer });
+	}
+}
+
+void Overlay::Submit(gef::SpriteRenderer* sprite_renderer)
+{
+	PROFILE_ZONE("Overlay::Submit");
+
+	keys_.clear();
+	unsorted_texture_changes_ = 0;
+	const gef::Texture* last_texture = nullptr;
+	for(uint32_t i = 0; i < (uint32_t)commands_.size(); i++)
+	{
+		const gef::Texture* texture = commands_[i].sprite.texture();
+		if(i == 0 || texture != last_texture)
+			unsorted_texture_changes_++;
+		last_texture = texture;
+		keys_.push_back({ commands_[i].layer, texture, i });
+	}
+
+	// Push order breaks ties, so sprites sharing a layer and texture still overlap the way they were drawn
+	std::sort(keys_.begin(), keys_.end(), [](const SortKey& a, const SortKey& b)
+	{
+		if(a.layer != b.layer)
+			return a.layer < b.layer;
+		if(a.texture != b.texture)
+			return std::less<const gef::Texture*>()(a.texture, b.texture);
+		return a.index < b.index;
+	});
+
+	texture_changes_ = 0;
+	sprite_renderer->Begin(clear_);
+	for(size_t i = 0; i < keys_.size(); i++)
+	{
+		if(i == 0 || keys_[i].texture != keys_[i - 1].texture)
+			texture_changes_++;
+		sprite_renderer->DrawSprite(commands_[keys_[i].index].sprite);
+	}
+	sprite_renderer->End();
+
+	submitted_commands_ = (int)commands_.size();
+	commands_.clear();
+	clear_ = false;
+}
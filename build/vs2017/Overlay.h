@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "GlyphFont.h"
+#include "graphics/sprite.h"
+
+namespace gef
+{
+	class Platform;
+	class SpriteRenderer;
+}
+
+// Draw order of the overlay, later layers go on top
+enum class OverlayLayer : uint8_t
+{
+	Background,
+	Sprites,
+	Text,
+	Debug,
+	Count
+};
+
+// Screen space sprites and text for the frame, pushed by anything while it renders and drawn
+// together once the 3D pass is done. Submit sorts by layer, then by texture within a layer,
+// and puts the whole frame through one sprite renderer Begin/End
+class Overlay
+{
+public:
+	bool Init(gef::Platform& platform, const char* font_name);
+
+	// Screens with nothing 3D under them ask for the frame buffer to be cleared first
+	void Clear() { clear_ = true; }
+
+	void DrawSprite(const gef::Sprite& sprite, OverlayLayer layer = OverlayLayer::Sprites);
+	void DrawText(const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, const char* text, OverlayLayer layer = OverlayLayer::Text);
+
+	// Draws and empties the buffer
+	void Submit(gef::SpriteRenderer* sprite_renderer);
+
+	// From the last Submit
+	int GetCommandCount() const { return submitted_commands_; }
+	int GetTextureChanges() const { return texture_changes_; }
+	// What the texture changes would have been drawn in the order things were pushed
+	int GetUnsortedTextureChanges() const { return unsorted_texture_changes_; }
+
+private:
+	struct Command
+	{
+		gef::Sprite sprite;
+		OverlayLayer layer;
+	};
+
+	struct SortKey
+	{
+		OverlayLayer layer;
+		const gef::Texture* texture;
+		uint32_t index;
+	};
+
+	GlyphFont font_;
+	std::vector<Command> commands_;
+	std::vector<SortKey> keys_;
+	std::vector<gef::Sprite> glyphs_;
+	bool clear_ = false;
+
+	int submitted_commands_ = 0;
+	int texture_changes_ = 0;
+	int unsorted_texture_changes_ = 0;
+};
@@ -1,107 +1,95 @@
 ﻿#include "Pickup.h"
 #include <cmath>
 #include "Player.h"
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
 
 Pickup::Pickup()
 {
 	tag = Tag::Pickup;
+	SubscribeContacts(ContactBegin);
 }
 
-void Pickup::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world,
-				PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic)
+void Pickup::Init(b2World* world, AudioSystem* am)
 {
 	audio_manager_ = am;
-	//size_ = gef::Vector4(size_x, size_y, size_z);
-	//set_mesh(builder->CreateBoxMesh(gef::Vector4(size_x, size_y, size_z)));
+	pickup_sound_ = audio_manager_->GetSound("pickup");
+	max_ammo_sound_ = audio_manager_->GetSound("max_ammo");
 
+	// Kinematic so it bobs by velocity and box2d only has to move it when it leaves its fat bounds
 	b2BodyDef body_def;
-	dynamic ? body_def.type = b2_dynamicBody : body_def.type = b2_staticBody;
-	body_def.position = b2Vec2(pos_x, pos_y);
+	body_def.type = b2_kinematicBody;
+	body_def.enabled = false;
 	body_def.userData.pointer = reinterpret_cast<uintptr_t>(this);
 
 	b2PolygonShape shape;
-	shape.SetAsBox(mesh_->aabb().max_vtx().x(), mesh_->aabb().max_vtx().y());
+	shape.SetAsBox(0.5f, 0.5f);
 
 	b2FixtureDef fixture;
 	fixture.shape = &shape;
-	fixture.density = 1.f;
-	fixture.friction = 0.7f;
 	fixture.userData.pointer = reinterpret_cast<uintptr_t>(this);
+	fixture.filter = CollisionLayers::FilterFor(CollisionLayer::Pickup);
+	fixture.isSensor = true;
 
 	physics_body_ = world->CreateBody(&body_def);
 	physics_body_->CreateFixture(&fixture);
-
-	UpdateBox2d();
-	
-	EnableCollisionResolution(false);
-	GetBody()->SetGravityScale(0.f);
-
 }
 
-void Pickup::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic)
+void Pickup::Spawn(Type type, const gef::Mesh* mesh, const b2Vec2& position)
 {
-	Init(size, pos, world, builder, am, dynamic);
+	type_ = type;
+	set_mesh(mesh);
+	dead = false;
+	is_active_ = true;
+	bobbing_time_ = 0.0f;
+	start_pos_ = position;
+
+	physics_body_->SetTransform(position, 0.f);
+	physics_body_->SetLinearVelocity(b2Vec2(0.f, 0.f));
+	physics_body_->SetEnabled(true);
+	UpdateBox2d();
 }
 
-void Pickup::SetTargetBody(b2Body* target_body)
+void Pickup::Despawn()
 {
-	target_body_ = target_body;
+	is_active_ = false;
+	physics_body_->SetLinearVelocity(b2Vec2(0.f, 0.f));
+	physics_body_->SetEnabled(false);
 }
 
 void Pickup::Update(float frame_time)
 {
-	if(is_active_)
-	{
-		bobbing_time_ += frame_time;
-		GetBody()->SetTransform(b2Vec2(start_pos_.x, start_pos_.y + 0.5*sin(bobbing_time_*3)), 0.f);
-		UpdateBox2d();
-	}
-	else
-	{
-		GetBody()->SetTransform(target_body_->GetPosition(), 0.f);
-	}
+	if(!is_active_ || frame_time <= 0.f)
+		return;
+
+	// Heads for where the bob will be next frame, so it never drifts off
+	bobbing_time_ += frame_time;
+	const float next_y = start_pos_.y + 0.5f * sinf((bobbing_time_ + frame_time) * 3.f);
+	physics_body_->SetLinearVelocity(b2Vec2(0.f, (next_y - physics_body_->GetPosition().y) / frame_time));
+	UpdateBox2d();
 }
 
-void Pickup::Render(gef::Renderer3D* renderer_3d) const
+void Pickup::Render(RenderSnapshot& snapshot) const
 {
 	if(is_active_)
-		GameObject::Render(renderer_3d);
+		GameObject::Render(snapshot);
 }
 
 void Pickup::BeginCollision(GameObject* other)
 {
-	if(is_active_ && other->GetTag() == Tag::Player)
+	if(is_active_ && !dead && other->GetTag() == Tag::Player)
 	{
-		auto* player = dynamic_cast<Player*>(other);
+		auto* player = static_cast<Player*>(other);
 		if(type_ == MaxAmmo)
 		{
 			player->GetGun()->addAmmo();
-			if(player->GetGun()->isMax()) audio_manager_->PlaySample(1);
-			else audio_manager_->PlaySample(0);
+			if(player->GetGun()->isMax()) audio_manager_->Play(max_ammo_sound_);
+			else audio_manager_->Play(pickup_sound_);
 		}
 		else if(type_ == Health)
 		{
 			player->Heal(3);
-			audio_manager_->PlaySample(0);
+			audio_manager_->Play(pickup_sound_);
 		}
 		Kill();
 	}
 }
-
-void Pickup::SetType(Type type)
-{
-	type_ = type;
-}
-
-void Pickup::Activate()
-{
-	is_active_ = true;
-	start_pos_ = GetBody()->GetTransform().p;
-}
-
-void Pickup::Activate(Type type)
-{
-	type_ = type;
-	is_active_ = true;
-}
@@ -1,6 +1,8 @@
 ﻿#pragma once
+#include "AudioSystem.h"
 #include "GameObject.h"
 
+// Loot an enemy leaves behind. Owned by a LootPool and reused, sits out of the world until spawned
 class Pickup : public GameObject
 {
 public:
@@ -11,19 +13,19 @@ public:
 		Health,
 	};
 	Pickup();
-	void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic) override;
-	void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, gef::AudioManager* am, bool dynamic) override;
-	void SetTargetBody(b2Body* target_body);
+	// Makes the body, disabled until Spawn
+	void Init(b2World* world, AudioSystem* am);
+	void Spawn(Type type, const gef::Mesh* mesh, const b2Vec2& position);
+	void Despawn();
+	bool IsActive() const { return is_active_; }
 	void Update(float frame_time) override;
-	void Render(gef::Renderer3D* renderer_3d) const override;
+	void Render(RenderSnapshot& snapshot) const override;
 	void BeginCollision(GameObject* other) override;
-	void SetType(Type type);
-	void Activate();
-	void Activate(Type type);
 private:
 	bool is_active_ = false;
-	b2Body* target_body_ = nullptr;
 	Type type_ = None;
 	float bobbing_time_ = 0.0f;
 	b2Vec2 start_pos_;
+	SoundHandle pickup_sound_;
+	SoundHandle max_ammo_sound_;
 };
@@ -5,19 +5,23 @@
 #include "system/debug_log.h"
 #include "Level.h"
 #include "InputActionManager.h"
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
+#include "RenderSnapshot.h"
 
-void Player::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, SpriteAnimator3D* sprite_animator, gef
-				::AudioManager* am, Camera* cam, Level* lev) {
+void Player::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, Camera* cam, Level* lev) {
 	tag = Tag::Player;
+	SubscribeContacts(ContactBegin | ContactEnd);
 	audio_manager_ = am;
+	hurt_sound_ = audio_manager_->GetSound("player_hurt");
 	camera_ = cam;
 	platform_ = sprite_animator->GetPlatform();
 	level_ = lev;
+	scheduler_ = &lev->GetScheduler();
 	sprite_animator3D_ = sprite_animator;
 	set_mesh(sprite_animator3D_->GetFirstFrame("PlayerIdle"));
 
-	gun_.Init(gef::Vector4(size_x * 0.33f, size_y, size_z), world, sprite_animator, audio_manager_, "Player/Gun/gun.png");
+	gun_.Init(gef::Vector4(size_x * 0.33f, size_y, size_z), world, sprite_animator, audio_manager_, "Player/Gun/gun.png", "player_laser");
+	gun_.SetScheduler(scheduler_);
 
 	physics_world_ = world;
 
@@ -34,16 +38,18 @@ void Player::Init(float size_x, float size_y, float size_z, float pos_x, float p
 	fixture.density = 2.f;
 	fixture.friction = 0.7f;
 	fixture.userData.pointer = reinterpret_cast<uintptr_t>(this);
+	fixture.filter = CollisionLayers::FilterFor(CollisionLayer::Player);
 
 	physics_body_ = world->CreateBody(&body_def);
 	physics_body_->CreateFixture(&fixture);
 	physics_body_->SetSleepingAllowed(false);
 	physics_body_->SetFixedRotation(true);
+	controller_.Init(physics_body_, move_speed_);
 
 	UpdateBox2d();
 }
 
-void Player::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, Camera*
+void Player::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, Camera*
 				cam, Level* lev) {
 	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, sprite_animator, am, cam, lev);
 }
@@ -55,40 +61,10 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 		}
 
 		// Movement
-		if (iam->isHeld(MoveLeft)) {
-			switch (player_gravity_direction_)
-			{
-			case GravityDirection::GRAVITY_UP:
-			case GravityDirection::GRAVITY_DOWN:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(-8 * frame_time, 0), physics_body_->GetAngle());
-				break;
-			case GravityDirection::GRAVITY_LEFT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, 8 * frame_time), physics_body_->GetAngle());
-				break;
-			case GravityDirection::GRAVITY_RIGHT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, -8 * frame_time), physics_body_->GetAngle());
-				break;
-			default:
-				break;
-			}
-		}
-		if (iam->isHeld(MoveRight)) {
-			switch (player_gravity_direction_)
-			{
-			case GravityDirection::GRAVITY_UP:
-			case GravityDirection::GRAVITY_DOWN:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(8 * frame_time, 0), physics_body_->GetAngle());
-				break;
-			case GravityDirection::GRAVITY_LEFT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, -8 * frame_time), physics_body_->GetAngle());
-				break;
-			case GravityDirection::GRAVITY_RIGHT:
-				physics_body_->SetTransform(physics_body_->GetPosition() + b2Vec2(0, 8 * frame_time), physics_body_->GetAngle());
-				break;
-			default:
-				break;
-			}
-		}
+		float move = 0.f;
+		if (iam->isHeld(MoveLeft)) move -= 1.f;
+		if (iam->isHeld(MoveRight)) move += 1.f;
+		controller_.Move(move);
 
 		if (iam->isPressed(GravityLock)) {
 			gravity_lock_ = !gravity_lock_;
@@ -114,7 +90,6 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 		if (iam->isPressed(GravityUp)) {
 			camera_->Warp();
 			world_gravity_ = b2Vec2(0, 1);
-			physics_world_->SetAllowSleeping(false);
 			world_gravity_direction_ = GravityDirection::GRAVITY_UP;
 			if (!gravity_lock_) {
 				player_gravity_direction_ = GravityDirection::GRAVITY_UP;
@@ -124,7 +99,6 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 		else if (iam->isPressed(GravityDown)) {
 			camera_->Warp();
 			world_gravity_ = b2Vec2(0, -1);
-			physics_world_->SetAllowSleeping(false);
 			world_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
 			if (!gravity_lock_) {
 				player_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
@@ -134,7 +108,6 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 		else if (iam->isPressed(GravityLeft)) {
 			camera_->Warp();
 			world_gravity_ = b2Vec2(-1, 0);
-			physics_world_->SetAllowSleeping(false);
 			world_gravity_direction_ = GravityDirection::GRAVITY_LEFT;
 			if (!gravity_lock_) {
 				player_gravity_direction_ = GravityDirection::GRAVITY_LEFT;
@@ -143,59 +116,30 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 		else if (iam->isPressed(GravityRight)) {
 			camera_->Warp();
 			world_gravity_ = b2Vec2(1, 0);
-			physics_world_->SetAllowSleeping(false);
 			world_gravity_direction_ = GravityDirection::GRAVITY_RIGHT;
 			if (!gravity_lock_) {
 				player_gravity_direction_ = GravityDirection::GRAVITY_RIGHT;
 			}
 		}
 
-		switch (player_gravity_direction_)
-		{
-		case GravityDirection::GRAVITY_UP:
-			physics_body_->SetTransform(physics_body_->GetPosition(), gef::DegToRad(180));
-			break;
-		case GravityDirection::GRAVITY_DOWN:
-			physics_body_->SetTransform(physics_body_->GetPosition(), 0);
-			break;
-		case GravityDirection::GRAVITY_LEFT:
-			physics_body_->SetTransform(physics_body_->GetPosition(), gef::DegToRad(-90));
-			break;
-		case GravityDirection::GRAVITY_RIGHT:
-			physics_body_->SetTransform(physics_body_->GetPosition(), gef::DegToRad(90));
-			break;
-		default:
-			break;
-		}
+		controller_.SetGravityDirection(player_gravity_direction_);
+		controller_.Step();
 
 		if (iam->isPressed(GravityStrenghtUp)) {
 			camera_->Warp();
-			grav_strength_changed_ = true;
 			world_grav_mult = 50.f;
+			if (!scheduler_->IsRunning(grav_strength_task_)) grav_strength_task_ = scheduler_->Start(ResetGravityStrengthAfter(grav_strength_time_));
 		}
 		else if (iam->isPressed(GravityStrengthDown)) {
 			camera_->Warp();
-			grav_strength_changed_ = true;
 			world_grav_mult = 0;
-			b2Body* body_list = physics_world_->GetBodyList();
-			while (body_list->GetNext()) {
-				body_list->ApplyLinearImpulseToCenter(-world_gravity_, true);
-				body_list = body_list->GetNext();
-			}
-		}
-
-		if (grav_strength_changed_) {
-			grav_strength_change_time += frame_time;
-			if (grav_strength_change_time >= 5) {
-				grav_strength_changed_ = false;
-				grav_strength_change_time = 0;
-				world_grav_mult = 10.f;
-			}
+			if (!scheduler_->IsRunning(grav_strength_task_)) grav_strength_task_ = scheduler_->Start(ResetGravityStrengthAfter(grav_strength_time_));
+			level_->GetGravityField().ApplyImpulse(-world_gravity_);
 		}
 
 		b2Vec2 grav = world_gravity_;
 		grav *= world_grav_mult;
-		physics_world_->SetGravity(grav);
+		level_->GetGravityField().SetGlobal(grav);
 
 		UpdateBox2d();
 
@@ -210,6 +154,10 @@ void Player::Update(InputActionManager* iam, float frame_time) {
 			if (animation_state_ != JUMPING) animation_state_ = IDLE;
 		}
 	}
+	else {
+		controller_.Move(0.f);
+		controller_.Step();
+	}
 
 	anim_time_ += frame_time;
 
@@ -253,9 +201,9 @@ void Player::BeginCollision(GameObject* other) {
 		break;
 	case Tag::Bullet: 
 	{
-     	Bullet* bullet = dynamic_cast<Bullet*>(other);
+     	Bullet* bullet = static_cast<Bullet*>(other);
 		if (bullet->getTarget() == GameObject::Tag::Player && bullet->getDamage() > 0) {
-			if (!audio_manager_->sample_voice_playing(4)) audio_manager_->PlaySample(4);
+			if (!audio_manager_->IsPlaying(hurt_voice_)) hurt_voice_ = audio_manager_->Play(hurt_sound_);
 			if(health_ > 0)
 			{
 				health_--;
@@ -285,10 +233,10 @@ void Player::EndCollision(GameObject* other) {
 	}
 }
 
-void Player::Render(gef::Renderer3D* renderer_3d) {
-	renderer_3d->set_override_material(NULL);
-	renderer_3d->DrawMesh(*this);
-	gun_.Render(renderer_3d);
+void Player::Render(RenderSnapshot& snapshot) const {
+	snapshot.SetOverrideMaterial(NULL);
+	snapshot.DrawMesh(*this);
+	gun_.Render(snapshot);
 }
 
 int Player::GetHealth() const
@@ -307,3 +255,27 @@ void Player::Heal(int heal_amount)
 		health_ += starting_health_ - health_;
 	}
 }
+
+Task Player::ResetGravityStrengthAfter(float delay) {
+	co_await WaitSeconds(delay);
+	world_grav_mult = 10.f;
+}
+
+void Player::RestoreInitialState()
+{
+	GameObject::RestoreInitialState();
+	gun_.Reset();
+	controller_.Reset();
+
+	health_ = starting_health_;
+	world_gravity_ = b2Vec2(0, -1);
+	world_grav_mult = 10;
+	scheduler_->Cancel(grav_strength_task_);
+	gravity_lock_ = false;
+	jumping_ = false;
+	world_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
+	player_gravity_direction_ = GravityDirection::GRAVITY_DOWN;
+	animation_state_ = IDLE;
+	touching_next_object_ = false;
+	touching_end_object_ = false;
+}
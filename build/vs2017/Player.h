@@ -1,17 +1,17 @@
 #pragma once
 #include "GameObject.h"
-#include <graphics/renderer_3d.h>
 #include "PlayerGun.h"
 #include "SpriteAnimator3D.h"
 #include "Camera.h"
+#include "CharacterController.h"
 
 class InputActionManager;
 class Level;
 
 class Player : public GameObject {
 public:
-	void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, Camera* cam, Level* lev);
-	void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, SpriteAnimator3D* sprite_animator, gef::AudioManager* am, Camera* cam, Level* lev);
+	void Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, Camera* cam, Level* lev);
+	void Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, SpriteAnimator3D* sprite_animator, AudioSystem* am, Camera* cam, Level* lev);
 	void Update(InputActionManager* iam, float frame_time);
 	bool GetGravityLock() const { return gravity_lock_; }
 	bool GetTouchingEnd() { return touching_end_object_; }
@@ -20,22 +20,30 @@ public:
 	PlayerGun* GetGun() { return &gun_; }
 	void BeginCollision(GameObject* other) override;
 	void EndCollision(GameObject* other) override;
-	void Render(gef::Renderer3D* renderer_3d);
+	void Render(RenderSnapshot& snapshot) const override;
 	int GetHealth() const;
 	void Heal(int heal_amount);
+	void RestoreInitialState() override;
 
 protected:
+	Task ResetGravityStrengthAfter(float delay);
+
 	Camera* camera_;
 
 	const int starting_health_ = 10;
 	int health_ = starting_health_;
 	PlayerGun gun_;
+	CharacterController controller_;
+	const float move_speed_ = 8.f;
+	SoundHandle hurt_sound_;
+	VoiceHandle hurt_voice_;
 
 	b2World* physics_world_ = nullptr;
 	b2Vec2 world_gravity_ = b2Vec2(0, -1);
 	float world_grav_mult = 10;
-	bool grav_strength_changed_ = false;
-	float grav_strength_change_time = 2;
+	const float grav_strength_time_ = 5.f;
+	Scheduler* scheduler_ = nullptr;
+	TaskHandle grav_strength_task_;
 
 	bool gravity_lock_ = false;
 	bool jumping_ = false;
@@ -5,11 +5,11 @@
 #include <maths/math_utils.h>
 #include "SpriteAnimator3D.h"
 #include "Player.h"
+#include <algorithm>
 #include <cmath>
-#include <thread>
 #include <system/debug_log.h>
 
-#include "audio/audio_manager.h"
+#include "AudioSystem.h"
 
 void PlayerGun::Update(gef::Vector4 translation, GravityDirection grav_dir, InputActionManager* input, gef::Platform* platform, Camera* cam, float dt) {
 
@@ -30,24 +30,24 @@ void PlayerGun::Update(gef::Vector4 translation, GravityDirection grav_dir, Inpu
 
 	UpdateTransform(translation, grav_dir);
 
-	if (input->getInputManager()->touch_manager()->is_button_down(0) || input->isHeld(Action::Fire)) {
+	if (input->isLMBHeld() || input->isHeld(Action::Fire)) {
 		Fire(dt, GameObject::Tag::Enemy);
 		if(ammo_loaded_ > 0)
 		{
 			cam->Shake();
-			if(!am_->sample_voice_playing(2))
+			if(!am_->IsPlaying(fire_voice_))
 			{
-				am_->PlaySample(2, true);
+				fire_voice_ = am_->Play(fire_sound_, true);
 			}
 		}
-		else if(am_->sample_voice_playing(2))
+		else
 		{
-			am_->StopPlayingSampleVoice(2);
+			am_->Stop(fire_voice_);
 		}
 	}
-	else if(am_->sample_voice_playing(2))
+	else
 	{
-		am_->StopPlayingSampleVoice(2);
+		am_->Stop(fire_voice_);
 	}
 
 	if (input->isPressed(Action::Reload)) {
@@ -58,33 +58,34 @@ void PlayerGun::Update(gef::Vector4 translation, GravityDirection grav_dir, Inpu
 }
 
 void PlayerGun::Reload(bool* reloading) {
-	if (!reloading_) {
+	if (!reloading_ && scheduler_ != nullptr) {
 		reloading_ = true;
-		std::thread reload_thread([this] { 
-
-			this->reloadThreadFunc(); 
-			this->setReloading(false);
-		});
-		reload_thread.detach();
+		reload_task_ = scheduler_->Start(ReloadAfter(reload_time_));
 	}
 }
 
-void PlayerGun::reloadThreadFunc() {
-	if (ammo_reserve_ > (30 - ammo_loaded_)) {
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-		ammo_reserve_ -= (30 - ammo_loaded_);
-		ammo_loaded_ = 30;
-	}
-	else if (ammo_reserve_ > 0 && ammo_reserve_ < (30 - ammo_loaded_)) {
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-		ammo_loaded_ += ammo_reserve_;
-		ammo_reserve_ = 0;
+Task PlayerGun::ReloadAfter(float delay) {
+	if (ammo_reserve_ > 0 && ammo_loaded_ < max_ammo_loaded_) {
+		co_await WaitSeconds(delay);
+		const int to_load = std::min(max_ammo_loaded_ - ammo_loaded_, ammo_reserve_);
+		ammo_loaded_ += to_load;
+		ammo_reserve_ -= to_load;
 	}
-	else return;
+	reloading_ = false;
+}
+
+void PlayerGun::Reset()
+{
+	Gun::Reset();
+	if (scheduler_ != nullptr) scheduler_->Cancel(reload_task_);
+	if (am_ != nullptr) am_->Stop(fire_voice_);
+	ammo_loaded_ = max_ammo_loaded_;
+	ammo_reserve_ = max_ammo_reserve_;
 }
 
 PlayerGun::~PlayerGun()
 {
+	if (am_ != nullptr) am_->Stop(fire_voice_);
 }
 
 void PlayerGun::addAmmo()
@@ -3,6 +3,7 @@
 #include "BulletManager.h"
 #include "Gun.h"
 #include "Camera.h"
+#include "Scheduler.h"
 
 class InputActionManager;
 
@@ -10,6 +11,8 @@ class PlayerGun : public Gun {
 public:
 	void Update(gef::Vector4 translation, GravityDirection grav_dir, InputActionManager* input, gef::Platform* platform, Camera* cam, float dt);
 	void Reload(bool* reloading) override;
+	void Reset() override;
+	void SetScheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
 	int getAmmoLoaded() const { return ammo_loaded_; }
 	int getAmmoReserve() const { return ammo_reserve_; }
 	bool getReloading() const { return reloading_; }
@@ -19,7 +22,7 @@ public:
 	bool isMax() { return (ammo_reserve_ == max_ammo_reserve_ && ammo_loaded_ == max_ammo_loaded_); }
 
 protected:
-	void reloadThreadFunc();
+	Task ReloadAfter(float delay);
 	float GetFireRate() override { return fire_rate_; }
 	int* loaded() override { return &ammo_loaded_; }
 	void decreaseLoaded() override { ammo_loaded_--; }
@@ -30,4 +33,8 @@ protected:
 	int ammo_loaded_ = max_ammo_loaded_;
 	int damage_ = 5;
 	float fire_rate_ = 1.f / 15.f;
+	const float reload_time_ = 1.f;
+	Scheduler* scheduler_ = nullptr;
+	TaskHandle reload_task_;
+	VoiceHandle fire_voice_;
 };
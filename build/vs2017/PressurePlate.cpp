@@ -2,23 +2,21 @@
 
 #include <sstream>
 
-#include "audio/audio_manager.h"
-#include "graphics/font.h"
-#include "graphics/renderer_3d.h"
-#include "graphics/sprite_renderer.h"
+#include "ContactGraph.h"
+#include "AudioSystem.h"
+#include "RenderSnapshot.h"
 
-void PressurePlate::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, gef::
-						SpriteRenderer* sr, gef::Font* font, float
-						threshold, gef::Platform* platform, gef::AudioManager* am, float offset_y, bool is_fussy)
+void PressurePlate::Init(float size_x, float size_y, float size_z, float pos_x, float pos_y, b2World* world, PrimitiveBuilder* builder, float
+						threshold, gef::Platform* platform, AudioSystem* am, float offset_y, bool is_fussy)
 {
 	offset_y_ = offset_y;
 	audio_manager_ = am;
+	door_sound_ = audio_manager_->GetSound("door");
 	platform_ = platform;
-	sprite_renderer_ = sr;
-	font_ = font;
  	tag = Tag::PressurePlate;
 	threshold_ = threshold;
 	is_fussy_ = is_fussy;
+	UpdateHUD();
  
 	set_mesh(builder->CreateBoxMesh(gef::Vector4(size_x, size_y, size_z)));
  	physics_world_ = world;
@@ -36,6 +34,7 @@ void PressurePlate::Init(float size_x, float size_y, float size_z, float pos_x,
  	fixture.density = 1.f;
  	fixture.friction = 0.7f;
  	fixture.userData.pointer = reinterpret_cast<uintptr_t>(this);
+ 	fixture.filter = CollisionLayers::FilterFor(CollisionLayer::Static);
  
  	physics_body_ = world->CreateBody(&body_def);
  	physics_body_->CreateFixture(&fixture);
@@ -48,77 +47,63 @@ void PressurePlate::Init(float size_x, float size_y, float size_z, float pos_x,
 
 void PressurePlate::Update(float frame_time)
 {
-	const bool wasActivated = (current_load_ >= threshold_ && !is_fussy_) || (current_load_ == threshold_ && is_fussy_);
+	// Nothing has started or stopped touching, so the load can't have changed
+	if(contact_graph_ == nullptr || contact_graph_->GetVersion() == contact_graph_version_)
+		return;
+	contact_graph_version_ = contact_graph_->GetVersion();
 
-	std::ostringstream oss;
-	oss << current_load_ << " / " << threshold_;
-	hud_ = oss.str();
-	
-	if(GetBody()->GetContactList() == nullptr)
-	{
-		current_load_ = 0.f;
-		on_deactivate_();
-		if(wasActivated)
-		{
-			audio_manager_->PlaySample(6);
-		}
+	const float load = contact_graph_->GetStackWeight(this);
+	if(load == current_load_)
 		return;
-	}
-	
-	std::set<GameObject*> visited_objects;
 
-	current_load_ = 0.f;
-	TraverseContactChain(reinterpret_cast<GameObject*>(GetBody()->GetContactList()->other->GetUserData().pointer), visited_objects, current_load_);
+	current_load_ = load;
+	UpdateHUD();
 
-	if(!wasActivated && ((current_load_ >= threshold_ && !is_fussy_) || (current_load_ == threshold_ && is_fussy_)))
+	// Only crossing the threshold moves the door
+	if(IsActivated() != activated_)
 	{
-		audio_manager_->PlaySample(6);
-		on_activate_();
-	}
-	else if(wasActivated && (current_load_ < threshold_ || (current_load_ != threshold_ && is_fussy_)))
-	{
-		audio_manager_->PlaySample(6);
-		on_deactivate_();
+		activated_ = !activated_;
+		audio_manager_->Play(door_sound_);
+		if(activated_)
+			on_activate_();
+		else
+			on_deactivate_();
 	}
 }
 
-void PressurePlate::Render(gef::Renderer3D* renderer_3d) const
+bool PressurePlate::IsActivated() const
 {
-	renderer_3d->DrawMesh(*this);
-	sprite_renderer_->Begin(false);
-		if(offset_y_ == 0.f)
-			font_->RenderText(sprite_renderer_, {platform_->width() - 200.f, 64.f, -0.9f},1.f, 0xffffffff, gef::TJ_CENTRE, "Pressure Plate");
-		font_->RenderText(sprite_renderer_, {platform_->width() - 200.f, 96.f + offset_y_, -0.9f}, 1.f, 0xffffffff, gef::TJ_CENTRE, hud_.c_str());
-	sprite_renderer_->End();
+	return (current_load_ >= threshold_ && !is_fussy_) || (current_load_ == threshold_ && is_fussy_);
 }
 
-void PressurePlate::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, float threshold, gef::SpriteRenderer*
-						sr, gef::Font* font, gef::Platform* platform, gef::AudioManager* am, float offset_y, bool is_fussy)
+void PressurePlate::UpdateHUD()
 {
-	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, builder, sr, font, threshold, platform, am, offset_y, is_fussy);
+	std::ostringstream oss;
+	oss << current_load_ << " / " << threshold_;
+	hud_ = oss.str();
 }
 
-void PressurePlate::TraverseContactChain(GameObject* game_object, std::set<GameObject*>& visited_objects, float& total_weight)
+void PressurePlate::Render(RenderSnapshot& snapshot) const
 {
-	// Check if the body has already been visited to avoid infinite recursion
-	if (game_object == nullptr || visited_objects.contains(game_object))
-	{
-		return;
-	}
+	snapshot.DrawMesh(*this);
+	if(offset_y_ == 0.f)
+		snapshot.DrawText({platform_->width() - 200.f, 64.f, -0.9f}, 1.f, 0xffffffff, gef::TJ_CENTRE, "Pressure Plate");
+	snapshot.DrawText({platform_->width() - 200.f, 96.f + offset_y_, -0.9f}, 1.f, 0xffffffff, gef::TJ_CENTRE, hud_.c_str());
+}
 
-	if(game_object->GetTag() == Tag::None || game_object->GetTag() == Tag::PressurePlate)
-	{
-		return;
-	}
-	
-	visited_objects.insert(game_object);
+void PressurePlate::RestoreInitialState()
+{
+	GameObject::RestoreInitialState();
+	current_load_ = 0.f;
+	activated_ = false;
+	UpdateHUD();
 
-	total_weight += game_object->GetWeight();
+	// Whatever is on the plate after the restart gets weighed again next update
+	if(contact_graph_ != nullptr)
+		contact_graph_version_ = contact_graph_->GetVersion() - 1;
+}
 
-	// Iterate through all contacts of the body
-	for (const b2ContactEdge* edge = game_object->GetBody()->GetContactList(); edge; edge = edge->next)
-	{
-		// Traverse the contact chain recursively
-		TraverseContactChain(reinterpret_cast<GameObject*>(edge->other->GetUserData().pointer), visited_objects, total_weight);
-	}
+void PressurePlate::Init(gef::Vector4 size, gef::Vector4 pos, b2World* world, PrimitiveBuilder* builder, float threshold, gef::Platform* platform, AudioSystem* am, float offset_y, bool is_fussy)
+{
+	Init(size.x(), size.y(), size.z(), pos.x(), pos.y(), world, builder, threshold, platform, am, offset_y, is_fussy);
 }
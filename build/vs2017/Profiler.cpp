@@ -0,0 +1,325 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "json.h"
+#include "Overlay.h"
+#include "maths/vector4.h"
+
+using nlohmann::json;
+
+std::atomic<bool> Profiler::enabled_ = false;
+
+namespace
+{
+	// Zones finished on one thread since the last EndFrame
+	struct ThreadBuffer
+	{
+		uint32_t id = 0;
+		std::string name;
+		bool in_use = false;
+		std::mutex mutex;
+		std::vector<Profiler::Zone> zones;
+	};
+
+	struct Frame
+	{
+		int64_t start_us = 0;
+		int64_t duration_us = 0;
+		std::vector<Profiler::Zone> zones;
+	};
+
+	std::mutex threads_mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> threads;
+
+	// Only touched by the main thread
+	std::array<Frame, Profiler::kFrameHistory> frames;
+	int frame_index = 0;
+	int frame_count = 0;
+	int64_t frame_start_us = 0;
+	uint32_t main_thread = 0;
+	int frames_since_overlay_update = 0;
+	std::vector<std::string> overlay_lines;
+
+	// Claims a buffer for the calling thread and hands it back when the thread exits,
+	// so the loading threads started for each level reuse the same buffer
+	struct ThreadSlot
+	{
+		ThreadBuffer* buffer = nullptr;
+
+		ThreadBuffer* Get()
+		{
+			if(buffer != nullptr)
+				return buffer;
+
+			std::lock_guard<std::mutex> lock(threads_mutex);
+			for(auto& thread : threads)
+			{
+				if(!thread->in_use)
+				{
+					buffer = thread.get();
+					break;
+				}
+			}
+			if(buffer == nullptr)
+			{
+				threads.push_back(std::make_unique<ThreadBuffer>());
+				buffer = threads.back().get();
+				buffer->id = (uint32_t)threads.size() - 1;
+				buffer->name = "Thread " + std::to_string(buffer->id);
+			}
+			buffer->in_use = true;
+			return buffer;
+		}
+
+		~ThreadSlot()
+		{
+			if(buffer != nullptr)
+			{
+				std::lock_guard<std::mutex> lock(threads_mutex);
+				buffer->in_use = false;
+			}
+		}
+	};
+
+	thread_local ThreadSlot thread_slot;
+	thread_local uint32_t thread_depth = 0;
+	thread_local int64_t child_time_us[Profiler::kMaxDepth] = {};
+
+	double Milliseconds(int64_t us)
+	{
+		return us / 1000.0;
+	}
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	const bool was_enabled = enabled_.exchange(enabled, std::memory_order_relaxed);
+	if(enabled && !was_enabled)
+	{
+		// Drop frames and zones left over from the last time it was on, or the overlay and trace
+		// would run them together with new ones across the gap
+		for(Frame& frame : frames)
+		{
+			frame.zones.clear();
+		}
+		frame_index = 0;
+		frame_count = 0;
+
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		for(auto& thread : threads)
+		{
+			std::lock_guard<std::mutex> thread_lock(thread->mutex);
+			thread->zones.clear();
+		}
+		frame_start_us = 0;
+		frames_since_overlay_update = 0;
+		overlay_lines.clear();
+	}
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = thread_slot.Get();
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->name = name;
+}
+
+int64_t Profiler::NowMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Record(const Zone& zone)
+{
+	ThreadBuffer* buffer = thread_slot.Get();
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->zones.push_back(zone);
+}
+
+void Profiler::BeginFrame()
+{
+	if(!IsEnabled())
+		return;
+
+	const int64_t now_us = NowMicroseconds();
+	if(frame_start_us != 0)
+	{
+		EndFrame(now_us);
+	}
+	main_thread = thread_slot.Get()->id;
+	frame_start_us = now_us;
+}
+
+void Profiler::EndFrame(int64_t end_us)
+{
+	// Reuse the oldest frame's storage for this one
+	Frame& frame = frames[frame_index];
+	frame.start_us = frame_start_us;
+	frame.duration_us = end_us - frame_start_us;
+	frame.zones.clear();
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		for(auto& thread : threads)
+		{
+			std::lock_guard<std::mutex> thread_lock(thread->mutex);
+			frame.zones.insert(frame.zones.end(), thread->zones.begin(), thread->zones.end());
+			thread->zones.clear();
+		}
+	}
+
+	frame_index = (frame_index + 1) % kFrameHistory;
+	frame_count = std::min(frame_count + 1, kFrameHistory);
+
+	// Stats only need to change a couple of times a second to be readable
+	if(++frames_since_overlay_update >= 30 || overlay_lines.empty())
+	{
+		UpdateOverlay();
+		frames_since_overlay_update = 0;
+	}
+}
+
+void Profiler::UpdateOverlay()
+{
+	if(frame_count == 0)
+		return;
+
+	std::vector<int64_t> frame_times;
+	frame_times.reserve(frame_count);
+	struct ZoneTotal
+	{
+		const char* name;
+		int64_t self_us;
+	};
+	std::vector<ZoneTotal> totals;
+
+	for(int i = 0; i < frame_count; i++)
+	{
+		const Frame& frame = frames[i];
+		frame_times.push_back(frame.duration_us);
+		for(const Zone& zone : frame.zones)
+		{
+			auto total = std::find_if(totals.begin(), totals.end(), [&zone](const ZoneTotal& t) { return t.name == zone.name; });
+			if(total == totals.end())
+				totals.push_back({ zone.name, zone.self_us });
+			else
+				total->self_us += zone.self_us;
+		}
+	}
+
+	std::sort(frame_times.begin(), frame_times.end());
+	auto percentile = [&frame_times](double p)
+	{
+		return Milliseconds(frame_times[(size_t)(p * (frame_times.size() - 1) + 0.5)]);
+	};
+
+	char line[128];
+	overlay_lines.clear();
+	snprintf(line, sizeof(line), "frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+		percentile(0.5), percentile(0.95), percentile(0.99), Milliseconds(frame_times.back()));
+	overlay_lines.push_back(line);
+
+	// Self time, so parents don't just repeat the cost of their children
+	std::sort(totals.begin(), totals.end(), [](const ZoneTotal& a, const ZoneTotal& b) { return a.self_us > b.self_us; });
+	overlay_lines.push_back("top zones (self ms per frame)");
+	for(int i = 0; i < (int)totals.size() && i < 8; i++)
+	{
+		snprintf(line, sizeof(line), "%-28s %.3f", totals[i].name, Milliseconds(totals[i].self_us) / frame_count);
+		overlay_lines.push_back(line);
+	}
+}
+
+void Profiler::RenderOverlay(Overlay& overlay, float fps)
+{
+	if(!IsEnabled())
+		return;
+
+	PROFILE_ZONE("Profiler::RenderOverlay");
+	const float line_height = 24.f;
+	float y = 10.f;
+
+	char line[128];
+	snprintf(line, sizeof(line), "FPS %.1f", fps);
+	overlay.DrawText(gef::Vector4(10.f, y, -0.9f), 0.7f, 0xff00ff00, gef::TJ_LEFT, line, OverlayLayer::Debug);
+
+	// Last frame's, this one isn't submitted yet
+	y += line_height;
+	snprintf(line, sizeof(line), "overlay sprites %d  texture changes %d (unsorted %d)",
+		overlay.GetCommandCount(), overlay.GetTextureChanges(), overlay.GetUnsortedTextureChanges());
+	overlay.DrawText(gef::Vector4(10.f, y, -0.9f), 0.7f, 0xff00ff00, gef::TJ_LEFT, line, OverlayLayer::Debug);
+
+	for(const std::string& overlay_line : overlay_lines)
+	{
+		y += line_height;
+		overlay.DrawText(gef::Vector4(10.f, y, -0.9f), 0.7f, 0xff00ff00, gef::TJ_LEFT, overlay_line.c_str(), OverlayLayer::Debug);
+	}
+}
+
+bool Profiler::ExportChromeTrace(const char* filename)
+{
+	std::ofstream out(filename);
+	if(out.fail())
+		return false;
+
+	json events = json::array();
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		for(auto& thread : threads)
+		{
+			std::lock_guard<std::mutex> thread_lock(thread->mutex);
+			events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", thread->id}, {"args", { {"name", thread->name} }} });
+		}
+	}
+
+	// Oldest frame first
+	const int first = frame_count < kFrameHistory ? 0 : frame_index;
+	for(int i = 0; i < frame_count; i++)
+	{
+		const Frame& frame = frames[(first + i) % kFrameHistory];
+		events.push_back({ {"name", "Frame"}, {"cat", "frame"}, {"ph", "X"}, {"ts", frame.start_us}, {"dur", frame.duration_us}, {"pid", 1}, {"tid", main_thread} });
+		for(const Zone& zone : frame.zones)
+		{
+			events.push_back({ {"name", zone.name}, {"cat", "zone"}, {"ph", "X"}, {"ts", zone.start_us}, {"dur", zone.duration_us}, {"pid", 1}, {"tid", zone.thread} });
+		}
+	}
+
+	json trace;
+	trace["traceEvents"] = std::move(events);
+	trace["displayTimeUnit"] = "ms";
+	out << trace.dump();
+	return !out.fail();
+}
+
+ProfileZone::ProfileZone(const char* name)
+{
+	if(!Profiler::IsEnabled())
+		return;
+
+	name_ = name;
+	depth_ = thread_depth++;
+	if(depth_ < Profiler::kMaxDepth)
+		child_time_us[depth_] = 0;
+	start_us_ = Profiler::NowMicroseconds();
+}
+
+ProfileZone::~ProfileZone()
+{
+	if(name_ == nullptr)
+		return;
+
+	const int64_t duration_us = Profiler::NowMicroseconds() - start_us_;
+	thread_depth--;
+
+	int64_t self_us = duration_us;
+	if(depth_ < Profiler::kMaxDepth)
+		self_us -= child_time_us[depth_];
+	if(depth_ > 0 && depth_ - 1 < Profiler::kMaxDepth)
+		child_time_us[depth_ - 1] += duration_us;
+
+	Profiler::Record({ name_, start_us_, duration_us, self_us, thread_slot.Get()->id, depth_ });
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Overlay;
+
+// Scoped-zone profiler for finding where a frame goes.
+// While disabled a zone costs a single relaxed atomic load. While enabled, zones from every thread
+// are collected into a ring of the last kFrameHistory frames, which can be drawn as an overlay or
+// written out as Chrome trace events (open in chrome://tracing or ui.perfetto.dev)
+class Profiler
+{
+public:
+	static constexpr int kFrameHistory = 240;
+	static constexpr int kMaxDepth = 32;
+
+	struct Zone
+	{
+		const char* name;
+		int64_t start_us;
+		int64_t duration_us;
+		int64_t self_us;
+		uint32_t thread;
+		uint32_t depth;
+	};
+
+	static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+	static void SetEnabled(bool enabled);
+
+	// Name shown for the calling thread in traces
+	static void SetThreadName(const char* name);
+
+	// Called by the main loop at the start of each frame. Closes the previous frame,
+	// so frame times include presenting it
+	static void BeginFrame();
+
+	static bool ExportChromeTrace(const char* filename);
+	static void RenderOverlay(Overlay& overlay, float fps);
+
+	static int64_t NowMicroseconds();
+	static void Record(const Zone& zone);
+
+private:
+	static void EndFrame(int64_t end_us);
+	static void UpdateOverlay();
+
+	static std::atomic<bool> enabled_;
+};
+
+// Records the time spent in its scope as a zone, see PROFILE_ZONE
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name);
+	~ProfileZone();
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* name_ = nullptr;
+	int64_t start_us_ = 0;
+	uint32_t depth_ = 0;
+};
+
+#define PROFILE_ZONE_CONCAT_(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_(a, b)
+// Profiles the rest of the enclosing scope. name must outlive the profiler, use a string literal
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
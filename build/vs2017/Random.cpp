@@ -0,0 +1,31 @@
+#include "Random.h"
+
+uint32_t Random::seed_ = Random::NewSeed();
+std::mt19937 Random::generator_(Random::seed_);
+std::mutex Random::mutex_;
+
+void Random::Seed(uint32_t seed)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	seed_ = seed;
+	generator_.seed(seed_);
+}
+
+uint32_t Random::NewSeed()
+{
+	std::random_device rd;
+	return rd();
+}
+
+uint32_t Random::NextSeed()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return generator_();
+}
+
+float Random::Float()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::uniform_real_distribution dist(0.f, 1.f);
+	return dist(generator_);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+// Shared source of randomness for gameplay so that a recorded session can be replayed with the same seed
+class Random
+{
+public:
+	static void Seed(uint32_t seed);
+	static uint32_t GetSeed() { return seed_; }
+	static uint32_t NewSeed();
+	// Seed for a RandomStream, drawn from the shared sequence so a replay hands out the same ones
+	static uint32_t NextSeed();
+
+	// Uniform float in [0, 1)
+	static float Float();
+
+private:
+	static uint32_t seed_;
+	static std::mt19937 generator_;
+	static std::mutex mutex_;
+};
+
+// Sequence of its own, for something like a level that mustn't share one with anything running
+// beside it. Not safe to use from more than one thread at a time
+class RandomStream
+{
+public:
+	explicit RandomStream(uint32_t seed) { Seed(seed); }
+
+	void Seed(uint32_t seed)
+	{
+		seed_ = seed;
+		generator_.seed(seed);
+	}
+	uint32_t GetSeed() const { return seed_; }
+
+	// Uniform float in [0, 1)
+	float Float()
+	{
+		std::uniform_real_distribution dist(0.f, 1.f);
+		return dist(generator_);
+	}
+
+private:
+	uint32_t seed_ = 0;
+	std::mt19937 generator_;
+};
@@ -0,0 +1,123 @@
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Profiler.h"
+#include "graphics/mesh.h"
+#include "graphics/primitive.h"
+#include "graphics/renderer_3d.h"
+
+int RenderSnapshot::submitted_triangles_ = 0;
+
+namespace
+{
+	int TriangleCount(const gef::Mesh* mesh)
+	{
+		if(mesh == nullptr)
+			return 0;
+		int triangles = 0;
+		for(UInt32 primitive = 0; primitive < mesh->num_primitives(); primitive++)
+			triangles += mesh->GetPrimitive(primitive)->num_indices() / 3;
+		return triangles;
+	}
+}
+
+void RenderSnapshot::Begin(const gef::Matrix44& projection, const gef::Matrix44& view)
+{
+	valid_ = true;
+	projection_ = projection;
+	view_ = view;
+	override_material_ = nullptr;
+	meshes_.clear();
+	triangle_count_ = 0;
+	std::fill(std::begin(lod_counts_), std::end(lod_counts_), 0);
+	sprites_.clear();
+	text_count_ = 0;
+}
+
+void RenderSnapshot::DrawMesh(const gef::MeshInstance& instance)
+{
+	meshes_.push_back({ instance, override_material_ });
+	triangle_count_ += TriangleCount(instance.mesh());
+}
+
+void RenderSnapshot::DrawMesh(const gef::MeshInstance& instance, const MeshLods* lods)
+{
+	if(lods == nullptr || lods->count == 0)
+	{
+		DrawMesh(instance);
+		return;
+	}
+
+	const int level = lods->Select(ScreenSize(*lods->meshes[0], instance.transform()));
+	meshes_.push_back({ instance, override_material_ });
+	meshes_.back().instance.set_mesh(lods->meshes[level]);
+	triangle_count_ += lods->triangle_counts[level];
+	lod_counts_[level]++;
+}
+
+float RenderSnapshot::ScreenSize(const gef::Mesh& mesh, const gef::Matrix44& transform) const
+{
+	// The screen is 2 / m(1, 1) of the depth tall, so this is the sphere's diameter over that
+	const gef::Sphere& sphere = mesh.bounding_sphere();
+	const gef::Vector4 centre = sphere.position().Transform(transform).Transform(view_);
+	const float depth = std::fabs(centre.z());
+	if(depth <= sphere.radius())
+		return 1.f;
+	return sphere.radius() * projection_.m(1, 1) / depth;
+}
+
+void RenderSnapshot::DrawSprite(const gef::Sprite& sprite, OverlayLayer layer)
+{
+	sprites_.push_back({ sprite, layer });
+}
+
+void RenderSnapshot::DrawText(const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, const char* text, OverlayLayer layer)
+{
+	if(text_count_ == texts_.size())
+		texts_.emplace_back();
+
+	TextEntry& entry = texts_[text_count_++];
+	entry.position = position;
+	entry.scale = scale;
+	entry.colour = colour;
+	entry.justification = justification;
+	entry.text = text;
+	entry.layer = layer;
+}
+
+void RenderSnapshot::Submit(gef::Renderer3D* renderer_3d, Overlay& overlay) const
+{
+	PROFILE_ZONE("RenderSnapshot::Submit");
+
+	submitted_triangles_ = triangle_count_;
+
+	renderer_3d->set_projection_matrix(projection_);
+	renderer_3d->set_view_matrix(view_);
+
+	const gef::Material* override_material = nullptr;
+	renderer_3d->set_override_material(nullptr);
+	renderer_3d->Begin();
+		for(const MeshEntry& entry : meshes_)
+		{
+			if(entry.override_material != override_material)
+			{
+				override_material = entry.override_material;
+				renderer_3d->set_override_material(override_material);
+			}
+			renderer_3d->DrawMesh(entry.instance);
+		}
+	renderer_3d->End();
+	renderer_3d->set_override_material(nullptr);
+
+	for(const SpriteEntry& entry : sprites_)
+	{
+		overlay.DrawSprite(entry.sprite, entry.layer);
+	}
+	for(size_t i = 0; i < text_count_; i++)
+	{
+		const TextEntry& entry = texts_[i];
+		overlay.DrawText(entry.position, entry.scale, entry.colour, entry.justification, entry.text.c_str(), entry.layer);
+	}
+}
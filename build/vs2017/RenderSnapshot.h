@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "MeshLod.h"
+#include "Overlay.h"
+#include "graphics/mesh_instance.h"
+#include "maths/matrix44.h"
+
+namespace gef
+{
+	class Material;
+	class Renderer3D;
+}
+
+// Everything a level needs to draw one frame, copied out at the end of its update so rendering
+// never reads live game objects. Meshes and materials are only pointed to, they belong to the level.
+// Begin keeps the storage of the last frame, so once the buffers have grown taking a snapshot doesn't allocate
+class RenderSnapshot
+{
+public:
+	void Begin(const gef::Matrix44& projection, const gef::Matrix44& view);
+	bool IsValid() const { return valid_; }
+	void Invalidate() { valid_ = false; }
+
+	// Applies to every mesh drawn after it, like gef::Renderer3D::set_override_material
+	void SetOverrideMaterial(const gef::Material* material) { override_material_ = material; }
+	void DrawMesh(const gef::MeshInstance& instance);
+	// Draws the level of lods that suits how much of the screen the instance covers, or the
+	// instance's own mesh when lods is null
+	void DrawMesh(const gef::MeshInstance& instance, const MeshLods* lods);
+	void DrawSprite(const gef::Sprite& sprite, OverlayLayer layer = OverlayLayer::Sprites);
+	void DrawText(const gef::Vector4& position, float scale, unsigned int colour, gef::TextJustification justification, const char* text, OverlayLayer layer = OverlayLayer::Text);
+
+	// The 3D pass goes straight to the renderer, sprites and text to the overlay
+	void Submit(gef::Renderer3D* renderer_3d, Overlay& overlay) const;
+
+	int GetMeshCount() const { return (int)meshes_.size(); }
+	int GetTriangleCount() const { return triangle_count_; }
+	// Of the meshes drawn through LODs, how many were drawn at each level
+	int GetLodCount(int level) const { return lod_counts_[level]; }
+	// Triangles in the last snapshot submitted, whichever one it was
+	static int GetSubmittedTriangles() { return submitted_triangles_; }
+
+private:
+	float ScreenSize(const gef::Mesh& mesh, const gef::Matrix44& transform) const;
+
+	struct MeshEntry
+	{
+		gef::MeshInstance instance;
+		const gef::Material* override_material;
+	};
+
+	struct SpriteEntry
+	{
+		gef::Sprite sprite;
+		OverlayLayer layer;
+	};
+
+	struct TextEntry
+	{
+		gef::Vector4 position;
+		float scale;
+		unsigned int colour;
+		gef::TextJustification justification;
+		std::string text;
+		OverlayLayer layer;
+	};
+
+	bool valid_ = false;
+	gef::Matrix44 projection_;
+	gef::Matrix44 view_;
+	const gef::Material* override_material_ = nullptr;
+	std::vector<MeshEntry> meshes_;
+	int triangle_count_ = 0;
+	int lod_counts_[MeshLods::kMaxLevels] = {};
+	std::vector<SpriteEntry> sprites_;
+	// Never shrunk, so each string keeps its capacity for next frame
+	std::vector<TextEntry> texts_;
+	size_t text_count_ = 0;
+
+	static int submitted_triangles_;
+};
@@ -4,12 +4,6 @@
 namespace gef
 {
 	class Platform;
-	class Font;
-}
-
-namespace gef
-{
-	class SpriteRenderer;
 }
 
 namespace gef
@@ -18,15 +12,19 @@ namespace gef
 }
 
 class InputActionManager;
+class Overlay;
 
 class Scene
 {
 public:
 	Scene(gef::Platform& platform, StateManager& state_manager) : platform_(&platform), state_manager_(&state_manager) {}
+	virtual ~Scene() = default;
 	virtual void Update(InputActionManager* iam, float frame_time) = 0;
 	virtual void Render(gef::Renderer3D* renderer_3d) = 0;
-	virtual void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) = 0;
-	virtual void Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font) = 0;
+	virtual void Render(Overlay& overlay) = 0;
+	virtual void Render(gef::Renderer3D* renderer_3d, Overlay& overlay) = 0;
+	// The next update makes scenes or starts loads, so can't run alongside a render
+	virtual bool NeedsMainThread() const { return false; }
 protected:
 	void NextScene() {state_manager_->NextScene();}
 	gef::Platform* platform_;
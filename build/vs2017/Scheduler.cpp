@@ -0,0 +1,173 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+void WaitSeconds::await_suspend(std::coroutine_handle<Task::promise_type> handle) const
+{
+	handle.promise().scheduler->Sleep(handle.promise().id, seconds);
+}
+
+void NextFrame::await_suspend(std::coroutine_handle<Task::promise_type> handle)
+{
+	scheduler = handle.promise().scheduler;
+	scheduler->WaitForNextFrame(handle.promise().id);
+}
+
+float NextFrame::await_resume() const
+{
+	return scheduler->GetFrameTime();
+}
+
+Scheduler::~Scheduler()
+{
+	CancelAll();
+}
+
+TaskHandle Scheduler::Start(Task task)
+{
+	std::coroutine_handle<Task::promise_type> handle = task.handle_;
+	task.handle_ = nullptr;
+
+	const uint32_t id = next_id_++;
+	handle.promise().scheduler = this;
+	handle.promise().id = id;
+	tasks_[id] = handle;
+
+	Resume(id);
+	return { id };
+}
+
+void Scheduler::Cancel(TaskHandle& handle)
+{
+	if(handle.id == running_id_ && running_id_ != 0)
+	{
+		// Can't pull the frame out from under itself, it goes once it next suspends
+		cancel_running_ = true;
+	}
+	else
+	{
+		Destroy(handle.id);
+	}
+	handle.id = 0;
+}
+
+bool Scheduler::IsRunning(TaskHandle handle) const
+{
+	return tasks_.find(handle.id) != tasks_.end();
+}
+
+void Scheduler::CancelAll()
+{
+	for(auto& task : tasks_)
+	{
+		if(task.first == running_id_)
+		{
+			cancel_running_ = true;
+			continue;
+		}
+		task.second.destroy();
+	}
+
+	const auto running = tasks_.find(running_id_);
+	if(running != tasks_.end())
+	{
+		const std::coroutine_handle<Task::promise_type> handle = running->second;
+		tasks_.clear();
+		tasks_[running_id_] = handle;
+	}
+	else
+	{
+		tasks_.clear();
+	}
+
+	// Whatever is left in the wheel refers to tasks that are gone, and is skipped when it comes up
+	next_frame_.clear();
+}
+
+void Scheduler::Update(float frame_time)
+{
+	frame_time_ = frame_time;
+
+	// Taken first, so anything that asks for the next frame while this one runs gets the next one
+	due_.swap(next_frame_);
+	next_frame_.clear();
+	for(uint32_t id : due_)
+	{
+		Resume(id);
+	}
+	due_.clear();
+
+	tick_time_ += frame_time;
+	while(tick_time_ >= tick_length_)
+	{
+		tick_time_ -= tick_length_;
+		current_tick_++;
+
+		std::vector<Timer>& slot = wheel_[current_tick_ % wheel_size_];
+		for(size_t i = 0; i < slot.size();)
+		{
+			if(slot[i].rounds > 0)
+			{
+				slot[i].rounds--;
+				i++;
+				continue;
+			}
+
+			due_.push_back(slot[i].id);
+			slot[i] = slot.back();
+			slot.pop_back();
+		}
+
+		for(uint32_t id : due_)
+		{
+			Resume(id);
+		}
+		due_.clear();
+	}
+}
+
+void Scheduler::Sleep(uint32_t id, float seconds)
+{
+	// Part of the next tick has already gone by
+	const uint64_t ticks = std::max<uint64_t>(1, (uint64_t)std::ceil((seconds + tick_time_) / tick_length_));
+	wheel_[(current_tick_ + ticks) % wheel_size_].push_back({ id, (uint32_t)((ticks - 1) / wheel_size_) });
+}
+
+void Scheduler::WaitForNextFrame(uint32_t id)
+{
+	next_frame_.push_back(id);
+}
+
+void Scheduler::Resume(uint32_t id)
+{
+	const auto task = tasks_.find(id);
+	if(task == tasks_.end())
+		return;
+
+	const std::coroutine_handle<Task::promise_type> handle = task->second;
+	const uint32_t outer_id = running_id_;
+	const bool outer_cancel = cancel_running_;
+	running_id_ = id;
+	cancel_running_ = false;
+
+	handle.resume();
+
+	const bool finished = handle.done() || cancel_running_;
+	running_id_ = outer_id;
+	cancel_running_ = outer_cancel;
+	if(finished)
+	{
+		Destroy(id);
+	}
+}
+
+void Scheduler::Destroy(uint32_t id)
+{
+	const auto task = tasks_.find(id);
+	if(task == tasks_.end())
+		return;
+
+	task->second.destroy();
+	tasks_.erase(task);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+class Scheduler;
+
+// A coroutine run by a Scheduler on the game clock.
+// Write one as a function returning Task that co_awaits WaitSeconds or NextFrame,
+// then hand it to Scheduler::Start
+class Task
+{
+public:
+	struct promise_type
+	{
+		Scheduler* scheduler = nullptr;
+		uint32_t id = 0;
+
+		Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	Task(Task&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	~Task() { if(handle_) handle_.destroy(); }
+
+private:
+	friend class Scheduler;
+	explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+	std::coroutine_handle<promise_type> handle_;
+};
+
+// Refers to a started task. Stays safe to use once the task has finished or been cancelled
+struct TaskHandle
+{
+	uint32_t id = 0;
+};
+
+// co_await WaitSeconds(t) resumes the task once t seconds of game time have gone by
+struct WaitSeconds
+{
+	explicit WaitSeconds(float seconds) : seconds(seconds) {}
+	bool await_ready() const { return seconds <= 0.f; }
+	void await_suspend(std::coroutine_handle<Task::promise_type> handle) const;
+	void await_resume() const {}
+
+	float seconds;
+};
+
+// co_await NextFrame() resumes the task on the next Scheduler::Update and gives back that frame's time
+struct NextFrame
+{
+	bool await_ready() const { return false; }
+	void await_suspend(std::coroutine_handle<Task::promise_type> handle);
+	float await_resume() const;
+
+	Scheduler* scheduler = nullptr;
+};
+
+// Runs tasks on the main update against the game clock, so nothing runs while the game is paused.
+// Sleeping tasks sit in a timer wheel of tick_length_ slots, waits longer than the wheel
+// go round it more than once
+class Scheduler
+{
+public:
+	Scheduler() = default;
+	~Scheduler();
+	Scheduler(const Scheduler&) = delete;
+	Scheduler& operator=(const Scheduler&) = delete;
+
+	// Runs task up to its first co_await
+	TaskHandle Start(Task task);
+	void Cancel(TaskHandle& handle);
+	bool IsRunning(TaskHandle handle) const;
+	void CancelAll();
+
+	// Moves the game clock on by frame_time and resumes every task that's due
+	void Update(float frame_time);
+	float GetFrameTime() const { return frame_time_; }
+
+private:
+	friend struct WaitSeconds;
+	friend struct NextFrame;
+
+	struct Timer
+	{
+		uint32_t id;
+		uint32_t rounds;
+	};
+
+	static constexpr int wheel_size_ = 256;
+	static constexpr float tick_length_ = 1.f / 60.f;
+
+	void Sleep(uint32_t id, float seconds);
+	void WaitForNextFrame(uint32_t id);
+	void Resume(uint32_t id);
+	void Destroy(uint32_t id);
+
+	std::unordered_map<uint32_t, std::coroutine_handle<Task::promise_type>> tasks_;
+	uint32_t next_id_ = 1;
+	uint32_t running_id_ = 0;
+	bool cancel_running_ = false;
+
+	std::array<std::vector<Timer>, wheel_size_> wheel_;
+	uint64_t current_tick_ = 0;
+	float tick_time_ = 0.f;
+	float frame_time_ = 0.f;
+
+	std::vector<uint32_t> next_frame_;
+	std::vector<uint32_t> due_;
+};
@@ -0,0 +1,29 @@
+#include "SimulationTimings.h"
+
+thread_local SimulationTimings* SimulationTimings::active_ = nullptr;
+thread_local ScopedSimulationTimer* ScopedSimulationTimer::current_ = nullptr;
+
+ScopedSimulationTimer::ScopedSimulationTimer(const char* zone_name, double SimulationTimings::* field)
+	: zone_(zone_name), timings_(SimulationTimings::Active()), field_(field)
+{
+	if(timings_ == nullptr)
+		return;
+
+	parent_ = current_;
+	current_ = this;
+	start_ = std::chrono::steady_clock::now();
+}
+
+ScopedSimulationTimer::~ScopedSimulationTimer()
+{
+	if(timings_ == nullptr)
+		return;
+
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	timings_->*field_ += elapsed - nested_time_;
+	if(parent_ != nullptr)
+	{
+		parent_->nested_time_ += elapsed;
+	}
+	current_ = parent_;
+}
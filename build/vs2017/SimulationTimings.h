@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+
+#include "Profiler.h"
+
+// Seconds spent in each part of Level::Update for one frame.
+// Only filled in while a harness has attached one to the level, see Level::SetTimings
+struct SimulationTimings
+{
+	double streaming = 0.0;
+	double physics = 0.0;
+	double player = 0.0;
+	double plates = 0.0;
+	double timers = 0.0;
+	double dynamic_objects = 0.0;
+	double enemies = 0.0;
+	double bullets = 0.0;
+	double cleanup = 0.0;
+	double hud = 0.0;
+	double camera = 0.0;
+
+	// Timings being filled in on this thread, nullptr when nobody is measuring
+	static SimulationTimings* Active() { return active_; }
+	static void SetActive(SimulationTimings* timings) { active_ = timings; }
+
+private:
+	static thread_local SimulationTimings* active_;
+};
+
+// Adds the time spent in its scope to one field of the active timings.
+// Time spent in nested timers is only counted once, in the innermost one.
+// The scope is also a profiler zone called zone_name
+class ScopedSimulationTimer
+{
+public:
+	ScopedSimulationTimer(const char* zone_name, double SimulationTimings::* field);
+	~ScopedSimulationTimer();
+	ScopedSimulationTimer(const ScopedSimulationTimer&) = delete;
+	ScopedSimulationTimer& operator=(const ScopedSimulationTimer&) = delete;
+
+private:
+	ProfileZone zone_;
+	SimulationTimings* timings_ = nullptr;
+	double SimulationTimings::* field_ = nullptr;
+	std::chrono::steady_clock::time_point start_;
+	double nested_time_ = 0.0;
+	ScopedSimulationTimer* parent_ = nullptr;
+
+	static thread_local ScopedSimulationTimer* current_;
+};
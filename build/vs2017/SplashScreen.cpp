@@ -2,8 +2,8 @@
 
 #include "Image.h"
 #include "InputActionManager.h"
+#include "Overlay.h"
 #include "UIElement.h"
-#include "graphics/sprite_renderer.h"
 
 void SplashScreen::AddUIElement(UIElement* element)
 {
@@ -40,17 +40,16 @@ void SplashScreen::Update(InputActionManager* iam, float frame_time)
 	}
 }
 
-void SplashScreen::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void SplashScreen::Render(Overlay& overlay)
 {
 	if(!ui_elements_.empty())
 	{
-		sprite_renderer->Begin(true);
+		overlay.Clear();
 		if(background_ != nullptr)
 		{
-			background_->Render(sprite_renderer, font);
+			background_->Render(overlay);
 		}
-		ui_elements_.front()->Render(sprite_renderer, font);
-		sprite_renderer->End();
+		ui_elements_.front()->Render(overlay);
 	}
 }
 
@@ -10,9 +10,9 @@ public:
 	SplashScreen(gef::Platform& platform, StateManager& state_manager) : Scene(platform, state_manager) {}
 	void AddUIElement(UIElement* element);
 	void Update(InputActionManager* iam, float frame_time) override;
-	void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) override;
+	void Render(Overlay& overlay) override;
 	void Render(gef::Renderer3D* renderer_3d) override {}
-	void Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font) override {Render(sprite_renderer, font);}
+	void Render(gef::Renderer3D* renderer_3d, Overlay& overlay) override {Render(overlay);}
 	void SetBkg(Image* image);
 
 private:
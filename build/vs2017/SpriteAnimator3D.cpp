@@ -1,13 +1,16 @@
 #include "SpriteAnimator3D.h"
 #include <graphics/primitive.h>
 #include <graphics/texture.h>
-#include <assets/png_loader.h>
-#include <graphics/image_data.h>
 #include <graphics/material.h>
-#include <graphics/image_data.h>
+#include <algorithm>
 #include <filesystem>
 #include <string>
+#include <vector>
 #include "system/debug_log.h"
+#include "AssetFile.h"
+#include "CookedTexture.h"
+#include "LoaderService.h"
+#include "Profiler.h"
 
 namespace fs = std::filesystem;
 
@@ -33,18 +36,30 @@ void SpriteAnimator3D::Init() {
 }
 
 void SpriteAnimator3D::AddAnimation(const char* anim_name, const char* folder_name, float speed, bool looping) {
+	PROFILE_ZONE("SpriteAnimator3D::AddAnimation");
 	animations_[anim_name].frame_speed_ = speed;
 	animations_[anim_name].looping_ = looping;
-	gef::PNGLoader png_loader;	
-	for (auto& entry : fs::directory_iterator(folder_name)) {
-		std::filesystem::path outfilename = entry.path();
-		std::string outfilename_str = outfilename.string();
+	// Frames can be PNGs on disk or cooked beside them, or only cooked in the pack, so each is
+	// loaded by its PNG name once, in name order
+	std::vector<std::string> frame_names;
+	for (const std::string& name : AssetFiles::List(folder_name)) {
+		fs::path frame = fs::path(name);
+		if (frame.extension() != ".png" && frame.extension() != ".tex")
+			continue;
+		frame_names.push_back(frame.replace_extension(".png").string());
+	}
+	std::sort(frame_names.begin(), frame_names.end());
+	frame_names.erase(std::unique(frame_names.begin(), frame_names.end()), frame_names.end());
+
+	for (const std::string& frame_name : frame_names) {
+		std::string outfilename_str = (fs::path(folder_name) / frame_name).string();
 		const char* path = outfilename_str.c_str();
 		
-		gef::ImageData image_data;
-		png_loader.Load(path, *platform_, image_data);
-		if (image_data.image() != NULL) {
-			gef::Texture* texture = gef::Texture::Create(*platform_, image_data);
+		TextureImage image;
+		if (image.Load(path, *platform_)) {
+			const gef::ImageData& image_data = image.GetImageData();
+			gef::Texture* texture = nullptr;
+			LoadContext::RunGPUUpload([&] { texture = gef::Texture::Create(*platform_, image_data); }, image_data.width() * image_data.height() * 4);
 			gef::Material* material = new gef::Material();
 			material->set_texture(texture);
 			
@@ -79,11 +94,11 @@ const gef::Mesh* SpriteAnimator3D::UpdateAnimation(float& time, const gef::Mesh*
 }
 
 gef::Mesh* SpriteAnimator3D::CreateMesh(const char* filepath, const gef::Vector4& half_size, gef::Vector4 centre) {
-	gef::PNGLoader png_loader;
-	gef::ImageData image_data;
-	png_loader.Load(filepath, *platform_, image_data);
-	if (image_data.image() != NULL) {
-		gef::Texture* texture = gef::Texture::Create(*platform_, image_data);
+	TextureImage image;
+	if (image.Load(filepath, *platform_)) {
+		const gef::ImageData& image_data = image.GetImageData();
+		gef::Texture* texture = nullptr;
+		LoadContext::RunGPUUpload([&] { texture = gef::Texture::Create(*platform_, image_data); }, image_data.width() * image_data.height() * 4);
 		gef::Material* material = new gef::Material();
 		material->set_texture(texture);
 
@@ -94,10 +109,12 @@ gef::Mesh* SpriteAnimator3D::CreateMesh(const char* filepath, const gef::Vector4
 }
 
 gef::Texture* SpriteAnimator3D::CreateTexture(const char* filepath, gef::Platform* platform) {
-	gef::PNGLoader png_loader;
-	gef::ImageData image_data;
-	png_loader.Load(filepath, *platform, image_data);
-	gef::Texture* texture = gef::Texture::Create(*platform, image_data);
+	PROFILE_ZONE("SpriteAnimator3D::CreateTexture");
+	TextureImage image;
+	image.Load(filepath, *platform);
+	const gef::ImageData& image_data = image.GetImageData();
+	gef::Texture* texture = nullptr;
+	LoadContext::RunGPUUpload([&] { texture = gef::Texture::Create(*platform, image_data); }, image_data.width() * image_data.height() * 4);
 	return texture;
 }
 
@@ -0,0 +1,70 @@
+#include "StartupTimeline.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "json.h"
+#include "system/debug_log.h"
+
+std::mutex StartupTimeline::mutex_;
+bool StartupTimeline::begun_ = false;
+std::chrono::steady_clock::time_point StartupTimeline::begin_;
+std::vector<StartupTimeline::Point> StartupTimeline::points_;
+
+void StartupTimeline::Begin()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	begun_ = true;
+	begin_ = std::chrono::steady_clock::now();
+	points_.clear();
+}
+
+void StartupTimeline::Mark(const char* name)
+{
+	const auto now = std::chrono::steady_clock::now();
+	double ms = 0.0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!begun_)
+		{
+			begun_ = true;
+			begin_ = now;
+		}
+		for (const Point& point : points_)
+		{
+			if (std::strcmp(point.name, name) == 0)
+				return;
+		}
+		ms = std::chrono::duration<double, std::milli>(now - begin_).count();
+		points_.push_back({ name, ms });
+	}
+	gef::DebugOut("Startup: %s at %.1f ms\n", name, ms);
+}
+
+double StartupTimeline::GetMs(const char* name)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (const Point& point : points_)
+	{
+		if (std::strcmp(point.name, name) == 0)
+			return point.ms;
+	}
+	return -1.0;
+}
+
+bool StartupTimeline::Write(const char* filename)
+{
+	nlohmann::json timeline = nlohmann::json::array();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const Point& point : points_)
+			timeline.push_back({ { "name", point.name }, { "ms", point.ms } });
+	}
+
+	std::ofstream file(filename);
+	if (!file)
+		return false;
+	file << timeline.dump(1, '\t') << std::endl;
+	return (bool)file;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// How long after launch the game gets to each point of its startup, like the first frame and the
+// main menu taking input. Each point is only recorded the first time it's reached
+class StartupTimeline
+{
+public:
+	// Where times are measured from, call first thing in main. Otherwise it's the first Mark
+	static void Begin();
+	// name must outlive the timeline, use a string literal. Safe from any thread
+	static void Mark(const char* name);
+	// Milliseconds from Begin to name, negative if it hasn't been reached
+	static double GetMs(const char* name);
+	static bool Write(const char* filename);
+
+private:
+	struct Point
+	{
+		const char* name;
+		double ms;
+	};
+
+	static std::mutex mutex_;
+	static bool begun_;
+	static std::chrono::steady_clock::time_point begin_;
+	static std::vector<Point> points_;
+};
@@ -3,35 +3,45 @@
 #include "Level.h"
 #include "LoadingScreen.h"
 #include "Menu.h"
+#include "InputActionManager.h"
+#include "Profiler.h"
+#include "RenderSnapshot.h"
 #include "Scene.h"
+#include "StartupTimeline.h"
 #include "SplashScreen.h"
-#include "audio/audio_manager.h"
 #include "system/debug_log.h"
 
-StateManager::StateManager(LoadingScreen* loading_screen, bool* should_run, gef::AudioManager* audio_manager, gef::Platform* platform)
+StateManager::StateManager(LoadingScreen* loading_screen, bool* should_run, AudioSystem* audio_manager, gef::Platform* platform)
 	: loading_screen_(loading_screen),
 	should_run_(should_run),
 	audio_manager_(audio_manager),
 	platform_(platform)
 {
-	audio_manager_->LoadMusic("sounds/Karl Casey - Deception.ogg", *platform_); // found here: https://karlcasey.bandcamp.com/track/lethal
-	gef::VolumeInfo music_volume_info;
-	audio_manager_->GetMusicVolumeInfo(music_volume_info);
-	music_volume_info.volume = 20.f;
-	audio_manager_->SetMusicVolumeInfo(music_volume_info);
-	audio_manager_->PlayMusic();
 }
 
 void StateManager::Update(InputActionManager* iam, float frame_time)
 {
+	PROFILE_ZONE("StateManager::Update");
+
 	if(is_loading_ && loading_screen_ != nullptr)
 	{
+		// Back out to the main menu rather than wait for the level
+		if(iam->isPressed(Pause))
+		{
+			SwitchToMainMenu();
+			return;
+		}
 		loading_screen_->Update(iam, frame_time);
 	}
 	else if(on_splash_screen_ && splash_screen_ != nullptr)
 	{
 		splash_screen_->Update(iam, frame_time);
 	}
+	else if(on_main_menu_ && main_menu_ == nullptr && loading_screen_ != nullptr)
+	{
+		// The splash screen was skipped before the menus were built
+		loading_screen_->Update(iam, frame_time);
+	}
 	else if(on_main_menu_ && main_menu_ != nullptr)
 	{
 		if(main_menu_fade_timer_ < main_menu_fade_speed_)
@@ -43,6 +53,7 @@ void StateManager::Update(InputActionManager* iam, float frame_time)
 		}
 		else
 		{
+			StartupTimeline::Mark("main_menu_interactive");
 			main_menu_->Update(iam, frame_time);
 		}
 	}
@@ -60,30 +71,73 @@ void StateManager::Render(gef::Renderer3D* renderer_3d)
 {
 }
 
-void StateManager::Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font)
+void StateManager::Render(gef::Renderer3D* renderer_3d, Overlay& overlay)
 {
+	PROFILE_ZONE("StateManager::Render");
+
 	if(is_loading_ && loading_screen_ != nullptr)
 	{
-		loading_screen_->Render(renderer_3d, sprite_renderer, font);
+		loading_screen_->Render(renderer_3d, overlay);
 	}
 	else if(on_splash_screen_ && splash_screen_ != nullptr)
 	{
-		splash_screen_->Render(renderer_3d, sprite_renderer, font);
+		splash_screen_->Render(renderer_3d, overlay);
+	}
+	else if(on_main_menu_ && main_menu_ == nullptr && loading_screen_ != nullptr)
+	{
+		loading_screen_->Render(renderer_3d, overlay);
 	}
 	else if(on_main_menu_ && main_menu_ != nullptr)
 	{
-		main_menu_->Render(renderer_3d, sprite_renderer, font);
+		main_menu_->Render(renderer_3d, overlay);
 	}
 	else if(on_settings_menu_ && settings_menu_ != nullptr)
 	{
-		settings_menu_->Render(renderer_3d, sprite_renderer, font);
+		settings_menu_->Render(renderer_3d, overlay);
 	}
 	else if(current_scene_ != nullptr)
 	{
-		current_scene_->Render(renderer_3d, sprite_renderer, font);
+		current_scene_->Render(renderer_3d, overlay);
 	}
 }
 
+void StateManager::UpdateLoads()
+{
+	loader_.Update();
+}
+
+bool StateManager::NeedsMainThread() const
+{
+	return current_scene_ != nullptr && current_scene_->NeedsMainThread();
+}
+
+bool StateManager::BuildSnapshot(RenderSnapshot& snapshot) const
+{
+	// The pause menu is drawn live over the level, so a paused level isn't snapshotted either
+	const Level* level = nullptr;
+	if(!is_loading_ && !on_splash_screen_ && !on_main_menu_ && !on_settings_menu_)
+	{
+		level = dynamic_cast<const Level*>(current_scene_);
+	}
+	if(level == nullptr || level->IsPaused())
+	{
+		snapshot.Invalidate();
+		return false;
+	}
+
+	level->BuildSnapshot(snapshot);
+	return true;
+}
+
+void StateManager::DeleteRetiredScenes()
+{
+	for(Scene* scene : retired_scenes_)
+	{
+		delete scene;
+	}
+	retired_scenes_.clear();
+}
+
 void StateManager::PushScene(Scene* scene)
 {
 	scenes_.push(scene);
@@ -94,15 +148,146 @@ void StateManager::PushLevel(Level* level, const char* file_name, OBJMeshLoader&
 {
 	level->SetPauseMenu(pause_menu_);
 
-	loading_thread_ = std::thread([this, level, file_name, &mesh_loader]
+	// Set before the load starts so the very next frame already sees the loading screen
+	is_loading_ = true;
+	loading_level_ = level;
+	if(loading_screen_ != nullptr)
+	{
+		loading_screen_->SetStatusText("Loading...");
+	}
+
+	loading_task_ = SubmitLevelLoad(level, file_name, mesh_loader, LoadPriority::Normal);
+	scenes_.push(level);
+	current_scene_ = scenes_.front();
+}
+
+void StateManager::PrefetchLevel(Level* level, const char* file_name, OBJMeshLoader& mesh_loader)
+{
+	if(prefetch_budget_ == 0 || prefetch_file_ == file_name)
+	{
+		delete level;
+		return;
+	}
+
+	CancelPrefetch();
+	prefetch_level_ = level;
+	prefetch_file_ = file_name;
+	prefetch_task_ = SubmitLevelLoad(level, file_name, mesh_loader, LoadPriority::Background);
+}
+
+bool StateManager::PushPrefetchedLevel(const char* file_name)
+{
+	if(prefetch_level_ == nullptr || prefetch_file_ != file_name)
+	{
+		return false;
+	}
+
+	// Went over budget or failed, and the main thread hasn't heard yet
+	if(prefetch_task_ != nullptr && prefetch_task_->IsDone() && prefetch_task_->GetStatus() != LoadStatus::Completed)
+	{
+		CancelPrefetch();
+		return false;
+	}
+
+	Level* level = prefetch_level_;
+	prefetch_level_ = nullptr;
+	prefetch_file_.clear();
+	level->SetPauseMenu(pause_menu_);
+
+	// Still going, so finish it as a normal load behind the loading screen
+	if(prefetch_task_ != nullptr)
 	{
+		prefetch_task_->Promote();
+		loading_task_ = std::move(prefetch_task_);
+		loading_level_ = level;
 		is_loading_ = true;
-		level->LoadFromFile(file_name, loading_screen_, mesh_loader);
-		is_loading_ = false;
-	});
-	loading_thread_.detach();
+		if(loading_screen_ != nullptr)
+		{
+			loading_screen_->SetStatusText("Loading...");
+		}
+	}
+
 	scenes_.push(level);
 	current_scene_ = scenes_.front();
+	return true;
+}
+
+void StateManager::CancelPrefetch()
+{
+	if(prefetch_task_ != nullptr)
+	{
+		// Deleted once its load has stopped
+		prefetch_task_->Cancel();
+		prefetch_task_.reset();
+	}
+	else
+	{
+		delete prefetch_level_;
+	}
+	prefetch_level_ = nullptr;
+	prefetch_file_.clear();
+}
+
+std::shared_ptr<LoadTask> StateManager::SubmitLevelLoad(Level* level, const char* file_name, OBJMeshLoader& mesh_loader, LoadPriority priority)
+{
+	// The caller's string may not outlive the load
+	const std::string level_file = file_name;
+	return loader_.Submit(level_file, [level, level_file, &mesh_loader](LoadContext& context)
+	{
+		level->LoadFromFile(level_file.c_str(), context, mesh_loader);
+	},
+	[this, level](const LoadEvent& event)
+	{
+		OnLevelLoadEvent(level, event);
+	},
+	priority, priority == LoadPriority::Background ? prefetch_budget_ : 0);
+}
+
+void StateManager::OnLevelLoadEvent(Level* level, const LoadEvent& event)
+{
+	if(level == loading_level_)
+	{
+		if(event.type == LoadEvent::Type::StageStarted)
+		{
+			if(loading_screen_ != nullptr)
+			{
+				loading_screen_->SetStatusText(event.stage);
+			}
+			return;
+		}
+
+		loading_task_.reset();
+		loading_level_ = nullptr;
+		is_loading_ = false;
+		if(event.status == LoadStatus::Failed)
+		{
+			gef::DebugOut((std::string("Failed to load ") + level->GetFileName() + ": " + event.error + "\n").c_str());
+			SwitchToMainMenu();
+		}
+	}
+	else if(level == prefetch_level_)
+	{
+		if(event.type != LoadEvent::Type::Finished)
+		{
+			return;
+		}
+
+		// A finished prefetch waits for PushPrefetchedLevel, one that didn't make it is loaded
+		// the normal way when it's needed
+		prefetch_task_.reset();
+		if(event.status != LoadStatus::Completed)
+		{
+			gef::DebugOut((std::string("Dropped prefetch of ") + level->GetFileName() + ": " + event.error + "\n").c_str());
+			delete level;
+			prefetch_level_ = nullptr;
+			prefetch_file_.clear();
+		}
+	}
+	else if(event.type == LoadEvent::Type::Finished)
+	{
+		// The level was dropped while it was loading, nothing else owns it now
+		delete level;
+	}
 }
 
 void StateManager::Pause()
@@ -140,17 +325,68 @@ void StateManager::SwitchToMainMenu(bool fade_in)
 	if(fade_in)
 	{
 		main_menu_fade_timer_ = 0.f;
-		main_menu_->SetAlpha(0.f);
+		main_menu_alpha_ = 0.f;
+		if(main_menu_ != nullptr)
+		{
+			main_menu_->SetAlpha(0.f);
+		}
 	}
 	on_settings_menu_ = false;
 	while (!scenes_.empty())
 	{
-		delete scenes_.front();
+		// A level still loading is deleted once its load has stopped
+		if(scenes_.front() != loading_level_)
+		{
+			Retire(scenes_.front());
+		}
 		scenes_.pop();
 	}
+	CancelLoad();
+	CancelPrefetch();
+	current_scene_ = nullptr;
 	on_main_menu_ = true;
 }
 
+void StateManager::SetMainMenu(Menu* main_menu)
+{
+	main_menu_ = main_menu;
+	// Built while it was waiting to fade in
+	if(main_menu_ != nullptr && main_menu_fade_timer_ < main_menu_fade_speed_)
+	{
+		main_menu_->SetAlpha(main_menu_alpha_);
+	}
+}
+
+std::shared_ptr<LoadTask> StateManager::SubmitLoad(const std::string& name, LoaderService::Job job, LoaderService::EventHandler on_event)
+{
+	return loader_.Submit(name, std::move(job), std::move(on_event));
+}
+
+void StateManager::CancelLoad()
+{
+	if(loading_task_ != nullptr)
+	{
+		loading_task_->Cancel();
+		loading_task_.reset();
+	}
+	loading_level_ = nullptr;
+	is_loading_ = false;
+}
+
+uint32_t StateManager::GetStateChecksum() const
+{
+	if(is_loading_ || on_splash_screen_ || on_main_menu_ || on_settings_menu_)
+	{
+		return 0;
+	}
+
+	if(const Level* level = dynamic_cast<const Level*>(current_scene_))
+	{
+		return level->GetStateChecksum();
+	}
+	return 0;
+}
+
 void StateManager::SetPauseMenu(Menu* pause_menu)
 {
 	pause_menu_ = pause_menu;
@@ -162,12 +398,18 @@ void StateManager::SwitchToSettingsMenu()
 	on_settings_menu_ = true;
 }
 
-void StateManager::RestartLevel(gef::SpriteRenderer* sprite_renderer_, gef::Font* font_, OBJMeshLoader* ml)
+void StateManager::RestartLevel(OBJMeshLoader* ml)
 {
+	// Restore the level in place if it has saved its initial state, otherwise reload it
+	if(reinterpret_cast<Level*>(scenes_.front())->Restart())
+	{
+		return;
+	}
+
 	is_loading_ = true;
 	loading_screen_->SetStatusText("Restarting...");
 	Level* lvl = reinterpret_cast<Level*>(scenes_.front());
-	lvl->CleanUp();
-	PushLevel(new Level(*platform_, sprite_renderer_, font_, *this, audio_manager_), lvl->GetFileName(), *ml);
+	PushLevel(new Level(*platform_, *this, audio_manager_), lvl->GetFileName(), *ml);
 	NextScene();
+	Retire(lvl);
 }
@@ -1,44 +1,64 @@
 ﻿#pragma once
-#include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <queue>
+#include <string>
+#include <vector>
 
+#include "LoaderService.h"
 #include "obj_mesh_loader.h"
 
+class AudioSystem;
 class SplashScreen;
-
-namespace gef
-{
-	class AudioManager;
-}
-
 class Menu;
 class LoadingScreen;
 class Level;
+class RenderSnapshot;
 
 namespace gef
 {
-	class Font;
-	class SpriteRenderer;
 	class Renderer3D;
 }
 
 class InputActionManager;
+class Overlay;
 class Scene;
 
 class StateManager
 {
 public:
-	StateManager(LoadingScreen* loading_screen, bool* should_run, gef::AudioManager* audio_manager,
+	StateManager(LoadingScreen* loading_screen, bool* should_run, AudioSystem* audio_manager,
 				gef::Platform* platform);
-	void SetMainMenu(Menu* main_menu) {main_menu_ = main_menu;}
+	void SetMainMenu(Menu* main_menu);
 	void SetSplashScreen(SplashScreen* splash_screen) {splash_screen_ = splash_screen;}
 	void SetSettingsMenu(Menu* settings_menu) {settings_menu_ = settings_menu;}
 	void Update(InputActionManager* iam, float frame_time);
+	// Runs what loads left for the main thread and delivers their events, scenes may change.
+	// Call on the main thread while nothing is being simulated
+	void UpdateLoads();
+	// The next Update has to run on the main thread rather than alongside a render
+	bool NeedsMainThread() const;
 	void Render(gef::Renderer3D* renderer_3d);
-	void Render(gef::Renderer3D* renderer_3d, gef::SpriteRenderer* sprite_renderer, gef::Font* font);
+	void Render(gef::Renderer3D* renderer_3d, Overlay& overlay);
+	// Fills snapshot while a level is being played and returns true, anything else renders live
+	bool BuildSnapshot(RenderSnapshot& snapshot) const;
+	// Scenes dropped during an update may still be in the snapshot being rendered, so they go
+	// once nothing can be drawing them
+	void DeleteRetiredScenes();
 	void PushScene(Scene* scene);
 	void PushLevel(Level* level, const char* file_name, OBJMeshLoader& mesh_loader);
+	void CancelLoad();
+	// Any other load, run on the same thread as levels
+	std::shared_ptr<LoadTask> SubmitLoad(const std::string& name, LoaderService::Job job, LoaderService::EventHandler on_event);
+
+	// Loads level in the background while the current one is played, for PushPrefetchedLevel
+	// to swap in later. Takes ownership of level
+	void PrefetchLevel(Level* level, const char* file_name, OBJMeshLoader& mesh_loader);
+	// Pushes the prefetched level if it's file_name, returns false if there isn't one
+	bool PushPrefetchedLevel(const char* file_name);
+	void CancelPrefetch();
+	// Memory a prefetch may stage before it is dropped, 0 turns prefetching off
+	void SetPrefetchBudget(size_t bytes) { prefetch_budget_ = bytes; }
 	void Pause();
 	void Unpause();
 	void SetOnSplashScreen(bool on_splash_screen) {on_splash_screen_ = on_splash_screen;}
@@ -48,14 +68,27 @@ public:
 	void SetPauseMenu(Menu* pause_menu);
 	void SetShouldRun(bool should_run) { *should_run_ = should_run; }
 	void SwitchToSettingsMenu();
-	void RestartLevel(gef::SpriteRenderer* sprite_renderer_, gef::Font* font_, OBJMeshLoader* mesh_loader_);
+	void RestartLevel(OBJMeshLoader* mesh_loader_);
+	bool IsLoading() const { return is_loading_; }
+	uint32_t GetStateChecksum() const;
 
 private:
+	std::shared_ptr<LoadTask> SubmitLevelLoad(Level* level, const char* file_name, OBJMeshLoader& mesh_loader, LoadPriority priority);
+	void OnLevelLoadEvent(Level* level, const LoadEvent& event);
+	void Retire(Scene* scene) { retired_scenes_.push_back(scene); }
+
 	Scene* current_scene_ = nullptr;
 	std::queue<Scene*> scenes_;
+	std::vector<Scene*> retired_scenes_;
 	
-	std::atomic<bool> is_loading_ = false;
-	std::thread loading_thread_;
+	bool is_loading_ = false;
+	LoaderService loader_;
+	std::shared_ptr<LoadTask> loading_task_;
+	Level* loading_level_ = nullptr;
+	std::shared_ptr<LoadTask> prefetch_task_;
+	Level* prefetch_level_ = nullptr;
+	std::string prefetch_file_;
+	size_t prefetch_budget_ = 256 * 1024 * 1024;
 	LoadingScreen* loading_screen_;
 	Menu* main_menu_;
 	bool on_main_menu_ = false;
@@ -68,7 +101,7 @@ private:
 	Menu* settings_menu_ = nullptr;
 	bool on_settings_menu_ = false;
 	
-	gef::AudioManager* audio_manager_ = nullptr;
+	AudioSystem* audio_manager_ = nullptr;
 	gef::Platform* platform_ = nullptr;
 	float main_menu_alpha_ = 1.f;
 	const float main_menu_fade_speed_ = 1.0f;
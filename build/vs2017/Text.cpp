@@ -2,9 +2,8 @@
 
 #include <utility>
 
+#include "Overlay.h"
 #include "maths/vector4.h"
-#include "graphics/font.h"
-#include "graphics/sprite_renderer.h"
 #include "system/platform.h"
 
 Text::Text(const gef::Vector2& anchor, std::string text)
@@ -27,9 +26,9 @@ std::string Text::GetText() const
 	return text_;
 }
 
-void Text::Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) const
+void Text::Render(Overlay& overlay) const
 {
-	font->RenderText(sprite_renderer, gef::Vector4(platform_->width() * anchor_.x, platform_->height() * anchor_.y, -0.9f), 1.0f, alpha_color_, gef::TJ_CENTRE,text_.c_str()); 
+	overlay.DrawText(gef::Vector4(platform_->width() * anchor_.x, platform_->height() * anchor_.y, -0.9f), 1.0f, alpha_color_, gef::TJ_CENTRE, text_.c_str());
 }
 
 void Text::SetAlpha(float alpha)
@@ -6,20 +6,15 @@ namespace gef
 	class Platform;
 }
 
-namespace gef
-{
-	class SpriteRenderer;
-	class Font;
-}
-
 class InputActionManager;
+class Overlay;
 
 class UIElement
 {
 public:
 	UIElement(const gef::Vector2& anchor) : anchor_(anchor) {}
 	UIElement(const gef::Vector2& anchor, const gef::Platform& platform) : anchor_(anchor) {SetPlatform(platform);}
-	virtual void Render(gef::SpriteRenderer* sprite_renderer, gef::Font* font) const = 0;
+	virtual void Render(Overlay& overlay) const = 0;
 	virtual void Update(InputActionManager* iam, float frame_time) {}
 	virtual void Interact() {}
 	void SetPlatform(const gef::Platform& platform) {platform_ = &platform;}
@@ -0,0 +1,97 @@
+#include "headless/platform_null.h"
+#include <assets/png_loader.h>
+#include <graphics/image_data.h>
+
+#include "CookedTexture.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Texture cooker.
+// Decodes every PNG under the media directory once and writes it beside itself as raw RGBA
+// (foo.png -> foo.tex), which TextureImage maps instead of decoding the PNG at load.
+// PNGs whose cooked file is already up to date are skipped.
+//
+// usage: cook_textures [media dir] [--force]
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	bool IsUpToDate(const std::string& cooked_path, uint64_t source_size, int64_t source_time)
+	{
+		MappedFile cooked;
+		if (!cooked.Open(cooked_path.c_str()) || cooked.GetSize() < sizeof(CookedTextureHeader))
+			return false;
+		const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(cooked.GetData());
+		return header->magic == CookedTextureHeader::kMagic
+			&& header->version == CookedTextureHeader::kVersion
+			&& header->source_size == source_size
+			&& header->source_time == source_time;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string media = "media";
+	bool force = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--force")
+			force = true;
+		else if (arg[0] != '-')
+			media = arg;
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [media dir] [--force]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::error_code error;
+	fs::recursive_directory_iterator entries(media, error);
+	if (error)
+	{
+		std::cerr << "can't open media directory " << media << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	gef::PlatformNull platform(1920, 1080);
+	gef::PNGLoader png_loader;
+	int cooked = 0, skipped = 0, failed = 0;
+	for (const fs::directory_entry& entry : entries)
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".png")
+			continue;
+
+		const std::string path = entry.path().string();
+		const std::string cooked_path = CookedTexture::PathFor(path);
+		uint64_t source_size;
+		int64_t source_time;
+		if (!CookedTexture::GetSourceStamp(path, source_size, source_time))
+		{
+			failed++;
+			continue;
+		}
+		if (!force && IsUpToDate(cooked_path, source_size, source_time))
+		{
+			skipped++;
+			continue;
+		}
+
+		gef::ImageData image_data;
+		png_loader.Load(path.c_str(), platform, image_data);
+		if (!CookedTexture::Write(cooked_path, image_data, source_size, source_time))
+		{
+			std::cerr << "failed to cook " << path << std::endl;
+			failed++;
+			continue;
+		}
+		cooked++;
+	}
+
+	std::cout << "cooked " << cooked << ", up to date " << skipped << ", failed " << failed << std::endl;
+	return failed == 0 ? 0 : 1;
+}
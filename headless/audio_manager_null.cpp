@@ -0,0 +1,43 @@
+#include "audio_manager_null.h"
+
+namespace gef
+{
+	AudioManager* AudioManager::Create()
+	{
+		return new AudioManagerNull();
+	}
+
+	Int32 AudioManagerNull::LoadSample(const char* strFileName, const Platform& platform)
+	{
+		volumes_.push_back(VolumeInfo());
+		return (Int32)volumes_.size() - 1;
+	}
+
+	Int32 AudioManagerNull::GetMusicVolumeInfo(VolumeInfo& volume_info)
+	{
+		volume_info = music_volume_;
+		return 0;
+	}
+
+	Int32 AudioManagerNull::SetMusicVolumeInfo(const VolumeInfo& volume_info)
+	{
+		music_volume_ = volume_info;
+		return 0;
+	}
+
+	Int32 AudioManagerNull::GetSampleVoiceVolumeInfo(const Int32 voice_index, VolumeInfo& volume_info)
+	{
+		if (voice_index < 0 || voice_index >= (Int32)volumes_.size())
+			return -1;
+		volume_info = volumes_[voice_index];
+		return 0;
+	}
+
+	Int32 AudioManagerNull::SetSampleVoiceVolumeInfo(const Int32 voice_index, const VolumeInfo& volume_info)
+	{
+		if (voice_index < 0 || voice_index >= (Int32)volumes_.size())
+			return -1;
+		volumes_[voice_index] = volume_info;
+		return 0;
+	}
+}
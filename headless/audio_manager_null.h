@@ -0,0 +1,38 @@
+#ifndef _AUDIO_MANAGER_NULL_H
+#define _AUDIO_MANAGER_NULL_H
+
+#include <audio/audio_manager.h>
+#include <vector>
+
+namespace gef
+{
+	// Audio manager that accepts every call and plays nothing.
+	// Samples are still counted so indices handed out match a real manager.
+	class AudioManagerNull : public AudioManager
+	{
+	public:
+		Int32 LoadSample(const char* strFileName, const Platform& platform) override;
+		void UnloadSample(Int32 sample_index) override {}
+		void UnloadAllSamples() override { volumes_.clear(); }
+		Int32 PlaySample(const Int32 sample_index, const bool looping = false) override { return sample_index; }
+		void StopPlayingSampleVoice(const Int32 voice_index) override {}
+		Int32 LoadMusic(const char* strFileName, const Platform& platform) override { return 0; }
+		void UnloadMusic() override {}
+		Int32 PlayMusic() override { return 0; }
+		Int32 StopMusic() override { return 0; }
+		Int32 GetMusicVolumeInfo(VolumeInfo& volume_info) override;
+		Int32 SetMusicVolumeInfo(const VolumeInfo& volume_info) override;
+		Int32 SetMusicPitch(float pitch) override { return 0; }
+		Int32 GetSampleVoiceVolumeInfo(const Int32 voice_index, VolumeInfo& volume_info) override;
+		Int32 SetSampleVoiceVolumeInfo(const Int32 voice_index, const VolumeInfo& volume_info) override;
+		Int32 SetSamplePitch(const Int32 voice_index, float pitch) override { return 0; }
+		bool sample_voice_playing(const UInt32 voice_index) override { return false; }
+		void SetMasterVolume(float volume) override {}
+
+	private:
+		std::vector<VolumeInfo> volumes_;
+		VolumeInfo music_volume_;
+	};
+}
+
+#endif // _AUDIO_MANAGER_NULL_H
@@ -0,0 +1,14 @@
+#include <system/debug_log.h>
+#include <cstdarg>
+#include <cstdio>
+
+namespace gef
+{
+	void DebugOut(const char* text, ...)
+	{
+		va_list args;
+		va_start(args, text);
+		vfprintf(stderr, text, args);
+		va_end(args);
+	}
+}
@@ -0,0 +1,92 @@
+#include "file_stdio.h"
+
+namespace gef
+{
+	File* File::Create()
+	{
+		return new FileStdio();
+	}
+
+	FileStdio::FileStdio() :
+		file_(NULL)
+	{
+	}
+
+	FileStdio::~FileStdio()
+	{
+		Close();
+	}
+
+	bool FileStdio::Open(const char* const filename)
+	{
+		Close();
+		file_ = fopen(filename, "rb");
+		return file_ != NULL;
+	}
+
+	bool FileStdio::Exists(const char* const filename) const
+	{
+		FILE* file = fopen(filename, "rb");
+		if (file == NULL)
+			return false;
+		fclose(file);
+		return true;
+	}
+
+	bool FileStdio::GetSize(Int32& size)
+	{
+		if (file_ == NULL)
+			return false;
+
+		const long position = ftell(file_);
+		if (fseek(file_, 0, SEEK_END) != 0)
+			return false;
+		size = (Int32)ftell(file_);
+		return fseek(file_, position, SEEK_SET) == 0;
+	}
+
+	bool FileStdio::Seek(const SeekFrom seek_from, Int32 offset)
+	{
+		if (file_ == NULL)
+			return false;
+
+		int origin = SEEK_SET;
+		switch (seek_from)
+		{
+		case SF_Start:
+			origin = SEEK_SET;
+			break;
+		case SF_Current:
+			origin = SEEK_CUR;
+			break;
+		case SF_End:
+			origin = SEEK_END;
+			break;
+		}
+		return fseek(file_, offset, origin) == 0;
+	}
+
+	bool FileStdio::Read(void* buffer, const Int32 size, Int32& bytes_read)
+	{
+		if (file_ == NULL)
+			return false;
+
+		bytes_read = (Int32)fread(buffer, 1, size, file_);
+		return bytes_read == size || feof(file_);
+	}
+
+	bool FileStdio::Read(void* buffer, const Int32 size, const Int32 offset, Int32& bytes_read)
+	{
+		return Seek(SF_Start, offset) && Read(buffer, size, bytes_read);
+	}
+
+	bool FileStdio::Close()
+	{
+		if (file_ != NULL)
+		{
+			fclose(file_);
+			file_ = NULL;
+		}
+		return true;
+	}
+}
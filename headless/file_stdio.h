@@ -0,0 +1,29 @@
+#ifndef _FILE_STDIO_H
+#define _FILE_STDIO_H
+
+#include <system/file.h>
+#include <cstdio>
+
+namespace gef
+{
+	// gef::File on top of the C standard library, for platforms without their own file layer
+	class FileStdio : public File
+	{
+	public:
+		FileStdio();
+		~FileStdio();
+
+		bool Open(const char* const filename) override;
+		bool Exists(const char* const filename) const override;
+		bool GetSize(Int32& size) override;
+		bool Seek(const SeekFrom seek_from, Int32 offset) override;
+		bool Read(void* buffer, const Int32 size, Int32& bytes_read) override;
+		bool Read(void* buffer, const Int32 size, const Int32 offset, Int32& bytes_read) override;
+		bool Close() override;
+
+	private:
+		FILE* file_;
+	};
+}
+
+#endif // _FILE_STDIO_H
@@ -0,0 +1,102 @@
+#include "platform_null.h"
+#include "file_stdio.h"
+#include "audio_manager_null.h"
+#include <graphics/mesh.h>
+#include <graphics/texture.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+
+namespace gef
+{
+	// GPU resources that are created by the loaders but never bound
+
+	class TextureNull : public Texture
+	{
+	public:
+		void Bind(const Platform& platform, const int texture_stage_num) const override {}
+		void Unbind(const Platform& platform, const int texture_stage_num) const override {}
+	};
+
+	class VertexBufferNull : public VertexBuffer
+	{
+	public:
+		bool Init(const Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only) override
+		{
+			num_vertices_ = num_vertices;
+			vertex_byte_size_ = vertex_byte_size;
+			return true;
+		}
+		bool Update(const Platform& platform) override { return true; }
+		void Bind(const Platform& platform) const override {}
+		void Unbind(const Platform& platform) const override {}
+	};
+
+	class IndexBufferNull : public IndexBuffer
+	{
+	public:
+		bool Init(const Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size, const bool read_only) override
+		{
+			num_indices_ = num_indices;
+			return true;
+		}
+		bool Update(const Platform& platform) override { return true; }
+		void Bind(const Platform& platform) const override {}
+		void Unbind(const Platform& platform) const override {}
+	};
+
+	PlatformNull::PlatformNull(UInt32 width, UInt32 height) :
+		frame_time_(1.0f / 60.0f)
+	{
+		width_ = width;
+		height_ = height;
+	}
+
+	PlatformNull::~PlatformNull()
+	{
+	}
+
+	bool PlatformNull::Update()
+	{
+		return true;
+	}
+
+	float PlatformNull::GetFrameTime()
+	{
+		return frame_time_;
+	}
+
+	std::string PlatformNull::FormatFilename(const std::string& filename) const
+	{
+		return filename;
+	}
+
+	File* PlatformNull::CreateFile() const
+	{
+		return new FileStdio();
+	}
+
+	AudioManager* PlatformNull::CreateAudioManager() const
+	{
+		return new AudioManagerNull();
+	}
+
+	Mesh* PlatformNull::CreateMesh()
+	{
+		return new Mesh(*this);
+	}
+
+	Texture* PlatformNull::CreateTexture(const ImageData& image_data) const
+	{
+		return new TextureNull();
+	}
+
+	VertexBuffer* PlatformNull::CreateVertexBuffer() const
+	{
+		return new VertexBufferNull();
+	}
+
+	IndexBuffer* PlatformNull::CreateIndexBuffer() const
+	{
+		return new IndexBufferNull();
+	}
+}
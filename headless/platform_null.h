@@ -0,0 +1,54 @@
+#ifndef _PLATFORM_NULL_H
+#define _PLATFORM_NULL_H
+
+#include <system/platform.h>
+
+namespace gef
+{
+	// Platform with no window, GPU or devices.
+	// Resources the game creates while loading (textures, vertex and index buffers) are
+	// null objects that keep nothing, so levels can be loaded and simulated on any OS.
+	// Nothing is drawn, so the renderers and input devices are never created.
+	class PlatformNull : public Platform
+	{
+	public:
+		PlatformNull(UInt32 width, UInt32 height);
+		~PlatformNull();
+
+		bool Update() override;
+		float GetFrameTime() override;
+		void PreRender() override {}
+		void PostRender() override {}
+		void Clear() const override {}
+
+		std::string FormatFilename(const std::string& filename) const override;
+
+		SpriteRenderer* CreateSpriteRenderer() override { return NULL; }
+		File* CreateFile() const override;
+		AudioManager* CreateAudioManager() const override;
+		TouchInputManager* CreateTouchInputManager() const override { return NULL; }
+		SonyControllerInputManager* CreateSonyControllerInputManager() const override { return NULL; }
+		Keyboard* CreateKeyboard() const override { return NULL; }
+		Renderer3D* CreateRenderer3D() override { return NULL; }
+		Mesh* CreateMesh() override;
+		RenderTarget* CreateRenderTarget(const Int32 width, const Int32 height) const override { return NULL; }
+		Texture* CreateTexture(const ImageData& image_data) const override;
+		ShaderInterface* CreateShaderInterface() override { return NULL; }
+		VertexBuffer* CreateVertexBuffer() const override;
+		IndexBuffer* CreateIndexBuffer() const override;
+		DepthBuffer* CreateDepthBuffer(UInt32 width, UInt32 height) const override { return NULL; }
+
+		void BeginScene() const override {}
+		void EndScene() const override {}
+		void SetRenderTarget(RenderTarget* render_target) override {}
+		void SetDepthBuffer(DepthBuffer* depth_buffer) override {}
+		void SetViewport(const gef::Viewport* viewport) override {}
+
+		void set_frame_time(float frame_time) { frame_time_ = frame_time; }
+
+	private:
+		float frame_time_;
+	};
+}
+
+#endif // _PLATFORM_NULL_H
@@ -0,0 +1,31 @@
+#include "scripted_play.h"
+
+#include "InputActionManager.h"
+
+namespace
+{
+	uint32_t ActionBit(Action action)
+	{
+		return 1u << action;
+	}
+}
+
+uint32_t ScriptedActions(int frame, float dt)
+{
+	const float t = frame * dt;
+	uint32_t held = 0;
+
+	held |= ((int)(t / 4.f) % 2 == 0) ? ActionBit(MoveRight) : ActionBit(MoveLeft);
+	if ((int)(t * 2.f) % 2 == 0)
+		held |= ActionBit(Fire);
+	if (frame % 90 < 5)
+		held |= ActionBit(Jump);
+	if (frame % 600 < 2)
+		held |= ActionBit(GravityUp);
+	else if (frame % 600 >= 300 && frame % 600 < 302)
+		held |= ActionBit(GravityDown);
+	if (frame % 900 == 450)
+		held |= ActionBit(Reload);
+
+	return held;
+}
@@ -0,0 +1,11 @@
+#ifndef _SCRIPTED_PLAY_H
+#define _SCRIPTED_PLAY_H
+
+#include <cstdint>
+
+// Input the player "plays" with in headless runs: runs back and forth, keeps firing and jumping,
+// and flips gravity every few seconds so the physics has something to chew on.
+// Returns the actions held on frame, as bits for InputActionManager::SetScriptedActions
+uint32_t ScriptedActions(int frame, float dt);
+
+#endif // _SCRIPTED_PLAY_H
@@ -0,0 +1,268 @@
+#include "headless/platform_null.h"
+#include "headless/scripted_play.h"
+#include <audio/audio_manager.h>
+
+#include "AssetFile.h"
+#include "AudioSystem.h"
+#include "CollisionLayers.h"
+#include "InputActionManager.h"
+#include "Level.h"
+#include "LoaderService.h"
+#include "StateManager.h"
+#include "json.h"
+#include "obj_mesh_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless level farm.
+// Soak tests levels by simulating every level in media/levels with a range of seeds, with one thread
+// per core. Each thread has its own platform, audio, mesh loader and state manager. Each run has its
+// own level, b2World, random seed and scripted input, so runs don't share anything while they go.
+// Writes a JSON report of how each run went and how many frames a second were simulated overall.
+//
+// usage: level_farm [--seeds N] [--first-seed N] [--frames N] [--dt seconds] [--threads N] [--media dir] [--out report.json] [--loose]
+
+namespace
+{
+	struct Options
+	{
+		int seeds = 8;
+		uint32_t first_seed = 1;
+		int frames = 3600;
+		float dt = 1.0f / 60.0f;
+		int threads = 0;
+		std::string media = "media";
+		std::string out;
+		bool pack = true;
+	};
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--seeds" && has_value)
+				options.seeds = std::atoi(argv[++i]);
+			else if (arg == "--first-seed" && has_value)
+				options.first_seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+			else if (arg == "--frames" && has_value)
+				options.frames = std::atoi(argv[++i]);
+			else if (arg == "--dt" && has_value)
+				options.dt = (float)std::atof(argv[++i]);
+			else if (arg == "--threads" && has_value)
+				options.threads = std::atoi(argv[++i]);
+			else if (arg == "--media" && has_value)
+				options.media = argv[++i];
+			else if (arg == "--out" && has_value)
+				options.out = argv[++i];
+			else if (arg == "--loose")
+				options.pack = false;
+			else
+				return false;
+		}
+		return options.seeds > 0 && options.frames > 0 && options.dt > 0.f && options.threads >= 0;
+	}
+
+	struct Run
+	{
+		std::string level;
+		uint32_t seed;
+
+		std::string error;
+		double load_ms = 0.0;
+		double simulate_ms = 0.0;
+		int restarts = 0;
+		int wins = 0;
+		int losses = 0;
+		// Of the level on its last frame, runs with the same level and seed should always agree
+		uint32_t checksum = 0;
+	};
+
+	// Everything a run needs that would otherwise be shared with the other threads.
+	// Made on the thread that uses it, as the state manager's loader has to be
+	class Worker
+	{
+	public:
+		Worker() :
+			platform_(1920, 1080),
+			audio_manager_(gef::AudioManager::Create()),
+			audio_(audio_manager_.get(), platform_),
+			state_manager_(nullptr, &should_run_, &audio_, &platform_)
+		{
+			state_manager_.SetPrefetchBudget(0);
+		}
+
+		void Simulate(Run& run, const Options& options)
+		{
+			platform_.set_frame_time(options.dt);
+			InputActionManager iam(platform_, true);
+			Level* level = new Level(platform_, state_manager_, &audio_);
+			level->SetRandomSeed(run.seed);
+
+			const auto load_start = std::chrono::steady_clock::now();
+			try
+			{
+				ImmediateLoadContext context;
+				level->LoadFromFile(run.level.c_str(), context, mesh_loader_);
+			}
+			catch (const std::exception& e)
+			{
+				run.error = e.what();
+				delete level;
+				return;
+			}
+			const auto simulate_start = std::chrono::steady_clock::now();
+			run.load_ms = std::chrono::duration<double, std::milli>(simulate_start - load_start).count();
+
+			for (int frame = 0; frame < options.frames; frame++)
+			{
+				iam.SetScriptedActions(ScriptedActions(frame, options.dt));
+				level->Update(&iam, options.dt);
+
+				// Start over rather than bring up the end of level menu
+				if (level->GetEndState() != NONE)
+				{
+					if (level->GetEndState() == WIN)
+						run.wins++;
+					else
+						run.losses++;
+					level->Restart();
+					run.restarts++;
+				}
+			}
+			run.simulate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simulate_start).count();
+			run.checksum = level->GetStateChecksum();
+
+			delete level;
+			state_manager_.DeleteRetiredScenes();
+		}
+
+	private:
+		gef::PlatformNull platform_;
+		std::unique_ptr<gef::AudioManager> audio_manager_;
+		AudioSystem audio_;
+		bool should_run_ = true;
+		StateManager state_manager_;
+		OBJMeshLoader mesh_loader_;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		std::cerr << "usage: " << argv[0] << " [--seeds N] [--first-seed N] [--frames N] [--dt seconds] [--threads N] [--media dir] [--out report.json] [--loose]" << std::endl;
+		return 1;
+	}
+
+	// The game loads everything relative to media/
+	if (!options.out.empty())
+		options.out = std::filesystem::absolute(options.out).string();
+	std::error_code error;
+	std::filesystem::current_path(options.media, error);
+	if (error)
+	{
+		std::cerr << "can't open media directory " << options.media << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	// Only ever read once the runs start
+	if (options.pack)
+		AssetFiles::Mount("assets.pak");
+	CollisionLayers::Load("config/collision.json");
+
+	std::vector<Run> runs;
+	for (const std::string& file : AssetFiles::List("levels"))
+	{
+		if (std::filesystem::path(file).extension() != ".json")
+			continue;
+		for (int i = 0; i < options.seeds; i++)
+			runs.push_back({ file, options.first_seed + (uint32_t)i });
+	}
+	if (runs.empty())
+	{
+		std::cerr << "no levels found in " << options.media << "/levels" << std::endl;
+		return 1;
+	}
+
+	int threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+	threads = std::clamp(threads, 1, (int)runs.size());
+
+	// Runs are handed out one at a time, so a slow level doesn't hold up a whole share of them
+	std::atomic<size_t> next_run = 0;
+	const auto farm_start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++)
+	{
+		workers.emplace_back([&runs, &next_run, &options]
+			{
+				Worker worker;
+				for (size_t run = next_run++; run < runs.size(); run = next_run++)
+					worker.Simulate(runs[run], options);
+			});
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+	const double farm_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - farm_start).count();
+
+	nlohmann::json report;
+	report["threads"] = threads;
+	report["frames_per_run"] = options.frames;
+	report["dt"] = options.dt;
+	int failed = 0;
+	double simulated_frames = 0.0;
+	for (const Run& run : runs)
+	{
+		nlohmann::json entry = { { "level", run.level }, { "seed", run.seed } };
+		if (!run.error.empty())
+		{
+			entry["error"] = run.error;
+			failed++;
+		}
+		else
+		{
+			entry["load_ms"] = run.load_ms;
+			entry["simulated_fps"] = run.simulate_ms > 0.0 ? options.frames / (run.simulate_ms / 1000.0) : 0.0;
+			entry["restarts"] = run.restarts;
+			entry["wins"] = run.wins;
+			entry["losses"] = run.losses;
+			entry["checksum"] = run.checksum;
+			simulated_frames += options.frames;
+		}
+		report["runs"].push_back(entry);
+	}
+	report["failed"] = failed;
+	report["wall_ms"] = farm_ms;
+	// Frames simulated across every thread for each second of wall time, loading included
+	report["simulated_fps"] = farm_ms > 0.0 ? simulated_frames / (farm_ms / 1000.0) : 0.0;
+
+	if (options.out.empty())
+	{
+		std::cout << report.dump(2) << std::endl;
+	}
+	else
+	{
+		std::ofstream out(options.out);
+		if (out.fail())
+		{
+			std::cerr << "can't write " << options.out << std::endl;
+			return 1;
+		}
+		out << report.dump(2) << std::endl;
+	}
+
+	return failed == 0 ? 0 : 1;
+}
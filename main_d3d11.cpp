@@ -1,15 +1,52 @@
 #include <platform/d3d11/system/platform_d3d11.h>
 #include "scene_app.h"
+#include "StartupTimeline.h"
+#include <sstream>
+#include <string>
 
 unsigned int sceLibcHeapSize = 128*1024*1024;	// Sets up the heap area size as 128MiB.
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline, int iCmdshow)
 {
+	StartupTimeline::Begin();
+
 	// initialisation
 	gef::PlatformD3D11 platform(hInstance, 1920, 1080, false, true);
 	platform.set_render_target_clear_colour(gef::Colour(0.0f, 0.0f, 0.0f, 1.0f));
 
 	SceneApp myApp(platform);
+
+	// -record <file> / -replay <file> to capture or play back an input session
+	// -profile <file> to profile from startup and write a Chrome trace on exit
+	// -prefetch-budget <MiB> to cap memory staged for the next level, 0 to turn prefetching off
+	// -no-pipeline to simulate and render each frame one after the other
+	// -startup-timeline <file> to write how long startup took to get to each point on exit
+	// -loose to ignore assets.pak and read every asset from its own file
+	// -fps <rate> to start frames at a fixed rate rather than whenever vsync allows
+	std::istringstream args(pScmdline);
+	std::string arg, filename;
+	size_t megabytes;
+	float rate;
+	while (args >> arg)
+	{
+		if (arg == "-record" && args >> filename)
+			myApp.RecordInputTo(filename);
+		else if (arg == "-replay" && args >> filename)
+			myApp.ReplayInputFrom(filename);
+		else if (arg == "-profile" && args >> filename)
+			myApp.ProfileTo(filename);
+		else if (arg == "-prefetch-budget" && args >> megabytes)
+			myApp.SetPrefetchBudget(megabytes * 1024 * 1024);
+		else if (arg == "-no-pipeline")
+			myApp.SetPipelined(false);
+		else if (arg == "-startup-timeline" && args >> filename)
+			myApp.WriteStartupTimelineTo(filename);
+		else if (arg == "-loose")
+			myApp.SetUsePack(false);
+		else if (arg == "-fps" && args >> rate)
+			myApp.SetTargetFrameRate(rate);
+	}
+
 	myApp.Run();
 
 	return 0;
@@ -0,0 +1,331 @@
+#include "headless/platform_null.h"
+#include "headless/scripted_play.h"
+#include <audio/audio_manager.h>
+#include <system/debug_log.h>
+
+#include "AssetFile.h"
+#include "AudioSystem.h"
+#include "CollisionLayers.h"
+#include "InputActionManager.h"
+#include "Level.h"
+#include "LoaderService.h"
+#include "Profiler.h"
+#include "RenderSnapshot.h"
+#include "Random.h"
+#include "SimulationTimings.h"
+#include "StateManager.h"
+#include "json.h"
+#include "obj_mesh_loader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headless level benchmark.
+// Loads a level on the null platform and runs Level::Update for a fixed number of frames
+// with scripted input, then writes a JSON report of where the frame time went.
+//
+// usage: level_bench <lvl_N.json> [--frames N] [--dt seconds] [--seed N] [--media dir] [--out report.json] [--trace trace.json] [--no-collision-layers] [--loose]
+
+namespace
+{
+	struct Options
+	{
+		std::string level;
+		int frames = 3600;
+		float dt = 1.0f / 60.0f;
+		uint32_t seed = 1;
+		std::string media = "media";
+		std::string out;
+		std::string trace;
+		bool collision_layers = true;
+		bool pack = true;
+	};
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--frames" && has_value)
+				options.frames = std::atoi(argv[++i]);
+			else if (arg == "--dt" && has_value)
+				options.dt = (float)std::atof(argv[++i]);
+			else if (arg == "--seed" && has_value)
+				options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+			else if (arg == "--media" && has_value)
+				options.media = argv[++i];
+			else if (arg == "--out" && has_value)
+				options.out = argv[++i];
+			else if (arg == "--trace" && has_value)
+				options.trace = argv[++i];
+			else if (arg == "--no-collision-layers")
+				options.collision_layers = false;
+			else if (arg == "--loose")
+				options.pack = false;
+			else if (arg[0] != '-' && options.level.empty())
+				options.level = arg;
+			else
+				return false;
+		}
+		return !options.level.empty() && options.frames > 0 && options.dt > 0.f;
+	}
+
+	// Per-frame milliseconds for one part of the frame
+	struct Series
+	{
+		const char* name;
+		double SimulationTimings::* field;
+		std::vector<double> samples;
+	};
+
+	nlohmann::json Summarise(std::vector<double> samples)
+	{
+		nlohmann::json summary;
+		if (samples.empty())
+			return summary;
+
+		std::sort(samples.begin(), samples.end());
+		double total = 0.0;
+		for (double sample : samples)
+			total += sample;
+
+		auto percentile = [&samples](double p)
+		{
+			return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5))];
+		};
+
+		summary["total_ms"] = total;
+		summary["mean_ms"] = total / samples.size();
+		summary["p50_ms"] = percentile(0.5);
+		summary["p95_ms"] = percentile(0.95);
+		summary["p99_ms"] = percentile(0.99);
+		summary["max_ms"] = samples.back();
+		return summary;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		std::cerr << "usage: " << argv[0] << " <lvl_N.json> [--frames N] [--dt seconds] [--seed N] [--media dir] [--out report.json] [--trace trace.json] [--no-collision-layers] [--loose]" << std::endl;
+		return 1;
+	}
+
+	// The game loads everything relative to media/
+	if (!options.out.empty())
+		options.out = std::filesystem::absolute(options.out).string();
+	if (!options.trace.empty())
+		options.trace = std::filesystem::absolute(options.trace).string();
+	std::error_code error;
+	std::filesystem::current_path(options.media, error);
+	if (error)
+	{
+		std::cerr << "can't open media directory " << options.media << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	Profiler::SetThreadName("Main");
+	Profiler::SetEnabled(!options.trace.empty());
+
+	gef::PlatformNull platform(1920, 1080);
+	platform.set_frame_time(options.dt);
+	gef::AudioManager* audio_manager = gef::AudioManager::Create();
+	// No sounds are added, so everything the level plays is dropped
+	AudioSystem* audio = new AudioSystem(audio_manager, platform);
+	Random::Seed(options.seed);
+	if (options.pack)
+		AssetFiles::Mount("assets.pak");
+	// Turned off to compare contact counts against every body touching every other
+	CollisionLayers::Load("config/collision.json");
+	CollisionLayers::SetEnabled(options.collision_layers);
+
+	bool should_run = true;
+	InputActionManager iam(platform, true);
+	StateManager state_manager(nullptr, &should_run, audio, &platform);
+	state_manager.SetPrefetchBudget(0);
+	OBJMeshLoader mesh_loader;
+
+	Level* level = new Level(platform, state_manager, audio);
+	level->SetRandomSeed(options.seed);
+	nlohmann::json load_stages;
+	double load_ms = 0.0;
+	try
+	{
+		ImmediateLoadContext context;
+		level->LoadFromFile(options.level.c_str(), context, mesh_loader);
+		for (const LoadStageTiming& timing : context.Finish())
+		{
+			load_stages[timing.stage] = load_stages.value(timing.stage, 0.0) + timing.seconds * 1000.0;
+			load_ms += timing.seconds * 1000.0;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "failed to load " << options.level << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::vector<Series> series = {
+		{ "streaming", &SimulationTimings::streaming },
+		{ "physics", &SimulationTimings::physics },
+		{ "player", &SimulationTimings::player },
+		{ "plates", &SimulationTimings::plates },
+		{ "timers", &SimulationTimings::timers },
+		{ "dynamic_objects", &SimulationTimings::dynamic_objects },
+		{ "enemies", &SimulationTimings::enemies },
+		{ "bullets", &SimulationTimings::bullets },
+		{ "cleanup", &SimulationTimings::cleanup },
+		{ "hud", &SimulationTimings::hud },
+		{ "camera", &SimulationTimings::camera },
+	};
+	for (Series& s : series)
+		s.samples.reserve(options.frames);
+	std::vector<double> frame_samples;
+	frame_samples.reserve(options.frames);
+	// What the game hands to the render each frame, built the same way
+	RenderSnapshot snapshot;
+	std::vector<double> snapshot_samples;
+	snapshot_samples.reserve(options.frames);
+	double total_snapshot_meshes = 0.0;
+	double total_snapshot_triangles = 0.0;
+	int max_snapshot_triangles = 0;
+	double total_lod_meshes[MeshLods::kMaxLevels] = {};
+	double total_proxies = 0.0;
+	int max_proxies = 0;
+	double total_callbacks = 0.0;
+	int max_callbacks = 0;
+	double total_contacts = 0.0;
+	int max_contacts = 0;
+	double total_broadphase_moves = 0.0;
+	int max_broadphase_moves = 0;
+	// Averaged over each simulated second, to see gravity flips wake things and them settle again
+	std::vector<double> awake_bodies_per_second;
+	double total_awake_bodies = 0.0;
+	double second_awake_bodies = 0.0;
+	int second_frames = 0;
+	int max_awake_bodies = 0;
+	int gravity_wakes = 0;
+
+	int restarts = 0, wins = 0, losses = 0;
+	for (int frame = 0; frame < options.frames; frame++)
+	{
+		Profiler::BeginFrame();
+		iam.SetScriptedActions(ScriptedActions(frame, options.dt));
+
+		SimulationTimings timings;
+		level->SetTimings(&timings);
+		const auto frame_start = std::chrono::steady_clock::now();
+		level->Update(&iam, options.dt);
+		const auto frame_end = std::chrono::steady_clock::now();
+
+		level->BuildSnapshot(snapshot);
+		const auto snapshot_end = std::chrono::steady_clock::now();
+
+		frame_samples.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+		snapshot_samples.push_back(std::chrono::duration<double, std::milli>(snapshot_end - frame_end).count());
+		total_snapshot_meshes += snapshot.GetMeshCount();
+		total_snapshot_triangles += snapshot.GetTriangleCount();
+		max_snapshot_triangles = std::max(max_snapshot_triangles, snapshot.GetTriangleCount());
+		for (int lod = 0; lod < MeshLods::kMaxLevels; lod++)
+			total_lod_meshes[lod] += snapshot.GetLodCount(lod);
+		for (Series& s : series)
+			s.samples.push_back(timings.*s.field * 1000.0);
+		total_proxies += level->GetBroadphaseProxyCount();
+		max_proxies = std::max(max_proxies, level->GetBroadphaseProxyCount());
+		total_callbacks += level->GetContactCallbackCount();
+		max_callbacks = std::max(max_callbacks, level->GetContactCallbackCount());
+		total_contacts += level->GetContactCount();
+		max_contacts = std::max(max_contacts, level->GetContactCount());
+		total_broadphase_moves += level->GetBroadphaseMoveCount();
+		max_broadphase_moves = std::max(max_broadphase_moves, level->GetBroadphaseMoveCount());
+		const int awake_bodies = level->GetAwakeBodyCount();
+		total_awake_bodies += awake_bodies;
+		max_awake_bodies = std::max(max_awake_bodies, awake_bodies);
+		second_awake_bodies += awake_bodies;
+		if (++second_frames * options.dt >= 1.f || frame == options.frames - 1)
+		{
+			awake_bodies_per_second.push_back(second_awake_bodies / second_frames);
+			second_awake_bodies = 0.0;
+			second_frames = 0;
+		}
+
+		// Start over rather than bring up the end of level menu
+		if (level->GetEndState() != NONE)
+		{
+			gravity_wakes += level->GetGravityField().GetWakeCount();
+			if (level->GetEndState() == WIN)
+				wins++;
+			else
+				losses++;
+			level->Restart();
+			restarts++;
+		}
+	}
+	level->SetTimings(nullptr);
+	gravity_wakes += level->GetGravityField().GetWakeCount();
+	Profiler::BeginFrame();
+	if (!options.trace.empty() && !Profiler::ExportChromeTrace(options.trace.c_str()))
+		std::cerr << "can't write " << options.trace << std::endl;
+
+	double simulated_ms = 0.0;
+	for (double sample : frame_samples)
+		simulated_ms += sample;
+
+	nlohmann::json report;
+	report["level"] = options.level;
+	report["frames"] = options.frames;
+	report["dt"] = options.dt;
+	report["seed"] = options.seed;
+	report["load_ms"] = load_ms;
+	report["load_stages_ms"] = load_stages;
+	report["restarts"] = restarts;
+	report["wins"] = wins;
+	report["losses"] = losses;
+	report["simulated_fps"] = simulated_ms > 0.0 ? options.frames / (simulated_ms / 1000.0) : 0.0;
+	report["broadphase_proxies"] = { { "mean", total_proxies / options.frames }, { "max", max_proxies } };
+	report["broadphase_moves"] = { { "mean", total_broadphase_moves / options.frames }, { "max", max_broadphase_moves } };
+	report["awake_bodies"] = { { "mean", total_awake_bodies / options.frames }, { "max", max_awake_bodies }, { "per_second", awake_bodies_per_second } };
+	report["gravity_wakes"] = gravity_wakes;
+	report["contact_callbacks"] = { { "mean", total_callbacks / options.frames }, { "max", max_callbacks } };
+	report["contacts"] = { { "mean", total_contacts / options.frames }, { "max", max_contacts } };
+	report["collision_layers"] = options.collision_layers;
+	report["frame"] = Summarise(frame_samples);
+	report["snapshot"] = Summarise(snapshot_samples);
+	report["snapshot_meshes"] = total_snapshot_meshes / options.frames;
+	report["snapshot_triangles"] = { { "mean", total_snapshot_triangles / options.frames }, { "max", max_snapshot_triangles } };
+	for (int lod = 0; lod < MeshLods::kMaxLevels; lod++)
+		report["snapshot_lod_meshes"].push_back(total_lod_meshes[lod] / options.frames);
+	for (Series& s : series)
+		report["subsystems"][s.name] = Summarise(s.samples);
+
+	delete level;
+	delete audio;
+	delete audio_manager;
+
+	if (options.out.empty())
+	{
+		std::cout << report.dump(2) << std::endl;
+	}
+	else
+	{
+		std::ofstream out(options.out);
+		if (out.fail())
+		{
+			std::cerr << "can't write " << options.out << std::endl;
+			return 1;
+		}
+		out << report.dump(2) << std::endl;
+	}
+
+	return 0;
+}
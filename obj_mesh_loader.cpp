@@ -3,10 +3,8 @@
 #include <graphics/primitive.h>
 #include <system/platform.h>
 #include <graphics/model.h>
-#include <assets/png_loader.h>
 #include <graphics/texture.h>
 #include <graphics/image_data.h>
-#include <system/file.h>
 #include <system/memory_stream_buffer.h>
 #include <graphics/material.h>
 
@@ -16,9 +14,32 @@
 #include <cfloat>
 #include <algorithm>
 #include <cassert>
+#include <stdexcept>
+
+#include "Profiler.h"
+#include "LoaderService.h"
+#include "AssetFile.h"
+#include "CookedTexture.h"
+#include "MeshLod.h"
+#include "MeshSimplifier.h"
+
+namespace
+{
+	// Meshes with fewer triangles than this are drawn as they are at any size
+	constexpr int kLodMinTriangles = 1000;
+
+	// Share of the full mesh's triangles each level keeps, and how much of the screen height the
+	// mesh has to cover for the level to be drawn. The last is used however small it gets
+	const struct { float triangle_share; float min_screen_size; } lod_levels[MeshLods::kMaxLevels] = {
+		{ 1.f, 0.25f },
+		{ 0.35f, 0.08f },
+		{ 0.1f, 0.f },
+	};
+}
 
 bool OBJMeshLoader::Load(MeshResource mr, const char* filename, const char* meshmap_key, gef::Platform& platform)
 {
+	PROFILE_ZONE("OBJMeshLoader::Load");
 	if(mesh_data_map_.contains(mr))
 		return true;
 	// Get folder name. May be empty if there is no folder the OBJ file is stored in
@@ -38,50 +59,20 @@ bool OBJMeshLoader::Load(MeshResource mr, const char* filename, const char* mesh
 
 	std::map<std::string, Int32> materials;
 
-	// Open the OBJ file and load data + Calcualte file size
-	std::string obj_filename(filename);
-	void* obj_file_data = NULL;
-	Int32 file_size = 0;
-	gef::File* file = gef::File::Create();
+	// Open the OBJ file, straight out of the pack when it's in there
+	AssetFile obj_file;
+	success = obj_file.Open(filename);
 
-	success = file->Open(obj_filename.c_str());
-	if (success)
-	{
-		success = file->GetSize(file_size);
-		if (success)
-		{
-			obj_file_data = malloc(file_size);
-			success = obj_file_data != NULL;
-			if (success)
-			{
-				Int32 bytes_read;
-				success = file->Read(obj_file_data, file_size, bytes_read);
-				if (success)
-					success = bytes_read == file_size;
-
-				file->Close();
-				delete file;
-				file = NULL;
-			}
-		}
-	}
-
-	// If file loading fails, delete all objects and print error message
+	// If file loading fails, print error message
 	if (!success)
 	{
-		free(obj_file_data);
-		obj_file_data = NULL;
-
-		file->Close();
-		delete file;
-		file = NULL;
 		last_error_ = "Issue with opening and reading OBJ file. Filename: " + std::string(filename);
 		return success;
 	}
 
 	try {
-		// Stream file data to std::istream
-		gef::MemoryStreamBuffer buffer((char*)obj_file_data, file_size);
+		// Stream file data to std::istream, which only reads from it
+		gef::MemoryStreamBuffer buffer(const_cast<char*>(obj_file.begin()), obj_file.GetSize());
 		std::istream stream(&buffer);
 	
 		// While there is still data to read
@@ -198,6 +189,7 @@ bool OBJMeshLoader::Load(MeshResource mr, const char* filename, const char* mesh
 			//std::vector<Int32> face_data(face_indices.begin() + object_start_index, face_indices.begin() + end);
 
 			mesh_data_map_[mr] = new MeshData(platform,face_indices,positions, normals, uvs, material_list, primitive_indices[i], texture_indices[i], true);
+			BuildLods(*mesh_data_map_[mr]);
 		}
 	}
 	catch (std::exception& exception)
@@ -207,16 +199,43 @@ bool OBJMeshLoader::Load(MeshResource mr, const char* filename, const char* mesh
 		return false;
 	}
 
-	// don't need the obj file data any more
-	free(obj_file_data);
-	obj_file_data = NULL;
-
 	return true;
 }
 
 gef::Mesh* OBJMeshLoader::GetMesh(MeshResource mr, gef::Vector4& scale)
 {
-	return CreateMesh(mr, scale);
+	const MeshLods* lods = GetMeshLods(mr, scale);
+	return lods != nullptr ? const_cast<gef::Mesh*>(lods->meshes[0]) : nullptr;
+}
+
+const MeshLods* OBJMeshLoader::GetMeshLods(MeshResource mr, const gef::Vector4& scale)
+{
+	const auto key = std::make_tuple(mr, scale.x(), scale.y(), scale.z());
+	auto found = mesh_lods_.find(key);
+	if (found != mesh_lods_.end())
+		return found->second;
+
+	auto data = mesh_data_map_.find(mr);
+	if (data == mesh_data_map_.end() || data->second->face_indices.empty())
+		return nullptr;
+
+	PROFILE_ZONE("OBJMeshLoader::GetMeshLods");
+	const MeshData& md = *data->second;
+	MeshLods* lods = new MeshLods();
+	lods->meshes[0] = CreateMesh(md, md.face_indices, md.primitive_indices, scale);
+	lods->triangle_counts[0] = (int)md.face_indices.size() / 9;
+	lods->count = 1;
+	for (const MeshLodData& lod : md.lods)
+	{
+		lods->meshes[lods->count] = CreateMesh(md, lod.face_indices, lod.primitive_indices, scale);
+		lods->triangle_counts[lods->count] = (int)lod.face_indices.size() / 9;
+		lods->count++;
+	}
+	for (int level = 0; level < lods->count; level++)
+		lods->min_screen_size[level] = level == lods->count - 1 ? 0.f : lod_levels[level].min_screen_size;
+
+	mesh_lods_[key] = lods;
+	return lods;
 }
 
 OBJMeshLoader::~OBJMeshLoader()
@@ -226,6 +245,32 @@ OBJMeshLoader::~OBJMeshLoader()
 		delete mesh_data.second;
 		mesh_data.second = NULL;
 	}
+	for(auto& lods : mesh_lods_)
+	{
+		for(int level = 0; level < lods.second->count; level++)
+			delete lods.second->meshes[level];
+		delete lods.second;
+		lods.second = NULL;
+	}
+}
+
+void OBJMeshLoader::BuildLods(MeshData& md)
+{
+	const int triangles = (int)md.face_indices.size() / 9;
+	if (triangles < kLodMinTriangles)
+		return;
+
+	PROFILE_ZONE("OBJMeshLoader::BuildLods");
+	for (int level = 1; level < MeshLods::kMaxLevels; level++)
+	{
+		MeshLodData lod;
+		MeshSimplifier::Simplify(md.positions, md.face_indices, md.primitive_indices, (int)(triangles * lod_levels[level].triangle_share), lod.face_indices, lod.primitive_indices);
+		// Stop once the simplifier can't take any more off
+		const size_t previous = md.lods.empty() ? md.face_indices.size() : md.lods.back().face_indices.size();
+		if (lod.face_indices.empty() || lod.face_indices.size() >= previous)
+			break;
+		md.lods.push_back(std::move(lod));
+	}
 }
 
 const std::string OBJMeshLoader::GetFolderName(const char* filename)
@@ -252,17 +297,15 @@ const std::string OBJMeshLoader::GetFolderName(const char* filename)
 	return folder_name;
 }
 
-gef::Mesh* OBJMeshLoader::CreateMesh(MeshResource mr, gef::Vector4& scale)
+gef::Mesh* OBJMeshLoader::CreateMesh(const MeshData& md, const std::vector<Int32>& face_indices, const std::vector<Int32>& primitive_indices, const gef::Vector4& scale)
 {
-	MeshData& md = *mesh_data_map_[mr];
-	
-	if (md.face_indices.empty())
+	if (face_indices.empty())
 		return nullptr;
 
 	gef::Mesh* mesh = new gef::Mesh(md.platform);
 
 	// start building the mesh
-	Int32 num_faces = (Int32)md.face_indices.size() / 9;
+	Int32 num_faces = (Int32)face_indices.size() / 9;
 	Int32 num_vertices = num_faces * 3;
 
 	// create vertex buffer
@@ -274,14 +317,14 @@ gef::Mesh* OBJMeshLoader::CreateMesh(MeshResource mr, gef::Vector4& scale)
 	for (Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
 	{
 		gef::Mesh::Vertex* vertex = &vertices[vertex_num];
-		gef::Vector4 position = md.positions[md.face_indices[vertex_num * 3] - 1];
+		gef::Vector4 position = md.positions[face_indices[vertex_num * 3] - 1];
 
 		position.set_x(position.x() * scale.x());
 		position.set_y(position.y() * scale.y());
 		position.set_z(position.z() * scale.z());
 
-		gef::Vector2 uv = md.uvs[md.face_indices[vertex_num * 3 + 1] - 1];
-		gef::Vector4 normal = md.normals[md.face_indices[vertex_num * 3 + 2] - 1];
+		gef::Vector2 uv = md.uvs[face_indices[vertex_num * 3 + 1] - 1];
+		gef::Vector4 normal = md.normals[face_indices[vertex_num * 3 + 2] - 1];
 
 		vertex->px = position.x();
 		vertex->py = position.y();
@@ -315,21 +358,21 @@ gef::Mesh* OBJMeshLoader::CreateMesh(MeshResource mr, gef::Vector4& scale)
 	mesh->set_bounding_sphere(sphere);
 
 
-	mesh->InitVertexBuffer(md.platform, vertices, num_vertices, sizeof(gef::Mesh::Vertex));
+	LoadContext::RunGPUUpload([&] { mesh->InitVertexBuffer(md.platform, vertices, num_vertices, sizeof(gef::Mesh::Vertex)); }, num_vertices * sizeof(gef::Mesh::Vertex));
 
 	// create primitives
-	mesh->AllocatePrimitives((UInt32)md.primitive_indices.size());
+	mesh->AllocatePrimitives((UInt32)primitive_indices.size());
 
 	std::vector<UInt32*> indices;
-	indices.resize(md.primitive_indices.size());
-	for (UInt32 primitive_num = 0; primitive_num < md.primitive_indices.size(); ++primitive_num)
+	indices.resize(primitive_indices.size());
+	for (UInt32 primitive_num = 0; primitive_num < primitive_indices.size(); ++primitive_num)
 	{
 		Int32 index_count = 0;
 
-		if (primitive_num == md.primitive_indices.size() - 1)
-			index_count = (Int32)md.face_indices.size() - md.primitive_indices[primitive_num];
+		if (primitive_num == primitive_indices.size() - 1)
+			index_count = (Int32)face_indices.size() - primitive_indices[primitive_num];
 		else
-			index_count = md.primitive_indices[primitive_num + 1] - md.primitive_indices[primitive_num];
+			index_count = primitive_indices[primitive_num + 1] - primitive_indices[primitive_num];
 
 		// 9 indices per triangle, index count is the number of vertices in this primitive
 		index_count /= 3;
@@ -337,10 +380,10 @@ gef::Mesh* OBJMeshLoader::CreateMesh(MeshResource mr, gef::Vector4& scale)
 		indices[primitive_num] = new UInt32[index_count];
 
 		for (Int32 index = 0; index < index_count; ++index)
-			indices[primitive_num][index] = md.primitive_indices[primitive_num] + index;
+			indices[primitive_num][index] = primitive_indices[primitive_num] + index;
 
 		mesh->GetPrimitive(primitive_num)->set_type(gef::TRIANGLE_LIST);
-		mesh->GetPrimitive(primitive_num)->InitIndexBuffer(md.platform, indices[primitive_num], index_count, sizeof(UInt32));
+		LoadContext::RunGPUUpload([&] { mesh->GetPrimitive(primitive_num)->InitIndexBuffer(md.platform, indices[primitive_num], index_count, sizeof(UInt32)); }, index_count * sizeof(UInt32));
 		//			mesh->GetPrimitive(primitive_num)->InitIndexBuffer(platform, indices[primitive_num], 3, sizeof(UInt32));
 
 
@@ -373,43 +416,20 @@ bool StringEndsWith(std::string const& full_string, std::string const& ending)
 
 bool OBJMeshLoader::LoadMaterials(const gef::Platform& platform, const char* filename, const std::string& folder_name, std::map<std::string, Int32>& materials, std::vector<gef::Material*>& material_list)
 {
-	gef::PNGLoader png_loader;
+	PROFILE_ZONE("OBJMeshLoader::LoadMaterials");
 	std::vector<std::pair<gef::Texture*, gef::Colour>> textures;
 
 	bool success = true;
 
-	std::string mtl_filename(filename);
-	void* mtl_file_data = NULL;
-	Int32 file_size = 0;
-	gef::File* file = gef::File::Create();
-	success = file->Open(mtl_filename.c_str());
-	if (success)
-	{
-		success = file->GetSize(file_size);
-		if (success)
-		{
-			mtl_file_data = malloc(file_size);
-			success = mtl_file_data != NULL;
-			if (success)
-			{
-				Int32 bytes_read;
-				success = file->Read(mtl_file_data, file_size, bytes_read);
-				if (success)
-					success = bytes_read == file_size;
-			}
-		}
-	}
+	AssetFile mtl_file;
+	success = mtl_file.Open(filename);
 
 	if (!success)
 	{
-		free(mtl_file_data);
-		mtl_file_data = NULL;
 		last_error_ = "Issue with opening and reading MTL file. Filename: " + std::string(filename);
-		delete file;
-		file = NULL;
 		return false;
 	}
-	gef::MemoryStreamBuffer buffer((char*)mtl_file_data, file_size);
+	gef::MemoryStreamBuffer buffer(const_cast<char*>(mtl_file.begin()), mtl_file.GetSize());
 	std::istream stream(&buffer);
 
 
@@ -444,11 +464,7 @@ bool OBJMeshLoader::LoadMaterials(const gef::Platform& platform, const char* fil
 				material_name_mappings[material_name].second = gef::Colour(r, g, b);
 			}
 		}
-
-		free(mtl_file_data);
-		mtl_file_data = NULL;
-		delete file;
-		file = NULL;
+		mtl_file.Close();
 
 		for (auto iter = material_name_mappings.begin(); iter != material_name_mappings.end(); ++iter)
 		{
@@ -456,20 +472,21 @@ bool OBJMeshLoader::LoadMaterials(const gef::Platform& platform, const char* fil
 			{
 				if (!StringEndsWith(iter->second.first, ".png")) {
 					std::string message = "Attempted to load an image that was not a PNG. Texture name: " + iter->second.first;
-					throw std::exception(message.c_str());
+					throw std::runtime_error(message);
 				}
 					
-				gef::ImageData image_data;
-				png_loader.Load(iter->second.first.c_str(), platform, image_data);
-				if (image_data.image() != NULL) {
-					gef::Texture* texture = gef::Texture::Create(platform, image_data);
+				TextureImage image;
+				if (image.Load(iter->second.first.c_str(), platform)) {
+					const gef::ImageData& image_data = image.GetImageData();
+					gef::Texture* texture = nullptr;
+					LoadContext::RunGPUUpload([&] { texture = gef::Texture::Create(platform, image_data); }, image_data.width() * image_data.height() * 4);
 					textures.push_back(std::make_pair(texture, iter->second.second));
 					materials[iter->first] = (Int32)textures.size() - 1;
 				} 
 				else
 				{
 					std::string message = "Cannot load image. Image filename: " + iter->second.first;
-					throw std::exception(message.c_str());
+					throw std::runtime_error(message);
 				}
 			}
 			else
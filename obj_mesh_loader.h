@@ -2,6 +2,7 @@
 #include <gef.h>
 #include <map>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <maths/vector4.h>
 #include <maths/vector2.h>
@@ -17,6 +18,15 @@ namespace gef
 
 typedef std::map<std::string, gef::Mesh*> MeshMap;
 
+struct MeshLods;
+
+// A simplified copy of MeshData's faces, same layout
+struct MeshLodData
+{
+	std::vector<Int32> face_indices;
+	std::vector<Int32> primitive_indices;
+};
+
 struct MeshData
 {
 	gef::Platform& platform;
@@ -28,6 +38,8 @@ struct MeshData
 	std::vector<Int32> primitive_indices;
 	std::vector<Int32> texture_indices;
 	bool filled = false;
+	// Simpler versions, most detailed first. Empty for meshes too light to bother with
+	std::vector<MeshLodData> lods;
 };
 
 enum class MeshResource
@@ -49,13 +61,17 @@ public:
 	bool Load(MeshResource mr, const char* filename, const char* meshmap_key, gef::Platform& platform);
 	const std::string& GetLastError() { return last_error_; }
 	gef::Mesh* GetMesh(MeshResource mr, gef::Vector4& scale);
+	// Baked once per scale and shared by everything placed at it
+	const MeshLods* GetMeshLods(MeshResource mr, const gef::Vector4& scale);
 	~OBJMeshLoader();
 
 private:
 	const std::string GetFolderName(const char* filename);
-	gef::Mesh* CreateMesh(MeshResource mr, gef::Vector4& scale);
+	void BuildLods(MeshData& md);
+	gef::Mesh* CreateMesh(const MeshData& md, const std::vector<Int32>& face_indices, const std::vector<Int32>& primitive_indices, const gef::Vector4& scale);
 	bool LoadMaterials(const gef::Platform& platform, const char* filename, const std::string& folder_name, std::map<std::string, Int32>& materials, std::vector<gef::Material*>& material_list);
 	std::map<MeshResource, MeshData*> mesh_data_map_;
+	std::map<std::tuple<MeshResource, float, float, float>, MeshLods*> mesh_lods_;
 private:
 	std::string last_error_;
 };
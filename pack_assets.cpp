@@ -0,0 +1,78 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Asset packer.
+// Puts every file under the media directory that the game reads through AssetFile into one
+// pack, media/assets.pak by default, which the game mounts at startup. PNGs and sounds are
+// left out since gef opens those itself, so run cook_textures first to get textures packed.
+//
+// usage: pack_assets [media dir] [--out file.pak]
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	bool IsPacked(const fs::path& path)
+	{
+		static const char* extensions[] = { ".json", ".obj", ".mtl", ".fnt", ".tex" };
+		const std::string extension = path.extension().string();
+		return std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string media = "media";
+	std::string out;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--out" && i + 1 < argc)
+			out = argv[++i];
+		else if (arg[0] != '-')
+			media = arg;
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [media dir] [--out file.pak]" << std::endl;
+			return 1;
+		}
+	}
+	if (out.empty())
+		out = (fs::path(media) / "assets.pak").string();
+
+	std::error_code error;
+	fs::recursive_directory_iterator entries(media, error);
+	if (error)
+	{
+		std::cerr << "can't open media directory " << media << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	// Stored relative to media/, which is where the game runs from
+	std::vector<std::pair<std::string, std::string>> files;
+	uintmax_t bytes = 0;
+	for (const fs::directory_entry& entry : entries)
+	{
+		if (!entry.is_regular_file() || !IsPacked(entry.path()))
+			continue;
+		files.emplace_back(fs::relative(entry.path(), media).generic_string(), entry.path().string());
+		bytes += entry.file_size();
+	}
+	std::sort(files.begin(), files.end());
+
+	std::string message;
+	if (!AssetPack::Write(out, files, message))
+	{
+		std::cerr << message << std::endl;
+		return 1;
+	}
+
+	std::cout << "packed " << files.size() << " files, " << bytes / 1024 << " KiB into " << out << std::endl;
+	return 0;
+}
@@ -5,6 +5,7 @@
 #include <maths/math_utils.h>
 #include <vector>
 #include <math.h>
+#include "LoaderService.h"
 
 
 //
@@ -136,7 +137,7 @@ gef::Mesh* PrimitiveBuilder::CreateBoxMesh(const gef::Vector4& half_size, gef::V
 	};
 
 	// create the vertex buffer for the box vertices
-	mesh->InitVertexBuffer(platform_, vertices, kNumVertices, sizeof(gef::Mesh::Vertex));
+	LoadContext::RunGPUUpload([&] { mesh->InitVertexBuffer(platform_, vertices, kNumVertices, sizeof(gef::Mesh::Vertex)); }, kNumVertices * sizeof(gef::Mesh::Vertex));
 
 	// create a primitive per face so we can alter the material per face
 	const int num_faces = 6;
@@ -145,7 +146,7 @@ gef::Mesh* PrimitiveBuilder::CreateBoxMesh(const gef::Vector4& half_size, gef::V
 	for (int primitive_num = 0; primitive_num < num_faces; ++primitive_num)
 	{
 		gef::Primitive* primitive = mesh->GetPrimitive(primitive_num);
-		primitive->InitIndexBuffer(platform_, &indices[primitive_num*6], 6, sizeof(Int32));
+		LoadContext::RunGPUUpload([&] { primitive->InitIndexBuffer(platform_, &indices[primitive_num*6], 6, sizeof(Int32)); }, 6 * sizeof(Int32));
 		primitive->set_type(gef::TRIANGLE_LIST);
 
 		// if materials pointer is valid then assume we have an array of Material pointers
@@ -207,7 +208,7 @@ gef::Mesh* PrimitiveBuilder::CreatePlaneMesh(const gef::Vector4& half_size, gef:
 	};
 
 	// create the vertex buffer for the box vertices
-	mesh->InitVertexBuffer(platform_, vertices, kNumVertices, sizeof(gef::Mesh::Vertex));
+	LoadContext::RunGPUUpload([&] { mesh->InitVertexBuffer(platform_, vertices, kNumVertices, sizeof(gef::Mesh::Vertex)); }, kNumVertices * sizeof(gef::Mesh::Vertex));
 
 	// create a primitive per face so we can alter the material per face
 	const int num_faces = 2;
@@ -216,7 +217,7 @@ gef::Mesh* PrimitiveBuilder::CreatePlaneMesh(const gef::Vector4& half_size, gef:
 	for (int primitive_num = 0; primitive_num < num_faces; ++primitive_num)
 	{
 		gef::Primitive* primitive = mesh->GetPrimitive(primitive_num);
-		primitive->InitIndexBuffer(platform_, &indices[primitive_num * 6], 6, sizeof(Int32));
+		LoadContext::RunGPUUpload([&] { primitive->InitIndexBuffer(platform_, &indices[primitive_num * 6], 6, sizeof(Int32)); }, 6 * sizeof(Int32));
 		primitive->set_type(gef::TRIANGLE_LIST);
 
 		// if materials pointer is valid then assume we have an array of Material pointers
@@ -324,7 +325,7 @@ gef::Mesh* PrimitiveBuilder::CreateSphereMesh(const float radius, const int phi,
 	vert_idx++;
 
 
-	mesh->InitVertexBuffer(platform_, &vertices[0], kNumVertices, sizeof(gef::Mesh::Vertex));
+	LoadContext::RunGPUUpload([&] { mesh->InitVertexBuffer(platform_, &vertices[0], kNumVertices, sizeof(gef::Mesh::Vertex)); }, kNumVertices * sizeof(gef::Mesh::Vertex));
 	mesh->AllocatePrimitives(2);
 
 	// side quads
@@ -353,7 +354,7 @@ gef::Mesh* PrimitiveBuilder::CreateSphereMesh(const float radius, const int phi,
 	primitive = mesh->GetPrimitive(0);
 	primitive->set_type(gef::TRIANGLE_LIST);
 	primitive->set_material(material);
-	primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32));
+	LoadContext::RunGPUUpload([&] { primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32)); }, index_buffer.size() * sizeof(Int32));
 
 	// top/bottom triangles
 	index_buffer.resize(phi * 3 + phi * 3);
@@ -379,7 +380,7 @@ gef::Mesh* PrimitiveBuilder::CreateSphereMesh(const float radius, const int phi,
 	primitive = mesh->GetPrimitive(1);
 	primitive->set_type(gef::TRIANGLE_LIST);
 	primitive->set_material(material);
-	primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32));
+	LoadContext::RunGPUUpload([&] { primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32)); }, index_buffer.size() * sizeof(Int32));
 
 	// bounds
 	gef::Aabb aabb(gef::Vector4(-radius, -radius, -radius) - origin, gef::Vector4(radius, radius, radius)+ origin);
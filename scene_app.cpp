@@ -2,15 +2,19 @@
 
 #include <system/platform.h>
 #include <graphics/sprite_renderer.h>
-#include <graphics/font.h>
 #include <graphics/renderer_3d.h>
 #include <maths/math_utils.h>
 #include <input/input_manager.h>
 #include <input/touch_input_manager.h>
 #include <platform/d3d11/system/platform_d3d11.h>
+#include <cstdio>
 #include <string>
 #include <chrono>
+#include "AssetFile.h"
 #include "Button.h"
+#include "CookedTexture.h"
+#include "CollisionLayers.h"
+#include "FramePipeline.h"
 #include "Image.h"
 #include "InputActionManager.h"
 #include "StateManager.h"
@@ -18,61 +22,98 @@
 #include "LoadingScreen.h"
 #include "Menu.h"
 #include "SplashScreen.h"
+#include "StartupTimeline.h"
 #include "Text.h"
+#include "AudioSystem.h"
 #include "audio/audio_manager.h"
-#include "graphics/image_data.h"
 #include "graphics/texture.h"
+#include "system/debug_log.h"
+#include "Profiler.h"
 
 SceneApp::SceneApp(gef::Platform& platform) :
 	Application(platform),
 	sprite_renderer_(NULL),
-	renderer_3d_(NULL),
-	font_(NULL)
+	renderer_3d_(NULL)
 {
 	platform_d3d_ = reinterpret_cast<gef::PlatformD3D11*>(&platform);
 }
 
+void SceneApp::ProfileTo(const std::string& filename)
+{
+	trace_file_ = filename;
+	export_trace_on_exit_ = true;
+	Profiler::SetEnabled(true);
+}
+
 void SceneApp::Init()
 {
+	StartupTimeline::Mark("init");
+	Profiler::SetThreadName("Main");
+	PROFILE_ZONE("SceneApp::Init");
+
 	sprite_renderer_ = gef::SpriteRenderer::Create(platform_);
 
 	// create the renderer for draw 3D geometry
 	renderer_3d_ = gef::Renderer3D::Create(platform_);
 
+	if (use_pack_)
+		AssetFiles::Mount("assets.pak");
+	CollisionLayers::Load("config/collision.json");
+
+	pipeline_ = new FramePipeline([this] { Simulate(); });
+
 	audio_manager_ = gef::AudioManager::Create();
-	audio_manager_->LoadSample("sounds/pickup.ogg", platform_); // made in house
-	gef::VolumeInfo volume_info;
-	audio_manager_->GetSampleVoiceVolumeInfo(0, volume_info);
-	volume_info.volume = 200.f;
-	audio_manager_->SetSampleVoiceVolumeInfo(0, volume_info);
-	audio_manager_->LoadSample("sounds/MaxAmmo.ogg", platform_);
-	audio_manager_->SetSampleVoiceVolumeInfo(1, volume_info);
-	audio_manager_->LoadSample("sounds/lazer.ogg", platform_); // found here: https://www.soundfishing.eu/sound/laser-gun
-	audio_manager_->LoadSample("sounds/enemy_lazer.ogg", platform_); // found here: https://www.soundfishing.eu/sound/laser-gun
-	audio_manager_->LoadSample("sounds/player_death.ogg", platform_); // found here: https://pixabay.com/sound-effects/search/death/?pagi=2
-	audio_manager_->LoadSample("sounds/enemy_death.ogg", platform_); // found here: https://pixabay.com/sound-effects/search/death/?pagi=2
-	audio_manager_->LoadSample("sounds/door.ogg", platform_); // found here: https://pixabay.com/sound-effects/search/spaceship-doors/
+	audio_ = new AudioSystem(audio_manager_, platform_);
+	// Enemies fire constantly, so their sounds give way to everything else and aren't heard from far off
+	const struct { const char* name; SoundDesc desc; } sounds[] = {
+		// name, { file, copies, priority, volume, audible distance }
+		{ "pickup", { "sounds/pickup.ogg", 2, 2, 200.f } }, // made in house
+		{ "max_ammo", { "sounds/MaxAmmo.ogg", 1, 2, 200.f } },
+		{ "player_laser", { "sounds/lazer.ogg", 1, 3 } }, // found here: https://www.soundfishing.eu/sound/laser-gun
+		{ "enemy_laser", { "sounds/enemy_lazer.ogg", 3, 0, 100.f, 20.f } }, // found here: https://www.soundfishing.eu/sound/laser-gun
+		{ "player_hurt", { "sounds/player_death.ogg", 1, 3 } }, // found here: https://pixabay.com/sound-effects/search/death/?pagi=2
+		{ "enemy_death", { "sounds/enemy_death.ogg", 2, 1, 100.f, 25.f } }, // found here: https://pixabay.com/sound-effects/search/death/?pagi=2
+		{ "door", { "sounds/door.ogg", 2, 2 } }, // found here: https://pixabay.com/sound-effects/search/spaceship-doors/
+	};
+	for (const auto& sound : sounds)
+	{
+		audio_->AddSound(sound.name, sound.desc);
+	}
+	audio_->PlayMusic("sounds/Karl Casey - Deception.ogg", 20.f); // found here: https://karlcasey.bandcamp.com/track/lethal
 
 	// initialise input action manager
 	iam_ = new InputActionManager(platform_);
 	if (iam_->getInputManager() && iam_->getInputManager()->touch_manager() && (iam_->getInputManager()->touch_manager()->max_num_panels() > 0)) {
 		iam_->getInputManager()->touch_manager()->EnablePanel(0);
 	}
+	if (!replay_file_.empty())
+	{
+		if (!iam_->StartReplay(replay_file_.c_str()))
+			gef::DebugOut(("Could not replay input from " + replay_file_ + "\n").c_str());
+	}
+	else if (!record_file_.empty())
+	{
+		if (!iam_->StartRecording(record_file_.c_str()))
+			gef::DebugOut(("Could not record input to " + record_file_ + "\n").c_str());
+	}
 
 	// LOADING SCREEN
 	LoadingScreen* loading_screen = new LoadingScreen(platform_, *state_manager_);
 	loading_screen->SetStatusText("Loading...");
-	state_manager_ = new StateManager(loading_screen, &should_run_, audio_manager_, &platform_);
+	state_manager_ = new StateManager(loading_screen, &should_run_, audio_, &platform_);
+	state_manager_->SetPrefetchBudget(prefetch_budget_);
 
 	gef::Sprite* menuBkg = new gef::Sprite();
-	gef::ImageData menu_img_data("space.png");
-	menuBkg->set_texture(gef::Texture::Create(platform_, menu_img_data));
+	TextureImage menu_img;
+	menu_img.Load("space.png", platform_);
+	menuBkg->set_texture(gef::Texture::Create(platform_, menu_img.GetImageData()));
 	menuBkg->set_width(platform_.width());
 	menuBkg->set_height(platform_.height());
 	Image* menuBkg_img = new Image({0.5f,0.5f}, menuBkg, platform_);
 	menuBkg_img->SetIgnoreAlpha(true);
+	menuBkg_img->SetLayer(OverlayLayer::Background);
 	
-	// SPLASH SCREEN
+	// SPLASH SCREEN, the only thing loaded before the first frame
 	SplashScreen* splash_screen = new SplashScreen(platform_, *state_manager_);
 
 	splash_screen->SetBkg(menuBkg_img);
@@ -80,18 +121,59 @@ void SceneApp::Init()
 	splash_screen->AddUIElement(new Text({0.5,0.5}, "DarkSpace Studios Presents", platform_));
 	
 	gef::Sprite* splash1 = new gef::Sprite();
-	gef::ImageData image_data("menu_images/gg.png");
-	splash1->set_texture(gef::Texture::Create(platform_, image_data));
-	splash1->set_width(image_data.width()/2.f);
-	splash1->set_height(image_data.height()/2.f);
+	TextureImage splash1_img;
+	splash1_img.Load("menu_images/gg.png", platform_);
+	splash1->set_texture(gef::Texture::Create(platform_, splash1_img.GetImageData()));
+	splash1->set_width(splash1_img.GetImageData().width()/2.f);
+	splash1->set_height(splash1_img.GetImageData().height()/2.f);
 	Image* splash_img = new Image({0.5,0.5}, splash1, platform_);
 	splash_screen->AddUIElement(splash_img);
 	state_manager_->SetSplashScreen(splash_screen);
-	
+
+	InitOverlay();
+	SetupLights();
+	StartupTimeline::Mark("splash_ready");
+
+	LoadFrontEnd(menuBkg_img);
+}
+
+void SceneApp::LoadFrontEnd(Image* background)
+{
+	// Nothing past the splash screen is needed until it's over, so the menus are built behind it.
+	// If it's skipped first, the loading screen shows until they're done
+	state_manager_->SubmitLoad("Front end", [this](LoadContext& context)
+		{
+			context.Stage("Loading menus...");
+			TextureImage logo_image;
+			if (!logo_image.Load("menu_images/logo.png", platform_))
+				throw std::runtime_error("can't load menu_images/logo.png");
+			const gef::ImageData& image_data = logo_image.GetImageData();
+			logo_width_ = (float)image_data.width();
+			logo_height_ = (float)image_data.height();
+			LoadContext::RunGPUUpload([&] { logo_texture_ = gef::Texture::Create(platform_, image_data); }, image_data.width() * image_data.height() * 4);
+		},
+		[this, background](const LoadEvent& event)
+		{
+			if (event.type != LoadEvent::Type::Finished)
+				return;
+			// However it ended, or the game would sit on the loading screen. Without the logo if it didn't load
+			if (event.status == LoadStatus::Failed)
+				gef::DebugOut("Front end load failed: %s\n", event.error.c_str());
+			else if (event.status == LoadStatus::Cancelled)
+				gef::DebugOut("Front end load cancelled\n");
+			BuildMenus(background);
+			StartupTimeline::Mark("menus_ready");
+		});
+}
+
+void SceneApp::BuildMenus(Image* background)
+{
+	PROFILE_ZONE("SceneApp::BuildMenus");
+
 	// SETTINGS MENU
 	Menu* settings_menu = new Menu(platform_, *state_manager_, false);
 	
-	settings_menu->AddUIElement(menuBkg_img);
+	settings_menu->AddUIElement(background);
 	state_manager_->SetSettingsMenu(settings_menu);
 	settings_menu->AddUIElement(new Text({0.5,0.25}, "Settings"));
 	Button* settingsBackButton = new Button({0.5,0.4}, platform_, "Back", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
@@ -113,10 +195,7 @@ void SceneApp::Init()
 			{
 				volume = 0;
 			}
-			gef::VolumeInfo vi;
-			audio_manager_->GetMusicVolumeInfo(vi);
-			vi.volume = volume;
-			audio_manager_->SetMusicVolumeInfo(vi);
+			audio_->SetMusicVolume(volume);
 			text = std::to_string(volume);
 			music_volume_text->UpdateText(text.c_str());
 		});
@@ -128,10 +207,7 @@ void SceneApp::Init()
 			{
 				volume = 100;
 			}
-			gef::VolumeInfo vi;
-			audio_manager_->GetMusicVolumeInfo(vi);
-			vi.volume = volume;
-			audio_manager_->SetMusicVolumeInfo(vi);
+			audio_->SetMusicVolume(volume);
 			text = std::to_string(volume);
 			music_volume_text->UpdateText(text.c_str());
 		});
@@ -151,13 +227,7 @@ void SceneApp::Init()
 			{
 				volume = 0;
 			}
-			for (int i = 0; i < 7; i++)
-			{
-				gef::VolumeInfo vi;
-				audio_manager_->GetSampleVoiceVolumeInfo(i, vi);
-				vi.volume = volume;
-				audio_manager_->SetSampleVoiceVolumeInfo(i, vi);
-			}
+			audio_->SetSfxVolume(volume);
 			text = std::to_string(volume);
 			sfx_volume_text->UpdateText(text.c_str());
 		});
@@ -170,13 +240,7 @@ void SceneApp::Init()
 			{
 				volume = 100;
 			}
-			for (int i = 0; i < 7; i++)
-			{
-				gef::VolumeInfo vi;
-				audio_manager_->GetSampleVoiceVolumeInfo(i, vi);
-				vi.volume = volume;
-				audio_manager_->SetSampleVoiceVolumeInfo(i, vi);
-			}
+			audio_->SetSfxVolume(volume);
 			text = std::to_string(volume);
 			sfx_volume_text->UpdateText(text.c_str());
 		});
@@ -186,24 +250,27 @@ void SceneApp::Init()
 
 	// MAIN MENU
 	Menu* menu = new Menu(platform_, *state_manager_, false);
-	menu->AddUIElement(menuBkg_img);
+	menu->AddUIElement(background);
 	state_manager_->SetMainMenu(menu);
 	menu->AddUIElement(new Text({0.5,0.27}, "Pirates are attacking! reach and repair your hyperdrive to make a"));
 
-	gef::Sprite* logo = new gef::Sprite();
-	gef::ImageData logo_image_data("menu_images/logo.png");
-	logo->set_texture(gef::Texture::Create(platform_, logo_image_data));
-	logo->set_width(logo_image_data.width());
-	logo->set_height(logo_image_data.height());
-	Image* logo_img = new Image({ 0.5,0.35 }, logo, platform_);
-	menu->AddUIElement(logo_img);
+	// Left out if it couldn't be loaded
+	if (logo_texture_ != nullptr)
+	{
+		gef::Sprite* logo = new gef::Sprite();
+		logo->set_texture(logo_texture_);
+		logo->set_width(logo_width_);
+		logo->set_height(logo_height_);
+		Image* logo_img = new Image({ 0.5,0.35 }, logo, platform_);
+		menu->AddUIElement(logo_img);
+	}
 
 	Button* menuStartButton = new Button({ 0.5,0.5 }, platform_, "Start", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 	Button* menuSettingsButton = new Button({ 0.5,0.6 }, platform_, "Settings", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 	Button* quitButton = new Button({ 0.5,0.7 }, platform_, "Quit", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 	menuStartButton->SetOnClick([this]
 		{
-			state_manager_->PushLevel(new Level(platform_, sprite_renderer_, font_, *state_manager_, audio_manager_), "lvl_1.json", mesh_loader_);
+			state_manager_->PushLevel(new Level(platform_, *state_manager_, audio_), "lvl_1.json", mesh_loader_);
 			state_manager_->NextScene();
 		});
 	menuSettingsButton->SetOnClick([this]
@@ -232,7 +299,7 @@ void SceneApp::Init()
 	Button* restartButton = new Button({ 0.5,0.6 }, platform_, "Restart", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
 	restartButton->SetOnClick([this]
 		{
-			state_manager_->RestartLevel(sprite_renderer_, font_, &mesh_loader_);
+			state_manager_->RestartLevel(&mesh_loader_);
 		});
 	pause->AddUIElement(restartButton);
 	Button* mainMenuButton = new Button({ 0.5,0.7 }, platform_, "Main Menu", 200.f, 50.f, gef::Colour(1, 1, 1, 0.5f));
@@ -241,51 +308,142 @@ void SceneApp::Init()
 		state_manager_->SwitchToMainMenu();
 	});
 	pause->AddUIElement(mainMenuButton);
-
-	InitFont();
-	SetupLights();
 }
 
 void SceneApp::CleanUp()
 {
-	CleanUpFont();
+	if (export_trace_on_exit_ && !Profiler::ExportChromeTrace(trace_file_.c_str()))
+	{
+		gef::DebugOut(("Could not write profiler trace to " + trace_file_ + "\n").c_str());
+	}
+	if (!timeline_file_.empty() && !StartupTimeline::Write(timeline_file_.c_str()))
+	{
+		gef::DebugOut(("Could not write startup timeline to " + timeline_file_ + "\n").c_str());
+	}
+	const FramePacer::Stats& pacing = pacer_.GetStats();
+	gef::DebugOut("Frame pacing: %lld frames, %.2f ms mean, %.2f ms jitter, %lld missed deadlines, %lld dropped\n",
+		(long long)pacing.frames, pacing.mean_ms, pacing.jitter_ms, (long long)pacing.missed_deadlines, (long long)pacing.dropped_frames);
+
+	delete pipeline_;
+	pipeline_ = nullptr;
 
 	delete renderer_3d_;
 	renderer_3d_ = NULL;
 
 	delete sprite_renderer_;
 	sprite_renderer_ = NULL;
+
+	delete audio_;
+	audio_ = nullptr;
+	delete audio_manager_;
+	audio_manager_ = nullptr;
 }
 
 bool SceneApp::Update(float frame_time)
 {
+	// Waiting for the frame's start time isn't part of the frame
+	frame_time = pacer_.BeginFrame();
+
+	Profiler::BeginFrame();
+	PROFILE_ZONE("SceneApp::Update");
+
 	// CAUSES MEMORY LEAK
 
-	iam_->Update();
+	// Whatever the last frame started has to finish before anything here touches the game
+	pipeline_->Wait();
+	pipeline_->Publish();
+	state_manager_->DeleteRetiredScenes();
+	// Loads upload to the GPU and switch scenes, neither of which can happen on the simulation thread
+	state_manager_->UpdateLoads();
+
+	// Loading takes a different number of frames each run, so keep it out of recordings
+	iam_->SetRecordingSuspended(state_manager_->IsLoading());
+	iam_->Update(frame_time);
+	frame_time = iam_->getFrameTime();
 
 	fps_ = 1.0f / frame_time;
 
-	state_manager_->Update(iam_, frame_time);
+	if (iam_->isPressed(ToggleProfiler))
+	{
+		Profiler::SetEnabled(!Profiler::IsEnabled());
+	}
+	if (iam_->isPressed(ExportProfilerTrace))
+	{
+		if (Profiler::ExportChromeTrace(trace_file_.c_str()))
+			gef::DebugOut(("Wrote profiler trace to " + trace_file_ + "\n").c_str());
+		else
+			gef::DebugOut(("Could not write profiler trace to " + trace_file_ + "\n").c_str());
+	}
+
+	audio_->Update();
 
+	// Only a level being played leaves a snapshot, menus and loading screens render live, as do
+	// frames that are going to change scenes
+	frame_time_ = frame_time;
+	render_snapshot_ = pipelined_ && pipeline_->GetFrontSnapshot().IsValid() && !state_manager_->NeedsMainThread();
+	if (render_snapshot_)
+	{
+		// The simulation may stop the game while it runs, this frame goes by the last one
+		const bool should_run = should_run_;
+		pipeline_->Start();
+		return should_run;
+	}
+
+	pipeline_->Run();
 	return should_run_;
 }
 
-void SceneApp::Render()
+void SceneApp::Simulate()
 {
-	// draw current scene
-	state_manager_->Render(renderer_3d_, sprite_renderer_, font_);
+	PROFILE_ZONE("SceneApp::Simulate");
 
+	state_manager_->Update(iam_, frame_time_);
+	if (pipelined_)
+		state_manager_->BuildSnapshot(pipeline_->GetBackSnapshot());
+
+	iam_->EndFrame(state_manager_->GetStateChecksum());
+	if (iam_->replayFinished())
+	{
+		should_run_ = false;
+	}
 }
-void SceneApp::InitFont()
+
+void SceneApp::Render()
 {
-	font_ = new gef::Font(platform_);
-	font_->Load("ranger");
+	PROFILE_ZONE("SceneApp::Render");
+
+	pipeline_->BeginRender();
+
+	// draw current scene, its 2D goes to the overlay and is drawn on top in one batch
+	if (render_snapshot_)
+		pipeline_->GetFrontSnapshot().Submit(renderer_3d_, overlay_);
+	else
+		state_manager_->Render(renderer_3d_, overlay_);
+	Profiler::RenderOverlay(overlay_, fps_);
+	if (Profiler::IsEnabled())
+	{
+		char line[128];
+		snprintf(line, sizeof(line), "simulate %.2f ms  render %.2f ms  overlap %.2f ms  tris %d",
+			pipeline_->GetSimulateMs(), pipeline_->GetRenderMs(), pipeline_->GetOverlapMs(), RenderSnapshot::GetSubmittedTriangles());
+		overlay_.DrawText(gef::Vector4(10.f, platform_.height() - 40.f, -0.9f), 0.7f, 0xff00ff00, gef::TJ_LEFT, line, OverlayLayer::Debug);
+
+		const FramePacer::Stats& pacing = pacer_.GetStats();
+		snprintf(line, sizeof(line), "frame %.2f ms  jitter %.2f ms  worst %.2f ms  missed %lld  dropped %lld",
+			pacing.mean_ms, pacing.jitter_ms, pacing.max_ms, (long long)pacing.missed_deadlines, (long long)pacing.dropped_frames);
+		overlay_.DrawText(gef::Vector4(10.f, platform_.height() - 60.f, -0.9f), 0.7f, 0xff00ff00, gef::TJ_LEFT, line, OverlayLayer::Debug);
+	}
+	overlay_.Submit(sprite_renderer_);
+
+	pipeline_->EndRender();
+	StartupTimeline::Mark("first_frame");
 }
 
-void SceneApp::CleanUpFont()
+void SceneApp::InitOverlay()
 {
-	delete font_;
-	font_ = NULL;
+	if (!overlay_.Init(platform_, "ranger"))
+	{
+		gef::DebugOut("Could not load the overlay font\n");
+	}
 }
 
 
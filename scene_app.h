@@ -6,6 +6,8 @@
 #include <string>
 
 #include "obj_mesh_loader.h"
+#include "Overlay.h"
+#include "FramePacer.h"
 
 class StateManager;
 
@@ -14,15 +16,18 @@ namespace gef
 	class PlatformD3D11;
 }
 
+class AudioSystem;
+class FramePipeline;
+class Image;
 class Level;
 class InputActionManager;
 
 // FRAMEWORK FORWARD DECLARATIONS
 namespace gef
 {
-	class Font;
 	class Platform;
 	class Renderer3D;
+	class Texture;
 }
 
 class SceneApp : public gef::Application
@@ -33,15 +38,39 @@ public:
 	void CleanUp();
 	bool Update(float frame_time);
 	void Render();
+
+	// Input session to record or replay, set before Run()
+	void RecordInputTo(const std::string& filename) { record_file_ = filename; }
+	void ReplayInputFrom(const std::string& filename) { replay_file_ = filename; }
+
+	// Start with the profiler on and write its trace to filename on exit
+	void ProfileTo(const std::string& filename);
+
+	// Memory the next level may stage while the current one is played, set before Run()
+	void SetPrefetchBudget(size_t bytes) { prefetch_budget_ = bytes; }
+
+	// Simulate the next frame while the last one renders whenever a level is being played, set before Run()
+	void SetPipelined(bool pipelined) { pipelined_ = pipelined; }
+
+	// Write how long startup took to get to each point to filename on exit
+	void WriteStartupTimelineTo(const std::string& filename) { timeline_file_ = filename; }
+
+	// Read assets from media/assets.pak when it's there, or only ever from loose files, set before Run()
+	void SetUsePack(bool use_pack) { use_pack_ = use_pack; }
+
+	// Start frames this many times a second, 0 to leave it to vsync
+	void SetTargetFrameRate(float frames_per_second) { pacer_.SetTargetRate(frames_per_second); }
 private:
-	void InitFont();
-	void CleanUpFont();
+	void Simulate();
+	void LoadFrontEnd(Image* background);
+	void BuildMenus(Image* background);
+	void InitOverlay();
 	void DrawHUD();
 	void SetupLights();
 
 	//Feasibility Demo player and level
 	
-	gef::Font* font_;
+	Overlay overlay_;
 	gef::Renderer3D* renderer_3d_;
 	gef::SpriteRenderer* sprite_renderer_;
 
@@ -55,12 +84,34 @@ private:
 	StateManager* state_manager_;
 
 	float fps_;
+	// Times frames on its own clock, gef's frame time isn't used
+	FramePacer pacer_;
 	std::string gravity_lock_;
 
 	bool should_run_ = true;
 	OBJMeshLoader mesh_loader_;
 
 	gef::AudioManager* audio_manager_ = nullptr;
+	AudioSystem* audio_ = nullptr;
+
+	std::string record_file_;
+	std::string replay_file_;
+	std::string trace_file_ = "profile_trace.json";
+	std::string timeline_file_;
+	bool export_trace_on_exit_ = false;
+	size_t prefetch_budget_ = 256 * 1024 * 1024;
+	bool use_pack_ = true;
+
+	// The main menu's logo, loaded behind the splash screen
+	gef::Texture* logo_texture_ = nullptr;
+	float logo_width_ = 0.f;
+	float logo_height_ = 0.f;
+
+	FramePipeline* pipeline_ = nullptr;
+	bool pipelined_ = true;
+	// This frame draws the snapshot the last one left instead of the live scene
+	bool render_snapshot_ = false;
+	float frame_time_ = 0.f;
 };
 
 #endif // _SCENE_APP_H